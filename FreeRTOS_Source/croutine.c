@@ -101,20 +101,40 @@ static TickType_t xCoRoutineTickCount = 0, xLastTickCount = 0, xPassedTicks = 0;
 
 /*
  * Place the co-routine represented by pxCRCB into the appropriate ready queue
- * for the priority.  It is inserted at the end of the list.
+ * for the priority.  It is inserted at the end of the list, or with
+ * configUSE_CO_ROUTINE_DEADLINES set to 1, after the co-routines whose
+ * deadlines are no later than its own.  The generic list item holds the wake
+ * time while the co-routine is delayed, so its value is set here each time.
  *
  * This macro accesses the co-routine ready lists and therefore must not be
  * used from within an ISR.
  */
+#if( configUSE_CO_ROUTINE_DEADLINES == 1 )
+	#define prvInsertCoRoutineInReadyList( pxCRCB )																		\
+	{																													\
+		listSET_LIST_ITEM_VALUE( &( pxCRCB->xGenericListItem ), pxCRCB->xDeadline );									\
+		vListInsert( ( List_t * ) &( pxReadyCoRoutineLists[ pxCRCB->uxPriority ] ), &( pxCRCB->xGenericListItem ) );		\
+	}
+#else
+	#define prvInsertCoRoutineInReadyList( pxCRCB )																		\
+		vListInsertEnd( ( List_t * ) &( pxReadyCoRoutineLists[ pxCRCB->uxPriority ] ), &( pxCRCB->xGenericListItem ) )
+#endif
+
 #define prvAddCoRoutineToReadyQueue( pxCRCB )																		\
 {																													\
 	if( pxCRCB->uxPriority > uxTopCoRoutineReadyPriority )															\
 	{																												\
 		uxTopCoRoutineReadyPriority = pxCRCB->uxPriority;															\
 	}																												\
-	vListInsertEnd( ( List_t * ) &( pxReadyCoRoutineLists[ pxCRCB->uxPriority ] ), &( pxCRCB->xGenericListItem ) );	\
+	prvInsertCoRoutineInReadyList( pxCRCB );																		\
 }
 
+/*
+ * Fill out a new co-routine control block and add the co-routine to the ready
+ * list for its priority.
+ */
+static void prvInitialiseNewCoRoutine( CRCB_t *pxCoRoutine, crCOROUTINE_CODE pxCoRoutineCode, UBaseType_t uxPriority, UBaseType_t uxIndex );
+
 /*
  * Utility to ready all the lists used by the scheduler.  This is called
  * automatically upon the creation of the first co-routine.
@@ -150,51 +170,87 @@ CRCB_t *pxCoRoutine;
 	pxCoRoutine = ( CRCB_t * ) pvPortMalloc( sizeof( CRCB_t ) );
 	if( pxCoRoutine )
 	{
-		/* If pxCurrentCoRoutine is NULL then this is the first co-routine to
-		be created and the co-routine data structures need initialising. */
-		if( pxCurrentCoRoutine == NULL )
+		prvInitialiseNewCoRoutine( pxCoRoutine, pxCoRoutineCode, uxPriority, uxIndex );
+		xReturn = pdPASS;
+	}
+	else
+	{
+		xReturn = errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	BaseType_t xCoRoutineCreateStatic( crCOROUTINE_CODE pxCoRoutineCode, UBaseType_t uxPriority, UBaseType_t uxIndex, CRCB_t *pxCoRoutineBuffer )
+	{
+	BaseType_t xReturn;
+
+		configASSERT( pxCoRoutineBuffer );
+
+		if( pxCoRoutineBuffer != NULL )
 		{
-			pxCurrentCoRoutine = pxCoRoutine;
-			prvInitialiseCoRoutineLists();
+			prvInitialiseNewCoRoutine( pxCoRoutineBuffer, pxCoRoutineCode, uxPriority, uxIndex );
+			xReturn = pdPASS;
 		}
-
-		/* Check the priority is within limits. */
-		if( uxPriority >= configMAX_CO_ROUTINE_PRIORITIES )
+		else
 		{
-			uxPriority = configMAX_CO_ROUTINE_PRIORITIES - 1;
+			xReturn = pdFAIL;
 		}
 
-		/* Fill out the co-routine control block from the function parameters. */
-		pxCoRoutine->uxState = corINITIAL_STATE;
-		pxCoRoutine->uxPriority = uxPriority;
-		pxCoRoutine->uxIndex = uxIndex;
-		pxCoRoutine->pxCoRoutineFunction = pxCoRoutineCode;
+		return xReturn;
+	}
 
-		/* Initialise all the other co-routine control block parameters. */
-		vListInitialiseItem( &( pxCoRoutine->xGenericListItem ) );
-		vListInitialiseItem( &( pxCoRoutine->xEventListItem ) );
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
 
-		/* Set the co-routine control block as a link back from the ListItem_t.
-		This is so we can get back to the containing CRCB from a generic item
-		in a list. */
-		listSET_LIST_ITEM_OWNER( &( pxCoRoutine->xGenericListItem ), pxCoRoutine );
-		listSET_LIST_ITEM_OWNER( &( pxCoRoutine->xEventListItem ), pxCoRoutine );
+static void prvInitialiseNewCoRoutine( CRCB_t *pxCoRoutine, crCOROUTINE_CODE pxCoRoutineCode, UBaseType_t uxPriority, UBaseType_t uxIndex )
+{
+	/* If pxCurrentCoRoutine is NULL then this is the first co-routine to
+	be created and the co-routine data structures need initialising. */
+	if( pxCurrentCoRoutine == NULL )
+	{
+		pxCurrentCoRoutine = pxCoRoutine;
+		prvInitialiseCoRoutineLists();
+	}
 
-		/* Event lists are always in priority order. */
-		listSET_LIST_ITEM_VALUE( &( pxCoRoutine->xEventListItem ), ( ( TickType_t ) configMAX_CO_ROUTINE_PRIORITIES - ( TickType_t ) uxPriority ) );
+	/* Check the priority is within limits. */
+	if( uxPriority >= configMAX_CO_ROUTINE_PRIORITIES )
+	{
+		uxPriority = configMAX_CO_ROUTINE_PRIORITIES - 1;
+	}
 
-		/* Now the co-routine has been initialised it can be added to the ready
-		list at the correct priority. */
-		prvAddCoRoutineToReadyQueue( pxCoRoutine );
+	/* Fill out the co-routine control block from the function parameters. */
+	pxCoRoutine->uxState = corINITIAL_STATE;
+	pxCoRoutine->uxPriority = uxPriority;
+	pxCoRoutine->uxIndex = uxIndex;
+	pxCoRoutine->pxCoRoutineFunction = pxCoRoutineCode;
 
-		xReturn = pdPASS;
-	}
-	else
+	#if( configUSE_CO_ROUTINE_DEADLINES == 1 )
 	{
-		xReturn = errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+		/* Behind every co-routine that has been given a deadline. */
+		pxCoRoutine->xDeadline = portMAX_DELAY;
 	}
+	#endif
 
-	return xReturn;
+	/* Initialise all the other co-routine control block parameters. */
+	vListInitialiseItem( &( pxCoRoutine->xGenericListItem ) );
+	vListInitialiseItem( &( pxCoRoutine->xEventListItem ) );
+
+	/* Set the co-routine control block as a link back from the ListItem_t.
+	This is so we can get back to the containing CRCB from a generic item
+	in a list. */
+	listSET_LIST_ITEM_OWNER( &( pxCoRoutine->xGenericListItem ), pxCoRoutine );
+	listSET_LIST_ITEM_OWNER( &( pxCoRoutine->xEventListItem ), pxCoRoutine );
+
+	/* Event lists are always in priority order. */
+	listSET_LIST_ITEM_VALUE( &( pxCoRoutine->xEventListItem ), ( ( TickType_t ) configMAX_CO_ROUTINE_PRIORITIES - ( TickType_t ) uxPriority ) );
+
+	/* Now the co-routine has been initialised it can be added to the ready
+	list at the correct priority. */
+	prvAddCoRoutineToReadyQueue( pxCoRoutine );
 }
 /*-----------------------------------------------------------*/
 
@@ -336,9 +392,18 @@ void vCoRoutineSchedule( void )
 		--uxTopCoRoutineReadyPriority;
 	}
 
-	/* listGET_OWNER_OF_NEXT_ENTRY walks through the list, so the co-routines
-	 of the	same priority get an equal share of the processor time. */
-	listGET_OWNER_OF_NEXT_ENTRY( pxCurrentCoRoutine, &( pxReadyCoRoutineLists[ uxTopCoRoutineReadyPriority ] ) );
+	#if( configUSE_CO_ROUTINE_DEADLINES == 1 )
+	{
+		/* The list is in deadline order, so the head is the most urgent. */
+		pxCurrentCoRoutine = ( CRCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( &( pxReadyCoRoutineLists[ uxTopCoRoutineReadyPriority ] ) );
+	}
+	#else
+	{
+		/* listGET_OWNER_OF_NEXT_ENTRY walks through the list, so the co-routines
+		 of the	same priority get an equal share of the processor time. */
+		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentCoRoutine, &( pxReadyCoRoutineLists[ uxTopCoRoutineReadyPriority ] ) );
+	}
+	#endif
 
 	/* Call the co-routine. */
 	( pxCurrentCoRoutine->pxCoRoutineFunction )( pxCurrentCoRoutine, pxCurrentCoRoutine->uxIndex );
@@ -347,6 +412,26 @@ void vCoRoutineSchedule( void )
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_CO_ROUTINE_DEADLINES == 1 )
+
+	void vCoRoutineSetDeadline( CoRoutineHandle_t xCoRoutine, TickType_t xDeadline )
+	{
+	CRCB_t *pxCRCB = ( CRCB_t * ) xCoRoutine;
+
+		pxCRCB->xDeadline = xDeadline;
+
+		/* A delayed or blocked co-routine is placed by its new deadline when
+		it is readied.  A ready one moves now. */
+		if( listIS_CONTAINED_WITHIN( &( pxReadyCoRoutineLists[ pxCRCB->uxPriority ] ), &( pxCRCB->xGenericListItem ) ) != pdFALSE )
+		{
+			( void ) uxListRemove( &( pxCRCB->xGenericListItem ) );
+			prvAddCoRoutineToReadyQueue( pxCRCB );
+		}
+	}
+
+#endif /* configUSE_CO_ROUTINE_DEADLINES */
+/*-----------------------------------------------------------*/
+
 static void prvInitialiseCoRoutineLists( void )
 {
 UBaseType_t uxPriority;
@@ -316,6 +316,19 @@ extern "C" {
 	#define portSETUP_TCB( pxTCB ) ( void ) pxTCB
 #endif
 
+#ifndef portIDLE_TASK_HOOK
+	/* Called on each iteration of the idle task.  Used by simulated ports in
+	which time only passes when the port is entered. */
+	#define portIDLE_TASK_HOOK()
+#endif
+
+#ifndef portMEMORY_BARRIER
+	/* Orders the data copied into a stream buffer before the index that
+	publishes it.  Not needed by ports that run on a single core and whose
+	compiler does not reorder across the call. */
+	#define portMEMORY_BARRIER()
+#endif
+
 #ifndef configQUEUE_REGISTRY_SIZE
 	#define configQUEUE_REGISTRY_SIZE 0U
 #endif
@@ -371,6 +384,53 @@ extern "C" {
 	#define traceTASK_SWITCHED_OUT()
 #endif
 
+#ifndef traceISR_ENTER
+	/* Called by the port as the tick interrupt starts, before it touches any
+	kernel state. */
+	#define traceISR_ENTER()
+#endif
+
+#ifndef traceISR_EXIT
+	/* Called by the port as the tick interrupt ends, after any context switch
+	it requires has been pended. */
+	#define traceISR_EXIT()
+#endif
+
+#ifndef traceCRITICAL_ENTER
+	/* Called by the port as a task enters its outermost critical section, after
+	interrupts have been masked.  It expands inside vPortEnterCritical(). */
+	#define traceCRITICAL_ENTER()
+#endif
+
+#ifndef traceCRITICAL_EXIT
+	/* Called by the port as a task leaves its outermost critical section, before
+	interrupts are unmasked. */
+	#define traceCRITICAL_EXIT()
+#endif
+
+#ifndef traceISR_MASK
+	/* Called by the port after an interrupt masks interrupts when they were not
+	already masked.  pvSite is the code that masked them. */
+	#define traceISR_MASK( pvSite )
+#endif
+
+#ifndef traceISR_UNMASK
+	/* Called by the port before an interrupt unmasks interrupts it masked. */
+	#define traceISR_UNMASK()
+#endif
+
+#ifndef traceSCHEDULER_SUSPEND
+	/* Called once the outermost vTaskSuspendAll() has suspended the
+	scheduler.  It expands inside vTaskSuspendAll(). */
+	#define traceSCHEDULER_SUSPEND()
+#endif
+
+#ifndef traceSCHEDULER_RESUME
+	/* Called as the outermost xTaskResumeAll() resumes the scheduler, before it
+	readies the tasks that were unblocked in the meantime. */
+	#define traceSCHEDULER_RESUME()
+#endif
+
 #ifndef traceTASK_PRIORITY_INHERIT
 	/* Called when a task attempts to take a mutex that is already held by a
 	lower priority task.  pxTCBOfMutexHolder is a pointer to the TCB of the task
@@ -720,6 +780,36 @@ extern "C" {
 	#define configUSE_QUEUE_SETS 0
 #endif
 
+#ifndef configUSE_REFERENCE_QUEUES
+	#define configUSE_REFERENCE_QUEUES 0
+#endif
+
+#ifndef configUSE_ORDERED_QUEUES
+	#define configUSE_ORDERED_QUEUES 0
+#endif
+
+#ifndef configUSE_TIMER_WHEEL
+	#define configUSE_TIMER_WHEEL 0
+#endif
+
+#ifndef configTIMER_WHEEL_LEVELS
+	/* Each level of the timer wheel has 64 slots, so four levels cover
+	2^24 ticks.  Timers further out wait in an overflow list. */
+	#define configTIMER_WHEEL_LEVELS 4
+#endif
+
+#ifndef configUSE_CO_ROUTINE_DEADLINES
+	/* Set to 1 to order co-routines of the same priority by deadline rather
+	than running them in turn.  See vCoRoutineSetDeadline() in croutine.h. */
+	#define configUSE_CO_ROUTINE_DEADLINES 0
+#endif
+
+#ifndef configUSE_DELAYED_TASK_HEAP
+	/* Set to 1 to keep the delayed task lists as pairing heaps rather than
+	sorted linked lists, making each delay or timeout insert O(log n). */
+	#define configUSE_DELAYED_TASK_HEAP 0
+#endif
+
 #ifndef portTASK_USES_FLOATING_POINT
 	#define portTASK_USES_FLOATING_POINT()
 #endif
@@ -789,6 +879,14 @@ extern "C" {
 	#endif /* INCLUDE_vTaskSuspend */
 #endif /* configUSE_TICKLESS_IDLE */
 
+#if( ( configUSE_TIMER_WHEEL == 1 ) && ( ( configTIMER_WHEEL_LEVELS < 1 ) || ( configTIMER_WHEEL_LEVELS > 5 ) ) )
+	#error configTIMER_WHEEL_LEVELS must be between 1 and 5
+#endif
+
+#if( ( configUSE_TIMER_WHEEL == 1 ) && ( configUSE_16_BIT_TICKS == 1 ) )
+	#error The timer wheel requires 32-bit ticks
+#endif
+
 #if( ( configSUPPORT_STATIC_ALLOCATION == 0 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 0 ) )
 	#error configSUPPORT_STATIC_ALLOCATION and configSUPPORT_DYNAMIC_ALLOCATION cannot both be 0, but can both be 1.
 #endif
@@ -797,6 +895,10 @@ extern "C" {
 	#error configUSE_MUTEXES must be set to 1 to use recursive mutexes
 #endif
 
+#if( ( configUSE_REFERENCE_QUEUES == 1 ) && ( INCLUDE_xTaskGetCurrentTaskHandle != 1 ) && ( configUSE_MUTEXES != 1 ) )
+	#error INCLUDE_xTaskGetCurrentTaskHandle must be set to 1 to use reference queues
+#endif
+
 #if( portTICK_TYPE_IS_ATOMIC == 0 )
 	/* Either variables of tick type cannot be read atomically, or
 	portTICK_TYPE_IS_ATOMIC was not set - map the critical sections used when
@@ -875,6 +977,9 @@ struct xSTATIC_LIST_ITEM
 {
 	TickType_t xDummy1;
 	void *pvDummy2[ 4 ];
+	#if( configUSE_DELAYED_TASK_HEAP == 1 )
+		void *pvDummy3;
+	#endif
 };
 typedef struct xSTATIC_LIST_ITEM StaticListItem_t;
 
@@ -992,6 +1097,11 @@ typedef struct xSTATIC_QUEUE
 		uint8_t ucDummy9;
 	#endif
 
+	#if ( configUSE_ORDERED_QUEUES == 1 )
+		uint8_t ucDummy10;
+		UBaseType_t uxDummy11;
+	#endif
+
 } StaticQueue_t;
 typedef StaticQueue_t StaticSemaphore_t;
 
@@ -1055,6 +1165,35 @@ typedef struct xSTATIC_TIMER
 
 } StaticTimer_t;
 
+/*
+ * In line with software engineering best practice, FreeRTOS implements a strict
+ * data hiding policy, so the stream buffer structure used internally by
+ * FreeRTOS is not accessible to application code.  The StaticStreamBuffer_t
+ * structure below is provided so the memory required to create a stream or
+ * message buffer can be allocated statically.  Its sizes and alignment
+ * requirements are guaranteed to match those of the genuine structure.
+ */
+typedef struct xSTATIC_STREAM_BUFFER
+{
+	size_t uxDummy1[ 4 ];
+	void * pvDummy2[ 3 ];
+	uint8_t ucDummy3;
+} StaticStreamBuffer_t;
+typedef StaticStreamBuffer_t StaticMessageBuffer_t;
+
+/*
+ * The StaticBufferPool_t structure holds a buffer pool and the queue of its
+ * free buffers when the pool is created with xQueueCreateBufferPoolStatic().
+ * The buffers themselves live in a separate storage area.
+ */
+typedef struct xSTATIC_BUFFER_POOL
+{
+	void *pvDummy1[ 2 ];
+	UBaseType_t uxDummy2;
+	size_t uxDummy3;
+	StaticQueue_t xDummy4;
+} StaticBufferPool_t;
+
 #ifdef __cplusplus
 }
 #endif
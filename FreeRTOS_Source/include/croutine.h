@@ -96,6 +96,9 @@ typedef struct corCoRoutineControlBlock
 	UBaseType_t 		uxPriority;			/*< The priority of the co-routine in relation to other co-routines. */
 	UBaseType_t 		uxIndex;			/*< Used to distinguish between co-routines when multiple co-routines use the same co-routine function. */
 	uint16_t 			uxState;			/*< Used internally by the co-routine implementation. */
+	#if( configUSE_CO_ROUTINE_DEADLINES == 1 )
+		TickType_t		xDeadline;			/*< Orders the co-routine within its ready list, earliest first. */
+	#endif
 } CRCB_t; /* Co-routine control block.  Note must be identical in size down to uxPriority with TCB_t. */
 
 /**
@@ -172,6 +175,34 @@ typedef struct corCoRoutineControlBlock
  */
 BaseType_t xCoRoutineCreate( crCOROUTINE_CODE pxCoRoutineCode, UBaseType_t uxPriority, UBaseType_t uxIndex );
 
+/**
+ * croutine. h
+ *<pre>
+ BaseType_t xCoRoutineCreateStatic(
+                                 crCOROUTINE_CODE pxCoRoutineCode,
+                                 UBaseType_t uxPriority,
+                                 UBaseType_t uxIndex,
+                                 CRCB_t *pxCoRoutineBuffer
+                               );</pre>
+ *
+ * As xCoRoutineCreate(), but the co-routine control block is provided by the
+ * application rather than allocated from the FreeRTOS heap.  Co-routines
+ * cannot be deleted, so pxCoRoutineBuffer must remain valid for the life of
+ * the application.
+ *
+ * @param pxCoRoutineBuffer Must point to a CRCB_t variable, which will hold
+ * the co-routine's control block.
+ *
+ * @return pdPASS if the co-routine was created and added to a ready list,
+ * otherwise pdFAIL if pxCoRoutineBuffer is NULL.
+ *
+ * \defgroup xCoRoutineCreateStatic xCoRoutineCreateStatic
+ * \ingroup Tasks
+ */
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	BaseType_t xCoRoutineCreateStatic( crCOROUTINE_CODE pxCoRoutineCode, UBaseType_t uxPriority, UBaseType_t uxIndex, CRCB_t *pxCoRoutineBuffer );
+#endif
+
 
 /**
  * croutine. h
@@ -214,6 +245,38 @@ BaseType_t xCoRoutineCreate( crCOROUTINE_CODE pxCoRoutineCode, UBaseType_t uxPri
  */
 void vCoRoutineSchedule( void );
 
+/**
+ * croutine. h
+ *<pre>
+ void vCoRoutineSetDeadline( CoRoutineHandle_t xCoRoutine, TickType_t xDeadline );</pre>
+ *
+ * configUSE_CO_ROUTINE_DEADLINES must be set to 1 for this function to be
+ * available.
+ *
+ * With configUSE_CO_ROUTINE_DEADLINES set to 1, each co-routine ready list is
+ * kept in order of deadline, and vCoRoutineSchedule() runs the co-routine at
+ * its head rather than taking turns.  Priorities still come first: deadlines
+ * only order co-routines of the same priority.  A co-routine takes its place
+ * at once if it is ready, otherwise when it is next readied.  Co-routines
+ * with equal deadlines run in the order they were readied, and a co-routine
+ * that yields with crDELAY( xHandle, 0 ) keeps its place.  Co-routines are
+ * created with a deadline of portMAX_DELAY.
+ *
+ * This function accesses the co-routine ready lists, so it must only be
+ * called by co-routines or by the task that calls vCoRoutineSchedule(), and
+ * never from an interrupt.
+ *
+ * @param xCoRoutine The handle passed to the co-routine function.
+ *
+ * @param xDeadline The tick count by which the co-routine should have run.
+ *
+ * \defgroup vCoRoutineSetDeadline vCoRoutineSetDeadline
+ * \ingroup Tasks
+ */
+#if( configUSE_CO_ROUTINE_DEADLINES == 1 )
+	void vCoRoutineSetDeadline( CoRoutineHandle_t xCoRoutine, TickType_t xDeadline );
+#endif
+
 /**
  * croutine. h
  * <pre>
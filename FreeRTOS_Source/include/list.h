@@ -186,6 +186,9 @@ struct xLIST_ITEM
 	struct xLIST_ITEM * configLIST_VOLATILE pxPrevious;	/*< Pointer to the previous ListItem_t in the list. */
 	void * pvOwner;										/*< Pointer to the object (normally a TCB) that contains the list item.  There is therefore a two way link between the object containing the list item and the list item itself. */
 	void * configLIST_VOLATILE pvContainer;				/*< Pointer to the list in which this list item is placed (if any). */
+	#if( configUSE_DELAYED_TASK_HEAP == 1 )
+		struct xLIST_ITEM * configLIST_VOLATILE pxChild;	/*< Pointer to the first child of the item when it is in a heap ordered list. */
+	#endif
 	listSECOND_LIST_ITEM_INTEGRITY_CHECK_VALUE			/*< Set to a known value if configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
 };
 typedef struct xLIST_ITEM ListItem_t;					/* For some reason lint wants this as two separate definitions. */
@@ -373,6 +376,12 @@ List_t * const pxConstList = ( pxList );													\
  */
 #define listLIST_IS_INITIALISED( pxList ) ( ( pxList )->xListEnd.xItemValue == portMAX_DELAY )
 
+/*
+ * Return pdTRUE if the list was initialised by vListInitialiseHeap().  A heap
+ * ordered list has no index, which a linked list always has.
+ */
+#define listLIST_IS_HEAP( pxList ) ( ( BaseType_t ) ( ( pxList )->pxIndex == NULL ) )
+
 /*
  * Must be called before a list is used!  This initialises all the members
  * of the list structure and inserts the xListEnd item into the list as a
@@ -445,6 +454,44 @@ void vListInsertEnd( List_t * const pxList, ListItem_t * const pxNewListItem ) P
  */
 UBaseType_t uxListRemove( ListItem_t * const pxItemToRemove ) PRIVILEGED_FUNCTION;
 
+#if( configUSE_DELAYED_TASK_HEAP == 1 )
+
+	/*
+	 * Initialise a list that is kept as a pairing heap rather than a sorted
+	 * linked list.  The heap has O(log n) amortised insert and remove, and the
+	 * item with the lowest value is always at the head, so
+	 * listGET_OWNER_OF_HEAD_ENTRY(), listGET_ITEM_VALUE_OF_HEAD_ENTRY(),
+	 * listLIST_IS_EMPTY() and uxListRemove() work unchanged.  Items must be
+	 * added with vListInsertHeap() and the list cannot be walked with
+	 * listGET_OWNER_OF_NEXT_ENTRY(); use pxListHeapNextItem() instead.
+	 *
+	 * @param pxList Pointer to the list being initialised.
+	 */
+	void vListInitialiseHeap( List_t * const pxList ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Insert a list item into a heap ordered list.  Items with equal values are
+	 * removed from the head in no particular order.
+	 *
+	 * @param pxList The list into which the item is to be inserted.
+	 *
+	 * @param pxNewListItem The item that is to be placed in the list.
+	 */
+	void vListInsertHeap( List_t * const pxList, ListItem_t * const pxNewListItem ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Walk every item of a heap ordered list, in no particular order.  Starting
+	 * from listGET_HEAD_ENTRY(), each call returns the item after pxItem, or
+	 * NULL once every item has been returned.  The list must not be modified
+	 * during the walk.
+	 *
+	 * @param pxItem The item last returned, which must be in a heap ordered
+	 * list.
+	 */
+	ListItem_t * pxListHeapNextItem( const ListItem_t * pxItem ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_DELAYED_TASK_HEAP */
+
 #ifdef __cplusplus
 }
 #endif
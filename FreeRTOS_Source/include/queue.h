@@ -75,6 +75,9 @@
 	#error "include FreeRTOS.h" must appear in source files before "include queue.h"
 #endif
 
+/* vQueueReclaimBuffers() takes a TaskHandle_t. */
+#include "task.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -101,6 +104,13 @@ typedef void * QueueSetHandle_t;
  */
 typedef void * QueueSetMemberHandle_t;
 
+/**
+ * Type by which buffer pools are referenced.  For example, a call to
+ * xQueueCreateBufferPool() returns a BufferPoolHandle_t variable that can then
+ * be used as a parameter to pvQueueAllocateBuffer().
+ */
+typedef void * BufferPoolHandle_t;
+
 /* For internal use only. */
 #define	queueSEND_TO_BACK		( ( BaseType_t ) 0 )
 #define	queueSEND_TO_FRONT		( ( BaseType_t ) 1 )
@@ -113,6 +123,7 @@ typedef void * QueueSetMemberHandle_t;
 #define queueQUEUE_TYPE_COUNTING_SEMAPHORE	( ( uint8_t ) 2U )
 #define queueQUEUE_TYPE_BINARY_SEMAPHORE	( ( uint8_t ) 3U )
 #define queueQUEUE_TYPE_RECURSIVE_MUTEX		( ( uint8_t ) 4U )
+#define queueQUEUE_TYPE_ORDERED				( ( uint8_t ) 5U )
 
 /**
  * queue. h
@@ -1698,6 +1709,14 @@ BaseType_t xQueueGiveMutexRecursive( QueueHandle_t pxMutex ) PRIVILEGED_FUNCTION
  */
 QueueSetHandle_t xQueueCreateSet( const UBaseType_t uxEventQueueLength ) PRIVILEGED_FUNCTION;
 
+/*
+ * As xQueueCreateSet(), but the set is created in memory supplied by the
+ * caller.  pucQueueSetStorage must hold uxEventQueueLength handles, that is
+ * uxEventQueueLength * sizeof( QueueSetMemberHandle_t ) bytes, and
+ * pxStaticQueueSet holds the set's queue structure.
+ */
+QueueSetHandle_t xQueueCreateSetStatic( const UBaseType_t uxEventQueueLength, uint8_t *pucQueueSetStorage, StaticQueue_t *pxStaticQueueSet ) PRIVILEGED_FUNCTION;
+
 /*
  * Adds a queue or semaphore to a queue set that was previously created by a
  * call to xQueueCreateSet().
@@ -1782,6 +1801,206 @@ QueueSetMemberHandle_t xQueueSelectFromSet( QueueSetHandle_t xQueueSet, const Ti
  */
 QueueSetMemberHandle_t xQueueSelectFromSetFromISR( QueueSetHandle_t xQueueSet ) PRIVILEGED_FUNCTION;
 
+/*
+ * Reference queues move pointers to buffers taken from a buffer pool instead
+ * of copying the data itself, so sending a message costs the same whatever
+ * its size.  Each buffer is owned by exactly one party at a time:
+ *
+ *  + pvQueueAllocateBuffer() takes a free buffer from a pool and makes the
+ *    calling task its owner.
+ *  + xQueueSendReference() passes ownership from the sender to the queue.  If
+ *    the send fails the sender still owns the buffer.
+ *  + xQueueReceiveReference() passes ownership from the queue to the receiving
+ *    task.
+ *  + vQueueReleaseBuffer() returns the buffer to the pool it came from.  The
+ *    owner does not need to know which pool that is.
+ *  + vQueueReclaimBuffers() returns every buffer a task still owns to the
+ *    pool, for use before the task is deleted.
+ *
+ * A buffer must not be accessed by a task that does not own it.  Each buffer
+ * header records the owning task, so with configASSERT() defined, sending or
+ * releasing a buffer from any other task fails an assertion.  Reads and writes
+ * are not checked.  As the owner is a task, none of these functions can be
+ * called from an ISR or before the scheduler has started.
+ *
+ * configUSE_REFERENCE_QUEUES must be set to 1 in FreeRTOSConfig.h for these
+ * functions to be available.
+ */
+
+/*
+ * Create a pool of uxBufferCount buffers of xBufferSize bytes each.  The pool
+ * and its buffers are allocated in one block from the FreeRTOS heap.
+ *
+ * @param uxBufferCount The number of buffers in the pool.
+ *
+ * @param xBufferSize The usable size of each buffer in bytes.  Buffers are
+ * aligned to portBYTE_ALIGNMENT.
+ *
+ * @return A handle to the pool, or NULL if there was not enough heap.
+ */
+BufferPoolHandle_t xQueueCreateBufferPool( const UBaseType_t uxBufferCount, const size_t xBufferSize ) PRIVILEGED_FUNCTION;
+
+/*
+ * The number of bytes of storage xQueueCreateBufferPoolStatic() needs for
+ * uxBufferCount buffers of xBufferSize bytes.  Each buffer is preceded by a
+ * header and rounded up to portBYTE_ALIGNMENT, and has a slot in the queue
+ * of free buffers.
+ */
+#define queueBUFFER_HEADER_BYTES ( ( ( 2 * sizeof( void * ) ) + sizeof( UBaseType_t ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+#define queueBUFFER_POOL_STORAGE_SIZE( uxBufferCount, xBufferSize ) \
+	( ( size_t ) ( uxBufferCount ) * ( queueBUFFER_HEADER_BYTES + ( ( ( size_t ) ( xBufferSize ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) ) + sizeof( void * ) ) )
+
+/*
+ * As xQueueCreateBufferPool(), but the pool is created in memory supplied by
+ * the caller.
+ *
+ * @param pucPoolStorage At least queueBUFFER_POOL_STORAGE_SIZE( uxBufferCount,
+ * xBufferSize ) bytes, aligned to portBYTE_ALIGNMENT.
+ *
+ * @param pxStaticPool Holds the pool and its queue of free buffers.
+ *
+ * @return A handle to the pool.
+ */
+BufferPoolHandle_t xQueueCreateBufferPoolStatic( const UBaseType_t uxBufferCount, const size_t xBufferSize, uint8_t *pucPoolStorage, StaticBufferPool_t *pxStaticPool ) PRIVILEGED_FUNCTION;
+
+/*
+ * Take a free buffer from a pool, blocking for up to xTicksToWait ticks if
+ * all the buffers are in use.
+ *
+ * @return A buffer now owned by the calling task, or NULL if none became free
+ * before the block time expired.
+ */
+void *pvQueueAllocateBuffer( BufferPoolHandle_t xPool, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Return a buffer owned by the calling task to the pool it was allocated
+ * from.
+ */
+void vQueueReleaseBuffer( void *pvBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Return to xPool every buffer from it that xTask owns.  Call it before
+ * deleting xTask, which would otherwise take its buffers out of the pool for
+ * good.  xTask must not be running, so call it from another task once xTask
+ * is blocked or suspended.  A buffer xTask was blocked sending is held by the
+ * queue, not by xTask, and is not reclaimed.
+ */
+void vQueueReclaimBuffers( BufferPoolHandle_t xPool, TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
+/*
+ * Create a queue that holds up to uxQueueLength buffer references.
+ */
+#define xQueueCreateReference( uxQueueLength ) xQueueCreate( ( uxQueueLength ), sizeof( void * ) )
+
+/*
+ * As xQueueCreateReference(), with pucQueueStorage holding uxQueueLength
+ * pointers.
+ */
+#define xQueueCreateReferenceStatic( uxQueueLength, pucQueueStorage, pxQueueBuffer ) xQueueCreateStatic( ( uxQueueLength ), sizeof( void * ), ( pucQueueStorage ), ( pxQueueBuffer ) )
+
+/*
+ * Post a buffer to the back of a reference queue.  Only the pointer is
+ * copied into the queue.
+ *
+ * @param xQueue A queue created with xQueueCreateReference().
+ *
+ * @param pvBuffer A buffer owned by the calling task.
+ *
+ * @param xTicksToWait The maximum time to block waiting for space in the
+ * queue.
+ *
+ * @return pdPASS if the buffer was posted, in which case the queue owns it.
+ * Otherwise errQUEUE_FULL, and the calling task still owns the buffer.
+ */
+BaseType_t xQueueSendReference( QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Receive a buffer from a reference queue.
+ *
+ * @param xQueue A queue created with xQueueCreateReference().
+ *
+ * @param ppvBuffer Set to the received buffer, which is then owned by the
+ * calling task until it is sent on or released.
+ *
+ * @param xTicksToWait The maximum time to block waiting for a buffer.
+ *
+ * @return pdPASS if a buffer was received, otherwise errQUEUE_EMPTY.
+ */
+BaseType_t xQueueReceiveReference( QueueHandle_t xQueue, void **ppvBuffer, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Ordered queues hand out their items lowest key first instead of in the
+ * order they were sent.  Each item must start with a TickType_t key, such as
+ * an absolute deadline.  Items with equal keys are received in the order they
+ * were sent.  Keys are compared as plain unsigned values, so keys that may
+ * wrap must be kept relative to a common base.
+ *
+ * Sends, receives, peeks and queue sets work as for other queues.  The copy
+ * position is ignored except by xQueueOverwrite(), which still replaces the
+ * only item of a queue of length one.  Ordered queues cannot be used with the
+ * co-routine queue functions.
+ *
+ * configUSE_ORDERED_QUEUES must be set to 1 in FreeRTOSConfig.h for these
+ * functions to be available.
+ */
+#define xQueueCreateOrdered( uxQueueLength, uxItemSize ) xQueueGenericCreate( ( uxQueueLength ), ( uxItemSize ), ( queueQUEUE_TYPE_ORDERED ) )
+
+/*
+ * The number of bytes of storage xQueueCreateOrderedStatic() needs for
+ * uxQueueLength items of uxItemSize bytes.  Each item is stored with the
+ * sequence number that keeps items with equal keys in the order they were
+ * sent.
+ */
+#define queueORDERED_STORAGE_SIZE( uxQueueLength, uxItemSize ) ( ( size_t ) ( uxQueueLength ) * ( ( size_t ) ( uxItemSize ) + sizeof( UBaseType_t ) ) )
+
+#define xQueueCreateOrderedStatic( uxQueueLength, uxItemSize, pucQueueStorage, pxQueueBuffer ) xQueueGenericCreateStatic( ( uxQueueLength ), ( uxItemSize ), ( pucQueueStorage ), ( pxQueueBuffer ), ( queueQUEUE_TYPE_ORDERED ) )
+
+/*
+ * Remove, without blocking, up to uxMaxItems items whose keys are lower than
+ * xKeyLimit, lowest key first.  The items are copied one after another into
+ * pvBuffer, which must have room for uxMaxItems items.  A task blocked on the
+ * full queue is unblocked for each item removed.
+ *
+ * If the queue is a member of a queue set the set still holds one entry for
+ * each item removed, which the caller must consume.
+ *
+ * @return The number of items removed.
+ */
+UBaseType_t uxQueueReceiveOrderedBelow( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxMaxItems, const TickType_t xKeyLimit ) PRIVILEGED_FUNCTION;
+
+/*
+ * The item held by an ordered reference queue: a buffer and its key.
+ */
+typedef struct QueueOrderedReference
+{
+	TickType_t xKey;
+	void *pvBuffer;
+} QueueOrderedReference_t;
+
+/*
+ * Create an ordered queue that holds up to uxQueueLength buffer references.
+ * xQueueReceiveReference() returns the buffer with the lowest key.
+ */
+#define xQueueCreateOrderedReference( uxQueueLength ) xQueueCreateOrdered( ( uxQueueLength ), sizeof( QueueOrderedReference_t ) )
+#define xQueueCreateOrderedReferenceStatic( uxQueueLength, pucQueueStorage, pxQueueBuffer ) xQueueCreateOrderedStatic( ( uxQueueLength ), sizeof( QueueOrderedReference_t ), ( pucQueueStorage ), ( pxQueueBuffer ) )
+
+/*
+ * Post a buffer to an ordered reference queue under the key xKey.  Ownership
+ * passes as for xQueueSendReference().
+ */
+BaseType_t xQueueSendReferenceOrdered( QueueHandle_t xQueue, void *pvBuffer, TickType_t xKey, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Remove, without blocking, up to uxMaxBuffers buffers whose keys are lower
+ * than xKeyLimit from an ordered reference queue, lowest key first.  The
+ * buffers are written to ppvBuffers and are then owned by the calling task.
+ * As for uxQueueReceiveOrderedBelow(), queue set entries are left to the
+ * caller.
+ *
+ * @return The number of buffers removed.
+ */
+UBaseType_t uxQueueReceiveReferenceBelow( QueueHandle_t xQueue, void **ppvBuffers, const UBaseType_t uxMaxBuffers, const TickType_t xKeyLimit ) PRIVILEGED_FUNCTION;
+
 /* Not public API functions. */
 void vQueueWaitForMessageRestricted( QueueHandle_t xQueue, TickType_t xTicksToWait, const BaseType_t xWaitIndefinitely ) PRIVILEGED_FUNCTION;
 BaseType_t xQueueGenericReset( QueueHandle_t xQueue, BaseType_t xNewQueue ) PRIVILEGED_FUNCTION;
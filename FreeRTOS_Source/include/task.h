@@ -1429,6 +1429,25 @@ BaseType_t xTaskCallApplicationTaskHook( TaskHandle_t xTask, void *pvParameter )
  */
 TaskHandle_t xTaskGetIdleTaskHandle( void ) PRIVILEGED_FUNCTION;
 
+/**
+ * task.h
+ * <pre>uint32_t ulTaskGetRunTimeCounter( TaskHandle_t xTask );</pre>
+ *
+ * configGENERATE_RUN_TIME_STATS must be defined as 1 in FreeRTOSConfig.h for
+ * ulTaskGetRunTimeCounter() to be available.
+ *
+ * Returns the run time accumulated by a single task, in units of the run time
+ * stats clock, including the time the task has spent in the Running state
+ * since it was last switched in.  Unlike uxTaskGetSystemState() it does not
+ * walk the task lists, so it is cheap enough to call periodically.  The count
+ * wraps with the run time stats clock, so callers should only use differences
+ * between two calls made less than one wrap period apart.
+ *
+ * @param xTask Handle of the task to query.  Passing NULL queries the calling
+ * task.
+ */
+uint32_t ulTaskGetRunTimeCounter( TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
 /**
  * configUSE_TRACE_FACILITY must be defined as 1 in FreeRTOSConfig.h for
  * uxTaskGetSystemState() to be available.
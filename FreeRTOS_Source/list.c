@@ -72,6 +72,41 @@
 #include "FreeRTOS.h"
 #include "list.h"
 
+#if( configUSE_DELAYED_TASK_HEAP == 1 )
+
+	/*
+	 * A heap ordered list is a pairing heap.  Each item points to its first
+	 * child through pxChild, and to its next sibling through pxNext.  pxPrevious
+	 * points to the previous sibling, or to the parent for a first child.  The
+	 * root is the only item without siblings and is referenced from
+	 * xListEnd.pxNext, with its pxPrevious pointing back at xListEnd, so the
+	 * head entry macros return the item with the lowest value.
+	 */
+
+	/*
+	 * Join two heaps, returning the root of the result.  The root with the
+	 * larger value becomes the first child of the other.
+	 */
+	static ListItem_t *prvHeapMeld( ListItem_t *pxFirst, ListItem_t *pxSecond ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Join a list of sibling heaps, starting with pxFirst, into one heap using
+	 * the standard two pass pairing.  Returns NULL if pxFirst is NULL.
+	 */
+	static ListItem_t *prvHeapMergePairs( ListItem_t *pxFirst ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Make pxRoot, which may be NULL, the root of the heap held in pxList.
+	 */
+	static void prvHeapSetRoot( List_t * const pxList, ListItem_t *pxRoot ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Remove any item from a heap ordered list.
+	 */
+	static void prvHeapRemove( List_t * const pxList, ListItem_t * const pxItemToRemove ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_DELAYED_TASK_HEAP */
+
 /*-----------------------------------------------------------
  * PUBLIC LIST API documented in list.h
  *----------------------------------------------------------*/
@@ -215,20 +250,29 @@ UBaseType_t uxListRemove( ListItem_t * const pxItemToRemove )
 item. */
 List_t * const pxList = ( List_t * ) pxItemToRemove->pvContainer;
 
-	pxItemToRemove->pxNext->pxPrevious = pxItemToRemove->pxPrevious;
-	pxItemToRemove->pxPrevious->pxNext = pxItemToRemove->pxNext;
-
-	/* Only used during decision coverage testing. */
-	mtCOVERAGE_TEST_DELAY();
-
-	/* Make sure the index is left pointing to a valid item. */
-	if( pxList->pxIndex == pxItemToRemove )
+	#if( configUSE_DELAYED_TASK_HEAP == 1 )
+	if( listLIST_IS_HEAP( pxList ) != pdFALSE )
 	{
-		pxList->pxIndex = pxItemToRemove->pxPrevious;
+		prvHeapRemove( pxList, pxItemToRemove );
 	}
 	else
+	#endif /* configUSE_DELAYED_TASK_HEAP */
 	{
-		mtCOVERAGE_TEST_MARKER();
+		pxItemToRemove->pxNext->pxPrevious = pxItemToRemove->pxPrevious;
+		pxItemToRemove->pxPrevious->pxNext = pxItemToRemove->pxNext;
+
+		/* Only used during decision coverage testing. */
+		mtCOVERAGE_TEST_DELAY();
+
+		/* Make sure the index is left pointing to a valid item. */
+		if( pxList->pxIndex == pxItemToRemove )
+		{
+			pxList->pxIndex = pxItemToRemove->pxPrevious;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
 	}
 
 	pxItemToRemove->pvContainer = NULL;
@@ -238,3 +282,215 @@ List_t * const pxList = ( List_t * ) pxItemToRemove->pvContainer;
 }
 /*-----------------------------------------------------------*/
 
+
+#if( configUSE_DELAYED_TASK_HEAP == 1 )
+
+	void vListInitialiseHeap( List_t * const pxList )
+	{
+		vListInitialise( pxList );
+
+		/* A heap is never walked with listGET_OWNER_OF_NEXT_ENTRY(), so the
+		index is cleared to mark the list as a heap. */
+		pxList->pxIndex = NULL;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vListInsertHeap( List_t * const pxList, ListItem_t * const pxNewListItem )
+	{
+		listTEST_LIST_INTEGRITY( pxList );
+		listTEST_LIST_ITEM_INTEGRITY( pxNewListItem );
+
+		pxNewListItem->pxChild = NULL;
+
+		if( listLIST_IS_EMPTY( pxList ) != pdFALSE )
+		{
+			prvHeapSetRoot( pxList, pxNewListItem );
+		}
+		else
+		{
+			prvHeapSetRoot( pxList, prvHeapMeld( pxList->xListEnd.pxNext, pxNewListItem ) );
+		}
+
+		/* Remember which list the item is in.  This allows fast removal of the
+		item later. */
+		pxNewListItem->pvContainer = ( void * ) pxList;
+
+		( pxList->uxNumberOfItems )++;
+	}
+	/*-----------------------------------------------------------*/
+
+	ListItem_t * pxListHeapNextItem( const ListItem_t * pxItem )
+	{
+	const List_t * const pxList = ( const List_t * ) pxItem->pvContainer;
+	const ListItem_t * const pxEnd = listGET_END_MARKER( pxList );
+	const ListItem_t *pxFirstChild;
+	ListItem_t *pxReturn = pxItem->pxChild;
+
+		/* Pre-order walk: the first child, else the next sibling of the item or
+		of its nearest ancestor that has one. */
+		while( pxReturn == NULL )
+		{
+			pxReturn = pxItem->pxNext;
+			if( pxReturn == NULL )
+			{
+				/* Step back to the first sibling, whose pxPrevious is the
+				parent, then up to the parent. */
+				pxFirstChild = pxItem;
+				while( ( pxFirstChild->pxPrevious != pxEnd ) && ( pxFirstChild->pxPrevious->pxChild != pxFirstChild ) )
+				{
+					pxFirstChild = pxFirstChild->pxPrevious;
+				}
+
+				pxItem = pxFirstChild->pxPrevious;
+				if( pxItem == pxEnd )
+				{
+					/* Back at the root, so every item has been returned. */
+					break;
+				}
+			}
+		}
+
+		return pxReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static ListItem_t *prvHeapMeld( ListItem_t *pxFirst, ListItem_t *pxSecond )
+	{
+	ListItem_t *pxTemp;
+
+		if( pxSecond->xItemValue < pxFirst->xItemValue )
+		{
+			pxTemp = pxFirst;
+			pxFirst = pxSecond;
+			pxSecond = pxTemp;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxSecond->pxNext = pxFirst->pxChild;
+		if( pxSecond->pxNext != NULL )
+		{
+			pxSecond->pxNext->pxPrevious = pxSecond;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxSecond->pxPrevious = pxFirst;
+		pxFirst->pxChild = pxSecond;
+
+		return pxFirst;
+	}
+	/*-----------------------------------------------------------*/
+
+	static ListItem_t *prvHeapMergePairs( ListItem_t *pxFirst )
+	{
+	ListItem_t *pxPairs = NULL, *pxMerged, *pxNext;
+
+		/* First pass, left to right: meld the siblings in pairs, stacking the
+		results through pxNext. */
+		while( pxFirst != NULL )
+		{
+			pxNext = pxFirst->pxNext;
+			if( pxNext != NULL )
+			{
+				pxMerged = pxNext->pxNext;
+				pxFirst = prvHeapMeld( pxFirst, pxNext );
+				pxNext = pxMerged;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxFirst->pxNext = pxPairs;
+			pxPairs = pxFirst;
+			pxFirst = pxNext;
+		}
+
+		/* Second pass, right to left: meld each pair into the result. */
+		pxMerged = pxPairs;
+		if( pxMerged != NULL )
+		{
+			pxPairs = pxMerged->pxNext;
+			while( pxPairs != NULL )
+			{
+				pxNext = pxPairs->pxNext;
+				pxMerged = prvHeapMeld( pxMerged, pxPairs );
+				pxPairs = pxNext;
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return pxMerged;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvHeapSetRoot( List_t * const pxList, ListItem_t *pxRoot )
+	{
+		if( pxRoot != NULL )
+		{
+			pxRoot->pxNext = NULL;
+			pxRoot->pxPrevious = ( ListItem_t * ) &( pxList->xListEnd );	/*lint !e826 !e740 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+			pxList->xListEnd.pxNext = pxRoot;
+		}
+		else
+		{
+			pxList->xListEnd.pxNext = ( ListItem_t * ) &( pxList->xListEnd );	/*lint !e826 !e740 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvHeapRemove( List_t * const pxList, ListItem_t * const pxItemToRemove )
+	{
+	ListItem_t * const pxPrevious = pxItemToRemove->pxPrevious;
+	ListItem_t *pxChildren;
+
+		pxChildren = prvHeapMergePairs( pxItemToRemove->pxChild );
+
+		if( pxList->xListEnd.pxNext == pxItemToRemove )
+		{
+			/* Removing the root: its children form the new heap. */
+			prvHeapSetRoot( pxList, pxChildren );
+		}
+		else
+		{
+			/* Unlink the item from its siblings, then meld its children back
+			in at the root. */
+			if( pxPrevious->pxChild == pxItemToRemove )
+			{
+				pxPrevious->pxChild = pxItemToRemove->pxNext;
+			}
+			else
+			{
+				pxPrevious->pxNext = pxItemToRemove->pxNext;
+			}
+
+			if( pxItemToRemove->pxNext != NULL )
+			{
+				pxItemToRemove->pxNext->pxPrevious = pxPrevious;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			if( pxChildren != NULL )
+			{
+				prvHeapSetRoot( pxList, prvHeapMeld( pxList->xListEnd.pxNext, pxChildren ) );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+	}
+
+#endif /* configUSE_DELAYED_TASK_HEAP */
+/*-----------------------------------------------------------*/
@@ -417,6 +417,7 @@ void vPortEnterCritical( void )
 	if( uxCriticalNesting == 1 )
 	{
 		configASSERT( ( portNVIC_INT_CTRL_REG & portVECTACTIVE_MASK ) == 0 );
+		traceCRITICAL_ENTER();
 	}
 }
 /*-----------------------------------------------------------*/
@@ -427,6 +428,7 @@ void vPortExitCritical( void )
 	uxCriticalNesting--;
 	if( uxCriticalNesting == 0 )
 	{
+		traceCRITICAL_EXIT();
 		portENABLE_INTERRUPTS();
 	}
 }
@@ -498,6 +500,9 @@ void xPortSysTickHandler( void )
 	known. */
 	portDISABLE_INTERRUPTS();
 	{
+		traceISR_MASK( xPortSysTickHandler );
+		traceISR_ENTER();
+
 		/* Increment the RTOS tick. */
 		if( xTaskIncrementTick() != pdFALSE )
 		{
@@ -505,6 +510,9 @@ void xPortSysTickHandler( void )
 			the PendSV interrupt.  Pend the PendSV interrupt. */
 			portNVIC_INT_CTRL_REG = portNVIC_PENDSVSET_BIT;
 		}
+
+		traceISR_EXIT();
+		traceISR_UNMASK();
 	}
 	portENABLE_INTERRUPTS();
 }
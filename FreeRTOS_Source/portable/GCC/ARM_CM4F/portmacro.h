@@ -138,8 +138,27 @@ typedef unsigned long UBaseType_t;
 /* Critical section management. */
 extern void vPortEnterCritical( void );
 extern void vPortExitCritical( void );
-#define portSET_INTERRUPT_MASK_FROM_ISR()		ulPortRaiseBASEPRI()
-#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)	vPortSetBASEPRI(x)
+/* The FromISR masks call the trace hooks only at the outermost level, where
+the previous mask was 0.  They expand inside the calling API function, so the
+hook's site is the code that called it. */
+#define portSET_INTERRUPT_MASK_FROM_ISR()																\
+	__extension__ ( {																					\
+		uint32_t ulMaskWas = ulPortRaiseBASEPRI();														\
+		if( ulMaskWas == 0 )																			\
+		{																								\
+			traceISR_MASK( __builtin_return_address( 0 ) );												\
+		}																								\
+		ulMaskWas;																						\
+	} )
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)															\
+	do																									\
+	{																									\
+		if( ( x ) == 0 )																				\
+		{																								\
+			traceISR_UNMASK();																			\
+		}																								\
+		vPortSetBASEPRI( x );																			\
+	} while( 0 )
 #define portDISABLE_INTERRUPTS()				vPortRaiseBASEPRI()
 #define portENABLE_INTERRUPTS()					vPortSetBASEPRI(0)
 #define portENTER_CRITICAL()					vPortEnterCritical()
@@ -177,12 +196,8 @@ not necessary for to use this port.  They are defined so the common demo files
 		return ucReturn;
 	}
 
-	/* Check the configuration. */
-	#if( configMAX_PRIORITIES > 32 )
-		#error configUSE_PORT_OPTIMISED_TASK_SELECTION can only be set to 1 when configMAX_PRIORITIES is less than or equal to 32.  It is very rare that a system requires more than 10 to 15 difference priorities as tasks that share a priority will time slice.
-	#endif
-
-	/* Store/clear the ready priorities in a bit map. */
+	/* Store/clear the ready priorities in a bit map.  Above 32 priorities
+	tasks.c keeps a second level of bit maps and uses these macros on both. */
 	#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
 	#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
 
@@ -202,6 +217,8 @@ not necessary for to use this port.  They are defined so the common demo files
 /* portNOP() is not required by this port. */
 #define portNOP()
 
+#define portMEMORY_BARRIER() __asm volatile( "" ::: "memory" )
+
 #define portINLINE	__inline
 
 #ifndef portFORCE_INLINE
@@ -0,0 +1,452 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for a Linux host.
+ *
+ * Every task runs on its own pthread, but the threads pass a single "CPU"
+ * between them: a thread only executes task code while it is the running
+ * thread, and waits on its own semaphore otherwise.
+ *
+ * The thread that called vTaskStartScheduler() becomes the tick interrupt.
+ * It waits for the SIGALRM generated by an interval timer, takes the kernel
+ * mutex (which is what a critical section holds) and calls
+ * xTaskIncrementTick().  If a context switch is required the running thread
+ * is stopped with portSUSPEND_SIGNAL before the next task's thread is woken.
+ *
+ * A task can be stopped at any instruction outside a critical section, which
+ * includes the middle of a C library call.  Tasks should therefore only use
+ * async-signal-safe library functions such as write(), or call the library
+ * through pvPortMalloc() or from inside a critical section.
+ *----------------------------------------------------------*/
+
+/* Standard includes. */
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Signal used to stop the running thread when the tick preempts it. */
+#define portSUSPEND_SIGNAL			SIGUSR1
+
+/* Size of the host stack given to each task thread.  The FreeRTOS stack of
+the task is only used to hold the thread's control block. */
+#define portTHREAD_STACK_SIZE		( 128 * 1024 )
+
+typedef struct THREAD
+{
+	pthread_t xPthread;
+	sem_t xWake;
+	TaskFunction_t pxCode;
+	void *pvParameters;
+	volatile BaseType_t xDying;
+} Thread_t;
+
+/* The task control block of the task selected to run.  Its first member is
+the top of stack pointer, which this port sets to the task's Thread_t. */
+extern void * volatile pxCurrentTCB;
+
+/* Held while "interrupts are disabled". */
+static pthread_mutex_t xKernelMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Posted by a thread once it has stopped in response to portSUSPEND_SIGNAL. */
+static sem_t xSuspendAck;
+
+static pthread_once_t xPortInitialised = PTHREAD_ONCE_INIT;
+static Thread_t * volatile pxRunningThread = NULL;
+static volatile BaseType_t xSchedulerEnd = pdFALSE;
+
+/* Per thread state.  The critical nesting count of a task is kept by its own
+thread so is preserved across context switches without saving it. */
+static __thread Thread_t *pxThisThread = NULL;
+static __thread UBaseType_t uxCriticalNesting = 0;
+static __thread BaseType_t xYieldPending = pdFALSE;
+
+/*
+ * One time set up of the signal handling shared by all threads.
+ */
+static void prvPortInit( void );
+
+/*
+ * Entry point of every task thread.
+ */
+static void *prvThreadEntry( void *pvParameters );
+
+/*
+ * Wait until the scheduler passes the CPU back to the calling thread.
+ */
+static void prvSuspendSelf( Thread_t *pxThread );
+
+/*
+ * Handler of portSUSPEND_SIGNAL, run by the thread being preempted.
+ */
+static void prvSuspendSignalHandler( int iSignal );
+
+/*
+ * Pass the CPU from the running thread to the thread of pxCurrentTCB.  Must be
+ * called with the kernel mutex held.
+ */
+static void prvSwitchThread( BaseType_t xFromTick );
+
+/*
+ * Start the first task and process ticks until vPortEndScheduler() is called.
+ */
+static void prvTickLoop( void );
+
+/*-----------------------------------------------------------*/
+
+static Thread_t *prvGetThreadFromTCB( void *pxTCB )
+{
+	return *( Thread_t ** ) pxTCB;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPortInit( void )
+{
+struct sigaction xAction;
+sigset_t xSignals;
+
+	sem_init( &xSuspendAck, 0, 0 );
+
+	memset( &xAction, 0, sizeof( xAction ) );
+	xAction.sa_handler = prvSuspendSignalHandler;
+	xAction.sa_flags = SA_RESTART;
+	sigfillset( &xAction.sa_mask );
+	sigaction( portSUSPEND_SIGNAL, &xAction, NULL );
+
+	/* SIGALRM is only ever consumed by sigwait() in the tick loop, so it is
+	blocked here before any task thread inherits the signal mask. */
+	sigemptyset( &xSignals );
+	sigaddset( &xSignals, SIGALRM );
+	pthread_sigmask( SIG_BLOCK, &xSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+Thread_t *pxThread;
+pthread_attr_t xAttributes;
+uintptr_t uxAddress;
+
+	pthread_once( &xPortInitialised, prvPortInit );
+
+	/* The thread control block lives at the top of the task's stack. */
+	uxAddress = ( uintptr_t ) ( pxTopOfStack + 1 ) - sizeof( Thread_t );
+	uxAddress &= ~( ( uintptr_t ) portBYTE_ALIGNMENT_MASK );
+	pxThread = ( Thread_t * ) uxAddress;
+
+	pxThread->pxCode = pxCode;
+	pxThread->pvParameters = pvParameters;
+	pxThread->xDying = pdFALSE;
+	sem_init( &pxThread->xWake, 0, 0 );
+
+	pthread_attr_init( &xAttributes );
+	pthread_attr_setstacksize( &xAttributes, portTHREAD_STACK_SIZE );
+
+	/* pthread_create() takes C library locks, so the creating task must not be
+	preempted while inside it. */
+	vPortEnterCritical();
+	if( pthread_create( &pxThread->xPthread, &xAttributes, prvThreadEntry, pxThread ) != 0 )
+	{
+		fprintf( stderr, "pthread_create failed: %s\n", strerror( errno ) );
+		abort();
+	}
+	vPortExitCritical();
+
+	pthread_attr_destroy( &xAttributes );
+
+	return ( StackType_t * ) pxThread;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvThreadEntry( void *pvParameters )
+{
+Thread_t *pxThread = ( Thread_t * ) pvParameters;
+
+	pxThisThread = pxThread;
+
+	/* Wait to be selected by the scheduler for the first time. */
+	prvSuspendSelf( pxThread );
+
+	pxThread->pxCode( pxThread->pvParameters );
+
+	/* Tasks must not return, but deleting the task is the closest equivalent
+	on a host. */
+	vTaskDelete( NULL );
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuspendSelf( Thread_t *pxThread )
+{
+	/* sem_wait() is not restarted after a signal handler has run. */
+	while( sem_wait( &pxThread->xWake ) != 0 )
+	{
+	}
+
+	if( pxThread->xDying != pdFALSE )
+	{
+		pthread_exit( NULL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuspendSignalHandler( int iSignal )
+{
+int iSavedErrno = errno;
+
+	( void ) iSignal;
+
+	/* The tick thread holds the kernel mutex until this thread has stopped,
+	so no other task can run before the acknowledgement. */
+	sem_post( &xSuspendAck );
+	prvSuspendSelf( pxThisThread );
+
+	errno = iSavedErrno;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchThread( BaseType_t xFromTick )
+{
+Thread_t *pxPrevious = pxRunningThread;
+Thread_t *pxNext;
+
+	vTaskSwitchContext();
+	pxNext = prvGetThreadFromTCB( pxCurrentTCB );
+
+	if( pxNext != pxPrevious )
+	{
+		if( ( xFromTick != pdFALSE ) && ( pxPrevious != NULL ) )
+		{
+			/* Stop the preempted thread before its replacement starts. */
+			pthread_kill( pxPrevious->xPthread, portSUSPEND_SIGNAL );
+			while( sem_wait( &xSuspendAck ) != 0 )
+			{
+			}
+		}
+
+		pxRunningThread = pxNext;
+		sem_post( &pxNext->xWake );
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+	pthread_once( &xPortInitialised, prvPortInit );
+
+	/* This thread becomes the tick interrupt and does not return until the
+	scheduler is stopped. */
+	prvTickLoop();
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTickLoop( void )
+{
+struct itimerval xTimer;
+sigset_t xSignals;
+int iSignal;
+BaseType_t xSwitchRequired;
+
+	sigemptyset( &xSignals );
+	sigaddset( &xSignals, SIGALRM );
+
+	xTimer.it_interval.tv_sec = 0;
+	xTimer.it_interval.tv_usec = 1000000 / configTICK_RATE_HZ;
+	xTimer.it_value = xTimer.it_interval;
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+
+	/* Start the first task. */
+	pthread_mutex_lock( &xKernelMutex );
+	pxRunningThread = prvGetThreadFromTCB( pxCurrentTCB );
+	sem_post( &pxRunningThread->xWake );
+	pthread_mutex_unlock( &xKernelMutex );
+
+	while( xSchedulerEnd == pdFALSE )
+	{
+		sigwait( &xSignals, &iSignal );
+
+		/* Equivalent to the tick interrupt being masked by a critical
+		section: the tick waits until the running task leaves it. */
+		vPortEnterCritical();
+		traceISR_ENTER();
+		xSwitchRequired = ( ( xSchedulerEnd == pdFALSE ) && ( xTaskIncrementTick() != pdFALSE ) );
+		traceISR_EXIT();
+		if( xSwitchRequired != pdFALSE )
+		{
+			prvSwitchThread( pdTRUE );
+		}
+		vPortExitCritical();
+	}
+
+	xTimer.it_value.tv_sec = 0;
+	xTimer.it_value.tv_usec = 0;
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+	xSchedulerEnd = pdTRUE;
+
+	/* Wake the tick loop so vTaskStartScheduler() returns, then stop the
+	calling task for good. */
+	kill( getpid(), SIGALRM );
+	if( pxThisThread != NULL )
+	{
+		for( ;; )
+		{
+			prvSuspendSelf( pxThisThread );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+Thread_t *pxSelf = pxThisThread;
+BaseType_t xSwitched;
+
+	if( uxCriticalNesting != 0 )
+	{
+		/* Held until the critical section exits, as PendSV would be. */
+		xYieldPending = pdTRUE;
+		return;
+	}
+
+	pthread_mutex_lock( &xKernelMutex );
+	prvSwitchThread( pdFALSE );
+	xSwitched = ( pxRunningThread != pxSelf );
+	pthread_mutex_unlock( &xKernelMutex );
+
+	/* The next thread has already been woken, so this thread waits for its
+	turn.  A wake posted before the wait starts, for example by a tick that
+	selects this task again, is counted by the semaphore and not lost. */
+	if( xSwitched != pdFALSE )
+	{
+		prvSuspendSelf( pxSelf );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	if( uxCriticalNesting == 0 )
+	{
+		pthread_mutex_lock( &xKernelMutex );
+		traceCRITICAL_ENTER();
+	}
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	configASSERT( uxCriticalNesting );
+	uxCriticalNesting--;
+	if( uxCriticalNesting == 0 )
+	{
+		traceCRITICAL_EXIT();
+		pthread_mutex_unlock( &xKernelMutex );
+
+		if( xYieldPending != pdFALSE )
+		{
+			xYieldPending = pdFALSE;
+			vPortYield();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortCancelThread( void *pxTaskToDelete )
+{
+Thread_t *pxThread = prvGetThreadFromTCB( pxTaskToDelete );
+
+	/* The thread is waiting in prvSuspendSelf(), either after yielding or
+	after being preempted, so waking it with xDying set makes it exit.  It has
+	to be joined before the stack holding its Thread_t is freed. */
+	pxThread->xDying = pdTRUE;
+	sem_post( &pxThread->xWake );
+	pthread_join( pxThread->xPthread, NULL );
+	sem_destroy( &pxThread->xWake );
+}
+/*-----------------------------------------------------------*/
+
@@ -0,0 +1,322 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for a single threaded,
+ * virtual time simulation on a Linux host.
+ *
+ * Each task is a ucontext fiber with its own host stack.  Nothing runs
+ * asynchronously: the tick "interrupt" is taken by the running fiber the
+ * moment it leaves a critical section, yields or (for the idle task) loops,
+ * once portEVENTS_PER_TICK such events have happened since the previous tick.
+ * A task busy waiting on xTaskGetTickCount() therefore sees time pass, while
+ * time stands still for code that does not enter the kernel.
+ *
+ * When every task is blocked the idle task's tickless sleep steps the tick
+ * count to one tick before the next timeout and makes the next event the
+ * tick that unblocks it.  The same program with the same inputs always
+ * produces the same interleaving.
+ *----------------------------------------------------------*/
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Size of the host stack given to each fiber.  The FreeRTOS stack of the task
+is only used to hold a pointer to its fiber. */
+#define portFIBER_STACK_SIZE		( 64 * 1024 )
+
+typedef struct FIBER
+{
+	ucontext_t xContext;
+	TaskFunction_t pxCode;
+	void *pvParameters;
+	void *pvStack;
+} Fiber_t;
+
+/* The task control block of the task selected to run.  Its first member is
+the top of stack pointer, which points at the word holding the task's
+Fiber_t. */
+extern void * volatile pxCurrentTCB;
+
+/* Context of the caller of vTaskStartScheduler(), restored when the
+scheduler is stopped. */
+static ucontext_t xSchedulerContext;
+
+static Fiber_t *pxRunningFiber = NULL;
+static UBaseType_t uxCriticalNesting = 0;
+static BaseType_t xYieldPending = pdFALSE;
+
+/* Kernel events since the last tick, and ticks since the scheduler started
+including those stepped over while idle. */
+static uint32_t ulEventCount = 0;
+static TickType_t xVirtualTicks = 0;
+
+/*
+ * Entry point of every fiber.
+ */
+static void prvFiberEntry( void );
+
+/*
+ * Switch to the fiber of the task selected by vTaskSwitchContext().
+ */
+static void prvSwitchFiber( void );
+
+/*
+ * Count one kernel event, taking the tick interrupt if it is due, and
+ * switch tasks if a yield is required.
+ */
+static void prvProcessEvent( BaseType_t xYieldRequired );
+
+/*-----------------------------------------------------------*/
+
+static Fiber_t *prvGetFiberFromTCB( void *pxTCB )
+{
+	return ( Fiber_t * ) **( StackType_t ** ) pxTCB;
+}
+/*-----------------------------------------------------------*/
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+Fiber_t *pxFiber = ( Fiber_t * ) malloc( sizeof( Fiber_t ) );
+
+	if( pxFiber != NULL )
+	{
+		pxFiber->pvStack = malloc( portFIBER_STACK_SIZE );
+	}
+
+	if( ( pxFiber == NULL ) || ( pxFiber->pvStack == NULL ) )
+	{
+		fprintf( stderr, "Unable to allocate a fiber\n" );
+		abort();
+	}
+
+	pxFiber->pxCode = pxCode;
+	pxFiber->pvParameters = pvParameters;
+
+	getcontext( &pxFiber->xContext );
+	pxFiber->xContext.uc_stack.ss_sp = pxFiber->pvStack;
+	pxFiber->xContext.uc_stack.ss_size = portFIBER_STACK_SIZE;
+	pxFiber->xContext.uc_link = NULL;
+	makecontext( &pxFiber->xContext, prvFiberEntry, 0 );
+
+	*pxTopOfStack = ( StackType_t ) pxFiber;
+
+	return pxTopOfStack;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFiberEntry( void )
+{
+Fiber_t *pxFiber = pxRunningFiber;
+
+	pxFiber->pxCode( pxFiber->pvParameters );
+
+	/* Tasks must not return, but deleting the task is the closest equivalent
+	on a host.  The fiber is never switched back to. */
+	vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchFiber( void )
+{
+Fiber_t *pxPrevious = pxRunningFiber;
+Fiber_t *pxNext;
+
+	vTaskSwitchContext();
+	pxNext = prvGetFiberFromTCB( pxCurrentTCB );
+
+	if( pxNext != pxPrevious )
+	{
+		pxRunningFiber = pxNext;
+		swapcontext( &pxPrevious->xContext, &pxNext->xContext );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessEvent( BaseType_t xYieldRequired )
+{
+	if( ++ulEventCount >= portEVENTS_PER_TICK )
+	{
+		ulEventCount = 0;
+		xVirtualTicks++;
+
+		/* The tick handler runs with "interrupts" masked. */
+		uxCriticalNesting++;
+		traceISR_MASK( prvProcessEvent );
+		traceISR_ENTER();
+		if( xTaskIncrementTick() != pdFALSE )
+		{
+			xYieldRequired = pdTRUE;
+		}
+		traceISR_EXIT();
+		traceISR_UNMASK();
+		uxCriticalNesting--;
+
+		if( ( portVIRTUAL_END_TICK != 0 ) && ( xVirtualTicks >= ( TickType_t ) portVIRTUAL_END_TICK ) )
+		{
+			exit( 0 );
+		}
+	}
+
+	if( xYieldRequired != pdFALSE )
+	{
+		prvSwitchFiber();
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+	/* Start the first task.  Control only comes back here when the scheduler
+	is stopped. */
+	pxRunningFiber = prvGetFiberFromTCB( pxCurrentTCB );
+	swapcontext( &xSchedulerContext, &pxRunningFiber->xContext );
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+	setcontext( &xSchedulerContext );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	if( uxCriticalNesting != 0 )
+	{
+		/* Held until the critical section exits, as PendSV would be. */
+		xYieldPending = pdTRUE;
+		return;
+	}
+
+	prvProcessEvent( pdTRUE );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	if( uxCriticalNesting++ == 0 )
+	{
+		traceCRITICAL_ENTER();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+BaseType_t xYieldRequired;
+
+	configASSERT( uxCriticalNesting );
+	uxCriticalNesting--;
+	if( uxCriticalNesting == 0 )
+	{
+		traceCRITICAL_EXIT();
+		xYieldRequired = xYieldPending;
+		xYieldPending = pdFALSE;
+		prvProcessEvent( xYieldRequired );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortIdleTaskHook( void )
+{
+	prvProcessEvent( pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+{
+	/* Called by the idle task with the scheduler suspended.  Nothing can
+	happen before the next timeout, so skip to the tick before it and make the
+	next kernel event, in xTaskResumeAll(), the tick that ends the sleep. */
+	vTaskStepTick( xExpectedIdleTime - 1 );
+	xVirtualTicks += xExpectedIdleTime - 1;
+	ulEventCount = portEVENTS_PER_TICK - 1;
+}
+/*-----------------------------------------------------------*/
+
+void vPortDeleteFiber( void *pxTaskToDelete )
+{
+Fiber_t *pxFiber = prvGetFiberFromTCB( pxTaskToDelete );
+
+	/* A task is never cleaned up from its own fiber: self deletion is
+	completed later by the idle task. */
+	free( pxFiber->pvStack );
+	free( pxFiber );
+}
+/*-----------------------------------------------------------*/
+
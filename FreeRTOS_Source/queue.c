@@ -122,6 +122,24 @@ zero. */
 	#define queueYIELD_IF_USING_PREEMPTION() portYIELD_WITHIN_API()
 #endif
 
+#if ( configUSE_ORDERED_QUEUES == 1 )
+	/* The bytes after each item of an ordered queue that hold its sequence
+	number. */
+	#define queueORDERED_SEQUENCE_SIZE	sizeof( UBaseType_t )
+#endif
+
+#if ( configUSE_REFERENCE_QUEUES == 1 )
+	/* Ownership of a pool buffer, recorded in the header that precedes it. */
+	#define queueBUFFER_FREE			( ( UBaseType_t ) 0U )
+	#define queueBUFFER_OWNED			( ( UBaseType_t ) 1U )
+	#define queueBUFFER_QUEUED			( ( UBaseType_t ) 2U )
+
+	/* Header and pool sizes rounded up so the buffers stay aligned. */
+	#define queueALIGN_UP( x )			( ( ( x ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+	#define queueBUFFER_HEADER_SIZE		queueALIGN_UP( sizeof( BufferHeader_t ) )
+	#define queueBUFFER_POOL_SIZE		queueALIGN_UP( sizeof( BufferPool_t ) )
+#endif
+
 /*
  * Definition of the queue used by the scheduler.
  * Items are queued by copy, not reference.  See the following link for the
@@ -162,12 +180,40 @@ typedef struct QueueDefinition
 		uint8_t ucQueueType;
 	#endif
 
+	#if ( configUSE_ORDERED_QUEUES == 1 )
+		uint8_t ucOrdered;			/*< Set to pdTRUE if the storage area is a heap ordered by the key at the start of each item rather than a FIFO. */
+		UBaseType_t uxOrderedSequence;	/*< The sequence number the next item sent to an ordered queue is stored with. */
+	#endif
+
 } xQUEUE;
 
 /* The old xQUEUE name is maintained above then typedefed to the new Queue_t
 name below to enable the use of older kernel aware debuggers. */
 typedef xQUEUE Queue_t;
 
+#if ( configUSE_REFERENCE_QUEUES == 1 )
+
+	/* A buffer pool.  The buffers, each preceded by a BufferHeader_t, follow
+	the pool structure in the same allocation or live in storage supplied by
+	the application.  The free buffers are held in a queue of pointers so tasks
+	can block waiting for one. */
+	typedef struct QueueBufferPool
+	{
+		QueueHandle_t xFreeBuffers;
+		uint8_t *pucBuffers;			/*< The header of the first buffer. */
+		UBaseType_t uxBufferCount;
+		size_t xStride;					/*< The bytes from one header to the next. */
+	} BufferPool_t;
+
+	typedef struct QueueBufferHeader
+	{
+		BufferPool_t *pxPool;
+		volatile UBaseType_t uxOwnership;
+		TaskHandle_t xOwner;			/*< The task holding the buffer, or NULL while it is free or queued. */
+	} BufferHeader_t;
+
+#endif /* configUSE_REFERENCE_QUEUES */
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -232,6 +278,22 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue, const void *pvIte
  */
 static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_ORDERED_QUEUES == 1 )
+	/*
+	 * The items of an ordered queue are held as a binary heap in the storage
+	 * area, with the item that has the lowest key first.  Each item is followed
+	 * by the sequence number it was sent with, which orders items with equal
+	 * keys.  Reading an item copies the first one, so prvCopyDataFromQueue() is
+	 * unchanged for peeks, and prvRemoveOrderedHead() restores the heap when
+	 * the item is removed.
+	 */
+	static TickType_t prvGetOrderedKey( const int8_t *pcItem ) PRIVILEGED_FUNCTION;
+	static UBaseType_t prvGetOrderedSequence( const Queue_t * const pxQueue, const int8_t *pcSlot ) PRIVILEGED_FUNCTION;
+	static BaseType_t prvOrderedIsBefore( const TickType_t xKeyA, const UBaseType_t uxSequenceA, const TickType_t xKeyB, const UBaseType_t uxSequenceB ) PRIVILEGED_FUNCTION;
+	static void prvInsertOrdered( Queue_t * const pxQueue, const void *pvItemToQueue, const UBaseType_t uxMessagesWaiting ) PRIVILEGED_FUNCTION;
+	static void prvRemoveOrderedHead( Queue_t * const pxQueue ) PRIVILEGED_FUNCTION;
+#endif
+
 #if ( configUSE_QUEUE_SETS == 1 )
 	/*
 	 * Checks to see if a queue is a member of a queue set, and if so, notifies
@@ -401,6 +463,19 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			/* Allocate enough space to hold the maximum number of items that
 			can be in the queue at any time. */
 			xQueueSizeInBytes = ( size_t ) ( uxQueueLength * uxItemSize ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+
+			#if ( configUSE_ORDERED_QUEUES == 1 )
+			{
+				if( ucQueueType == queueQUEUE_TYPE_ORDERED )
+				{
+					xQueueSizeInBytes = queueORDERED_STORAGE_SIZE( uxQueueLength, uxItemSize );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			#endif /* configUSE_ORDERED_QUEUES */
 		}
 
 		pxNewQueue = ( Queue_t * ) pvPortMalloc( sizeof( Queue_t ) + xQueueSizeInBytes );
@@ -461,6 +536,22 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength, const UBaseT
 	}
 	#endif /* configUSE_TRACE_FACILITY */
 
+	#if ( configUSE_ORDERED_QUEUES == 1 )
+	{
+		if( ucQueueType == queueQUEUE_TYPE_ORDERED )
+		{
+			/* Each item starts with its key. */
+			configASSERT( uxItemSize >= sizeof( TickType_t ) );
+			pxNewQueue->ucOrdered = pdTRUE;
+			pxNewQueue->uxOrderedSequence = ( UBaseType_t ) 0;
+		}
+		else
+		{
+			pxNewQueue->ucOrdered = pdFALSE;
+		}
+	}
+	#endif /* configUSE_ORDERED_QUEUES */
+
 	#if( configUSE_QUEUE_SETS == 1 )
 	{
 		pxNewQueue->pxQueueSetContainer = NULL;
@@ -1273,6 +1364,12 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 				{
 					traceQUEUE_RECEIVE( pxQueue );
 
+					#if ( configUSE_ORDERED_QUEUES == 1 )
+					{
+						prvRemoveOrderedHead( pxQueue );
+					}
+					#endif /* configUSE_ORDERED_QUEUES */
+
 					/* Actually removing data, not just peeking. */
 					pxQueue->uxMessagesWaiting = uxMessagesWaiting - 1;
 
@@ -1468,6 +1565,13 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			traceQUEUE_RECEIVE_FROM_ISR( pxQueue );
 
 			prvCopyDataFromQueue( pxQueue, pvBuffer );
+
+			#if ( configUSE_ORDERED_QUEUES == 1 )
+			{
+				prvRemoveOrderedHead( pxQueue );
+			}
+			#endif /* configUSE_ORDERED_QUEUES */
+
 			pxQueue->uxMessagesWaiting = uxMessagesWaiting - 1;
 
 			/* If the queue is locked the event list will not be modified.
@@ -1720,6 +1824,24 @@ UBaseType_t uxMessagesWaiting;
 		}
 		#endif /* configUSE_MUTEXES */
 	}
+	#if ( configUSE_ORDERED_QUEUES == 1 )
+	else if( pxQueue->ucOrdered != pdFALSE )
+	{
+		/* The position is ignored as the key decides where the item goes,
+		except that overwriting replaces the only item of a queue of length
+		one. */
+		if( ( xPosition == queueOVERWRITE ) && ( uxMessagesWaiting > ( UBaseType_t ) 0 ) )
+		{
+			--uxMessagesWaiting;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		prvInsertOrdered( pxQueue, pvItemToQueue, uxMessagesWaiting );
+	}
+	#endif /* configUSE_ORDERED_QUEUES */
 	else if( xPosition == queueSEND_TO_BACK )
 	{
 		( void ) memcpy( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports, plus previous logic ensures a null pointer can only be passed to memcpy() if the copy size is 0. */
@@ -1775,6 +1897,14 @@ UBaseType_t uxMessagesWaiting;
 
 static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer )
 {
+	#if ( configUSE_ORDERED_QUEUES == 1 )
+	if( pxQueue->ucOrdered != pdFALSE )
+	{
+		/* The item with the lowest key is always first. */
+		( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->pcHead, ( size_t ) pxQueue->uxItemSize );
+	}
+	else
+	#endif /* configUSE_ORDERED_QUEUES */
 	if( pxQueue->uxItemSize != ( UBaseType_t ) 0 )
 	{
 		pxQueue->u.pcReadFrom += pxQueue->uxItemSize;
@@ -1996,6 +2126,15 @@ BaseType_t xReturn;
 	BaseType_t xReturn;
 	Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 
+		/* Ordered queues are not supported for co-routines.  The co-routine
+		receive functions read items in FIFO order, which would break the heap
+		of an ordered queue. */
+		#if ( configUSE_ORDERED_QUEUES == 1 )
+		{
+			configASSERT( pxQueue->ucOrdered == pdFALSE );
+		}
+		#endif /* configUSE_ORDERED_QUEUES */
+
 		/* If the queue is already full we may have to block.  A critical section
 		is required to prevent an interrupt removing something from the queue
 		between the check to see if the queue is full and blocking on the queue. */
@@ -2073,6 +2212,13 @@ BaseType_t xReturn;
 	BaseType_t xReturn;
 	Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 
+		/* As xQueueCRSend(). */
+		#if ( configUSE_ORDERED_QUEUES == 1 )
+		{
+			configASSERT( pxQueue->ucOrdered == pdFALSE );
+		}
+		#endif /* configUSE_ORDERED_QUEUES */
+
 		/* If the queue is already empty we may have to block.  A critical section
 		is required to prevent an interrupt adding something to the queue
 		between the check to see if the queue is empty and blocking on the queue. */
@@ -2162,6 +2308,13 @@ BaseType_t xReturn;
 	{
 	Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 
+		/* As xQueueCRSend(). */
+		#if ( configUSE_ORDERED_QUEUES == 1 )
+		{
+			configASSERT( pxQueue->ucOrdered == pdFALSE );
+		}
+		#endif /* configUSE_ORDERED_QUEUES */
+
 		/* Cannot block within an ISR so if there is no space on the queue then
 		exit without doing anything. */
 		if( pxQueue->uxMessagesWaiting < pxQueue->uxLength )
@@ -2211,6 +2364,13 @@ BaseType_t xReturn;
 	BaseType_t xReturn;
 	Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 
+		/* As xQueueCRSend(). */
+		#if ( configUSE_ORDERED_QUEUES == 1 )
+		{
+			configASSERT( pxQueue->ucOrdered == pdFALSE );
+		}
+		#endif /* configUSE_ORDERED_QUEUES */
+
 		/* We cannot block from an ISR, so check there is data available. If
 		not then just leave without doing anything. */
 		if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
@@ -2403,6 +2563,20 @@ BaseType_t xReturn;
 #endif /* configUSE_QUEUE_SETS */
 /*-----------------------------------------------------------*/
 
+#if( ( configUSE_QUEUE_SETS == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+
+	QueueSetHandle_t xQueueCreateSetStatic( const UBaseType_t uxEventQueueLength, uint8_t *pucQueueSetStorage, StaticQueue_t *pxStaticQueueSet )
+	{
+	QueueSetHandle_t pxQueue;
+
+		pxQueue = xQueueGenericCreateStatic( uxEventQueueLength, sizeof( Queue_t * ), pucQueueSetStorage, pxStaticQueueSet, queueQUEUE_TYPE_SET );
+
+		return pxQueue;
+	}
+
+#endif /* ( configUSE_QUEUE_SETS == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_QUEUE_SETS == 1 )
 
 	BaseType_t xQueueAddToSet( QueueSetMemberHandle_t xQueueOrSemaphore, QueueSetHandle_t xQueueSet )
@@ -2552,15 +2726,562 @@ BaseType_t xReturn;
 	}
 
 #endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_ORDERED_QUEUES == 1 )
+
+	static TickType_t prvGetOrderedKey( const int8_t *pcItem )
+	{
+	TickType_t xKey;
+
+		/* Items are only aligned to the item size, so the key is copied out
+		rather than read in place. */
+		( void ) memcpy( ( void * ) &xKey, ( const void * ) pcItem, sizeof( TickType_t ) );
+		return xKey;
+	}
+
+#endif /* configUSE_ORDERED_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_ORDERED_QUEUES == 1 )
+
+	static UBaseType_t prvGetOrderedSequence( const Queue_t * const pxQueue, const int8_t *pcSlot )
+	{
+	UBaseType_t uxSequence;
+
+		( void ) memcpy( ( void * ) &uxSequence, ( const void * ) ( pcSlot + pxQueue->uxItemSize ), queueORDERED_SEQUENCE_SIZE );
+		return uxSequence;
+	}
+
+#endif /* configUSE_ORDERED_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_ORDERED_QUEUES == 1 )
+
+	static BaseType_t prvOrderedIsBefore( const TickType_t xKeyA, const UBaseType_t uxSequenceA, const TickType_t xKeyB, const UBaseType_t uxSequenceB )
+	{
+	BaseType_t xReturn;
+
+		if( xKeyA != xKeyB )
+		{
+			xReturn = ( xKeyA < xKeyB ) ? pdTRUE : pdFALSE;
+		}
+		else
+		{
+			/* The queue never holds more items than its length, so the
+			sequence numbers of the items it holds span less than half their
+			range and the difference orders them even across a wrap. */
+			xReturn = ( ( ( UBaseType_t ) ( uxSequenceB - uxSequenceA - ( UBaseType_t ) 1 ) ) < ( ( ( UBaseType_t ) ~( UBaseType_t ) 0 ) >> 1 ) ) ? pdTRUE : pdFALSE;
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_ORDERED_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_ORDERED_QUEUES == 1 )
+
+	static void prvInsertOrdered( Queue_t * const pxQueue, const void *pvItemToQueue, const UBaseType_t uxMessagesWaiting )
+	{
+	const size_t xItemSize = ( size_t ) pxQueue->uxItemSize;
+	const size_t xSlotSize = xItemSize + queueORDERED_SEQUENCE_SIZE;
+	const TickType_t xKey = prvGetOrderedKey( ( const int8_t * ) pvItemToQueue );
+	const UBaseType_t uxSequence = pxQueue->uxOrderedSequence;
+	UBaseType_t uxHole = uxMessagesWaiting, uxParent;
+	int8_t *pcParent;
+
+		/* This function is called from a critical section.  Move parents
+		that come after the new item down until its place is found.  A parent
+		with an equal key was sent earlier, so it stays ahead. */
+		pxQueue->uxOrderedSequence++;
+
+		while( uxHole > ( UBaseType_t ) 0 )
+		{
+			uxParent = ( uxHole - ( UBaseType_t ) 1 ) / ( UBaseType_t ) 2;
+			pcParent = pxQueue->pcHead + ( uxParent * xSlotSize );
+			if( prvOrderedIsBefore( xKey, uxSequence, prvGetOrderedKey( pcParent ), prvGetOrderedSequence( pxQueue, pcParent ) ) == pdFALSE )
+			{
+				break;
+			}
+
+			( void ) memcpy( ( void * ) ( pxQueue->pcHead + ( uxHole * xSlotSize ) ), ( void * ) pcParent, xSlotSize );
+			uxHole = uxParent;
+		}
+
+		( void ) memcpy( ( void * ) ( pxQueue->pcHead + ( uxHole * xSlotSize ) ), pvItemToQueue, xItemSize );
+		( void ) memcpy( ( void * ) ( pxQueue->pcHead + ( uxHole * xSlotSize ) + xItemSize ), ( const void * ) &uxSequence, queueORDERED_SEQUENCE_SIZE );
+	}
+
+#endif /* configUSE_ORDERED_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_ORDERED_QUEUES == 1 )
+
+	static void prvRemoveOrderedHead( Queue_t * const pxQueue )
+	{
+	const size_t xSlotSize = ( size_t ) pxQueue->uxItemSize + queueORDERED_SEQUENCE_SIZE;
+	const UBaseType_t uxLast = pxQueue->uxMessagesWaiting - ( UBaseType_t ) 1;
+	const int8_t * const pcLast = pxQueue->pcHead + ( uxLast * xSlotSize );
+	TickType_t xKey;
+	UBaseType_t uxSequence, uxHole = 0, uxChild;
+	int8_t *pcChild, *pcSibling;
+
+		/* This function is called from a critical section, before the item
+		count is decremented.  The last item fills the hole left by the head
+		and moves down past any child that comes before it. */
+		if( ( pxQueue->ucOrdered != pdFALSE ) && ( uxLast > ( UBaseType_t ) 0 ) )
+		{
+			xKey = prvGetOrderedKey( pcLast );
+			uxSequence = prvGetOrderedSequence( pxQueue, pcLast );
+
+			for( ;; )
+			{
+				uxChild = ( uxHole * ( UBaseType_t ) 2 ) + ( UBaseType_t ) 1;
+				if( uxChild >= uxLast )
+				{
+					break;
+				}
+
+				pcChild = pxQueue->pcHead + ( uxChild * xSlotSize );
+				if( ( uxChild + ( UBaseType_t ) 1 ) < uxLast )
+				{
+					pcSibling = pcChild + xSlotSize;
+					if( prvOrderedIsBefore( prvGetOrderedKey( pcSibling ), prvGetOrderedSequence( pxQueue, pcSibling ), prvGetOrderedKey( pcChild ), prvGetOrderedSequence( pxQueue, pcChild ) ) != pdFALSE )
+					{
+						uxChild++;
+						pcChild = pcSibling;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				if( prvOrderedIsBefore( prvGetOrderedKey( pcChild ), prvGetOrderedSequence( pxQueue, pcChild ), xKey, uxSequence ) == pdFALSE )
+				{
+					break;
+				}
+
+				( void ) memcpy( ( void * ) ( pxQueue->pcHead + ( uxHole * xSlotSize ) ), ( void * ) pcChild, xSlotSize );
+				uxHole = uxChild;
+			}
+
+			( void ) memcpy( ( void * ) ( pxQueue->pcHead + ( uxHole * xSlotSize ) ), ( const void * ) pcLast, xSlotSize );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+#endif /* configUSE_ORDERED_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_ORDERED_QUEUES == 1 )
+
+	UBaseType_t uxQueueReceiveOrderedBelow( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxMaxItems, const TickType_t xKeyLimit )
+	{
+	Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+	int8_t *pcBuffer = ( int8_t * ) pvBuffer;
+	UBaseType_t uxReceived = 0;
+	BaseType_t xYieldRequired = pdFALSE;
+
+		configASSERT( pxQueue );
+		configASSERT( pxQueue->ucOrdered != pdFALSE );
+		configASSERT( !( ( pvBuffer == NULL ) && ( uxMaxItems > ( UBaseType_t ) 0 ) ) );
+
+		taskENTER_CRITICAL();
+		{
+			while( ( uxReceived < uxMaxItems ) &&
+				   ( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 ) &&
+				   ( prvGetOrderedKey( pxQueue->pcHead ) < xKeyLimit ) )
+			{
+				traceQUEUE_RECEIVE( pxQueue );
+
+				prvCopyDataFromQueue( pxQueue, pcBuffer );
+				prvRemoveOrderedHead( pxQueue );
+				pxQueue->uxMessagesWaiting--;
+				pcBuffer += pxQueue->uxItemSize;
+				uxReceived++;
+
+				/* Each item removed makes room for one blocked sender. */
+				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
+				{
+					if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToSend ) ) != pdFALSE )
+					{
+						xYieldRequired = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+
+			if( xYieldRequired != pdFALSE )
+			{
+				queueYIELD_IF_USING_PREEMPTION();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return uxReceived;
+	}
+
+#endif /* configUSE_ORDERED_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_REFERENCE_QUEUES == 1 )
+
+	static BufferHeader_t *prvGetBufferHeader( void *pvBuffer )
+	{
+		return ( BufferHeader_t * ) ( ( ( uint8_t * ) pvBuffer ) - queueBUFFER_HEADER_SIZE );
+	}
 
+#endif /* configUSE_REFERENCE_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_REFERENCE_QUEUES == 1 )
+
+	static void prvInitialiseBufferPool( BufferPool_t *pxPool, uint8_t *pucBuffer, const UBaseType_t uxBufferCount, const size_t xStride )
+	{
+	BufferHeader_t *pxHeader;
+	void *pvBuffer;
+	UBaseType_t x;
+
+		pxPool->pucBuffers = pucBuffer;
+		pxPool->uxBufferCount = uxBufferCount;
+		pxPool->xStride = xStride;
+
+		for( x = ( UBaseType_t ) 0; x < uxBufferCount; x++ )
+		{
+			pxHeader = ( BufferHeader_t * ) pucBuffer;
+			pxHeader->pxPool = pxPool;
+			pxHeader->uxOwnership = queueBUFFER_FREE;
+			pxHeader->xOwner = NULL;
+
+			/* The free queue is exactly as long as the pool, so this cannot
+			fail. */
+			pvBuffer = pucBuffer + queueBUFFER_HEADER_SIZE;
+			( void ) xQueueSend( pxPool->xFreeBuffers, &pvBuffer, ( TickType_t ) 0 );
+
+			pucBuffer += xStride;
+		}
+	}
 
+#endif /* configUSE_REFERENCE_QUEUES */
+/*-----------------------------------------------------------*/
 
+#if ( ( configUSE_REFERENCE_QUEUES == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
 
+	BufferPoolHandle_t xQueueCreateBufferPool( const UBaseType_t uxBufferCount, const size_t xBufferSize )
+	{
+	BufferPool_t *pxPool;
+	const size_t xStride = queueBUFFER_HEADER_SIZE + queueALIGN_UP( xBufferSize );
 
+		configASSERT( uxBufferCount > ( UBaseType_t ) 0 );
 
+		pxPool = ( BufferPool_t * ) pvPortMalloc( queueBUFFER_POOL_SIZE + ( xStride * uxBufferCount ) );
 
+		if( pxPool != NULL )
+		{
+			pxPool->xFreeBuffers = xQueueCreate( uxBufferCount, sizeof( void * ) );
 
+			if( pxPool->xFreeBuffers != NULL )
+			{
+				prvInitialiseBufferPool( pxPool, ( ( uint8_t * ) pxPool ) + queueBUFFER_POOL_SIZE, uxBufferCount, xStride );
+			}
+			else
+			{
+				vPortFree( pxPool );
+				pxPool = NULL;
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return ( BufferPoolHandle_t ) pxPool;
+	}
+
+#endif /* ( configUSE_REFERENCE_QUEUES == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_REFERENCE_QUEUES == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+
+	BufferPoolHandle_t xQueueCreateBufferPoolStatic( const UBaseType_t uxBufferCount, const size_t xBufferSize, uint8_t *pucPoolStorage, StaticBufferPool_t *pxStaticPool )
+	{
+	BufferPool_t * const pxPool = ( BufferPool_t * ) pxStaticPool;
+	const size_t xStride = queueBUFFER_HEADER_SIZE + queueALIGN_UP( xBufferSize );
+
+		configASSERT( uxBufferCount > ( UBaseType_t ) 0 );
+		configASSERT( pucPoolStorage );
+		configASSERT( pxStaticPool );
+
+		/* The buffers must be aligned as they would be if the pool had been
+		allocated, and queueBUFFER_POOL_STORAGE_SIZE() must agree with the
+		real header size. */
+		configASSERT( ( ( ( size_t ) pucPoolStorage ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
+		configASSERT( queueBUFFER_HEADER_SIZE == queueBUFFER_HEADER_BYTES );
+
+		/* StaticBufferPool_t must hold a BufferPool_t followed by the free
+		queue. */
+		configASSERT( sizeof( StaticBufferPool_t ) == ( sizeof( BufferPool_t ) + sizeof( StaticQueue_t ) ) );
+
+		/* The free queue's storage follows the buffers. */
+		pxPool->xFreeBuffers = xQueueCreateStatic( uxBufferCount, sizeof( void * ), pucPoolStorage + ( xStride * uxBufferCount ), &( pxStaticPool->xDummy4 ) );
+		prvInitialiseBufferPool( pxPool, pucPoolStorage, uxBufferCount, xStride );
+
+		return ( BufferPoolHandle_t ) pxPool;
+	}
+
+#endif /* ( configUSE_REFERENCE_QUEUES == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_REFERENCE_QUEUES == 1 )
+
+	void *pvQueueAllocateBuffer( BufferPoolHandle_t xPool, TickType_t xTicksToWait )
+	{
+	BufferPool_t * const pxPool = ( BufferPool_t * ) xPool;
+	BufferHeader_t *pxHeader;
+	void *pvBuffer = NULL;
+
+		configASSERT( pxPool );
+
+		if( xQueueReceive( pxPool->xFreeBuffers, &pvBuffer, xTicksToWait ) == pdPASS )
+		{
+			pxHeader = prvGetBufferHeader( pvBuffer );
+			configASSERT( pxHeader->uxOwnership == queueBUFFER_FREE );
+			pxHeader->uxOwnership = queueBUFFER_OWNED;
+			pxHeader->xOwner = xTaskGetCurrentTaskHandle();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return pvBuffer;
+	}
+
+#endif /* configUSE_REFERENCE_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_REFERENCE_QUEUES == 1 )
+
+	void vQueueReleaseBuffer( void *pvBuffer )
+	{
+	BufferHeader_t * const pxHeader = prvGetBufferHeader( pvBuffer );
+
+		/* Releasing a buffer that is free, still in a queue or held by another
+		task would let two parties use it at once. */
+		configASSERT( pxHeader->uxOwnership == queueBUFFER_OWNED );
+		configASSERT( pxHeader->xOwner == xTaskGetCurrentTaskHandle() );
+		pxHeader->uxOwnership = queueBUFFER_FREE;
+		pxHeader->xOwner = NULL;
+
+		/* Every buffer has a place in the free queue, so this cannot block. */
+		( void ) xQueueSend( pxHeader->pxPool->xFreeBuffers, &pvBuffer, ( TickType_t ) 0 );
+	}
+
+#endif /* configUSE_REFERENCE_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_REFERENCE_QUEUES == 1 )
+
+	void vQueueReclaimBuffers( BufferPoolHandle_t xPool, TaskHandle_t xTask )
+	{
+	BufferPool_t * const pxPool = ( BufferPool_t * ) xPool;
+	uint8_t *pucBuffer;
+	BufferHeader_t *pxHeader;
+	void *pvBuffer;
+	UBaseType_t x;
 
+		configASSERT( pxPool );
+		configASSERT( xTask );
 
+		/* Only xTask moves its own buffers out of the OWNED state, and it is
+		not running while another task reclaims them, so no buffer can change
+		hands during the walk. */
+		pucBuffer = pxPool->pucBuffers;
 
+		for( x = ( UBaseType_t ) 0; x < pxPool->uxBufferCount; x++ )
+		{
+			pxHeader = ( BufferHeader_t * ) pucBuffer;
+
+			if( ( pxHeader->uxOwnership == queueBUFFER_OWNED ) && ( pxHeader->xOwner == xTask ) )
+			{
+				pxHeader->uxOwnership = queueBUFFER_FREE;
+				pxHeader->xOwner = NULL;
+
+				pvBuffer = pucBuffer + queueBUFFER_HEADER_SIZE;
+				( void ) xQueueSend( pxPool->xFreeBuffers, &pvBuffer, ( TickType_t ) 0 );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pucBuffer += pxPool->xStride;
+		}
+	}
+
+#endif /* configUSE_REFERENCE_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_REFERENCE_QUEUES == 1 )
+
+	BaseType_t xQueueSendReference( QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait )
+	{
+	BufferHeader_t * const pxHeader = prvGetBufferHeader( pvBuffer );
+	BaseType_t xReturn;
+
+		configASSERT( ( ( Queue_t * ) xQueue )->uxItemSize == sizeof( void * ) );
+		configASSERT( pxHeader->uxOwnership == queueBUFFER_OWNED );
+		configASSERT( pxHeader->xOwner == xTaskGetCurrentTaskHandle() );
+
+		/* Marked before the send, as the receiver may run and take ownership
+		before xQueueGenericSend() returns. */
+		pxHeader->uxOwnership = queueBUFFER_QUEUED;
+		pxHeader->xOwner = NULL;
+		xReturn = xQueueGenericSend( xQueue, &pvBuffer, xTicksToWait, queueSEND_TO_BACK );
+
+		if( xReturn != pdPASS )
+		{
+			/* Nothing else can have seen the buffer, so the sender keeps it. */
+			pxHeader->uxOwnership = queueBUFFER_OWNED;
+			pxHeader->xOwner = xTaskGetCurrentTaskHandle();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_REFERENCE_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_REFERENCE_QUEUES == 1 )
+
+	BaseType_t xQueueReceiveReference( QueueHandle_t xQueue, void **ppvBuffer, TickType_t xTicksToWait )
+	{
+	BufferHeader_t *pxHeader;
+	BaseType_t xReturn;
+
+		configASSERT( ppvBuffer );
+
+		#if ( configUSE_ORDERED_QUEUES == 1 )
+		if( ( ( Queue_t * ) xQueue )->ucOrdered != pdFALSE )
+		{
+		QueueOrderedReference_t xReference;
+
+			configASSERT( ( ( Queue_t * ) xQueue )->uxItemSize == sizeof( QueueOrderedReference_t ) );
+
+			xReturn = xQueueGenericReceive( xQueue, &xReference, xTicksToWait, pdFALSE );
+			*ppvBuffer = xReference.pvBuffer;
+		}
+		else
+		#endif /* configUSE_ORDERED_QUEUES */
+		{
+			configASSERT( ( ( Queue_t * ) xQueue )->uxItemSize == sizeof( void * ) );
+
+			xReturn = xQueueGenericReceive( xQueue, ppvBuffer, xTicksToWait, pdFALSE );
+		}
+
+		if( xReturn == pdPASS )
+		{
+			pxHeader = prvGetBufferHeader( *ppvBuffer );
+			configASSERT( pxHeader->uxOwnership == queueBUFFER_QUEUED );
+			pxHeader->uxOwnership = queueBUFFER_OWNED;
+			pxHeader->xOwner = xTaskGetCurrentTaskHandle();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_REFERENCE_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_REFERENCE_QUEUES == 1 ) && ( configUSE_ORDERED_QUEUES == 1 ) )
+
+	BaseType_t xQueueSendReferenceOrdered( QueueHandle_t xQueue, void *pvBuffer, TickType_t xKey, TickType_t xTicksToWait )
+	{
+	BufferHeader_t * const pxHeader = prvGetBufferHeader( pvBuffer );
+	QueueOrderedReference_t xReference;
+	BaseType_t xReturn;
+
+		configASSERT( ( ( Queue_t * ) xQueue )->ucOrdered != pdFALSE );
+		configASSERT( ( ( Queue_t * ) xQueue )->uxItemSize == sizeof( QueueOrderedReference_t ) );
+		configASSERT( pxHeader->uxOwnership == queueBUFFER_OWNED );
+		configASSERT( pxHeader->xOwner == xTaskGetCurrentTaskHandle() );
+
+		xReference.xKey = xKey;
+		xReference.pvBuffer = pvBuffer;
+
+		/* As xQueueSendReference(). */
+		pxHeader->uxOwnership = queueBUFFER_QUEUED;
+		pxHeader->xOwner = NULL;
+		xReturn = xQueueGenericSend( xQueue, &xReference, xTicksToWait, queueSEND_TO_BACK );
+
+		if( xReturn != pdPASS )
+		{
+			pxHeader->uxOwnership = queueBUFFER_OWNED;
+			pxHeader->xOwner = xTaskGetCurrentTaskHandle();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xReturn;
+	}
+
+#endif /* ( configUSE_REFERENCE_QUEUES == 1 ) && ( configUSE_ORDERED_QUEUES == 1 ) */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_REFERENCE_QUEUES == 1 ) && ( configUSE_ORDERED_QUEUES == 1 ) )
+
+	UBaseType_t uxQueueReceiveReferenceBelow( QueueHandle_t xQueue, void **ppvBuffers, const UBaseType_t uxMaxBuffers, const TickType_t xKeyLimit )
+	{
+	QueueOrderedReference_t xReference;
+	BufferHeader_t *pxHeader;
+	UBaseType_t uxReceived = 0;
+
+		configASSERT( !( ( ppvBuffers == NULL ) && ( uxMaxBuffers > ( UBaseType_t ) 0 ) ) );
+		configASSERT( ( ( Queue_t * ) xQueue )->uxItemSize == sizeof( QueueOrderedReference_t ) );
+
+		/* One at a time so the references do not need a second array. */
+		while( ( uxReceived < uxMaxBuffers ) &&
+			   ( uxQueueReceiveOrderedBelow( xQueue, &xReference, 1, xKeyLimit ) != ( UBaseType_t ) 0 ) )
+		{
+			pxHeader = prvGetBufferHeader( xReference.pvBuffer );
+			configASSERT( pxHeader->uxOwnership == queueBUFFER_QUEUED );
+			pxHeader->uxOwnership = queueBUFFER_OWNED;
+			pxHeader->xOwner = xTaskGetCurrentTaskHandle();
+			ppvBuffers[ uxReceived ] = xReference.pvBuffer;
+			uxReceived++;
+		}
+
+		return uxReceived;
+	}
 
+#endif /* ( configUSE_REFERENCE_QUEUES == 1 ) && ( configUSE_ORDERED_QUEUES == 1 ) */
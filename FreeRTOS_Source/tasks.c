@@ -153,6 +153,10 @@ a statically allocated stack and a dynamically allocated TCB. */
 	#define static
 #endif
 
+/* Priorities held in each ready bitmap when configUSE_PORT_OPTIMISED_TASK_SELECTION
+is 1.  The port macros handle 32 bit bitmaps. */
+#define taskREADY_GROUP_SIZE	32
+
 #if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
 
 	/* If configUSE_PORT_OPTIMISED_TASK_SELECTION is 0 then task selection is
@@ -190,11 +194,11 @@ a statically allocated stack and a dynamically allocated TCB. */
 
 	/*-----------------------------------------------------------*/
 
-	/* Define away taskRESET_READY_PRIORITY() and portRESET_READY_PRIORITY() as
+	/* Define away taskRESET_READY_PRIORITY() and taskCLEAR_READY_PRIORITY() as
 	they are only required when a port optimised method of task selection is
 	being used. */
 	#define taskRESET_READY_PRIORITY( uxPriority )
-	#define portRESET_READY_PRIORITY( uxPriority, uxTopReadyPriority )
+	#define taskCLEAR_READY_PRIORITY( uxPriority )
 
 #else /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
 
@@ -202,8 +206,55 @@ a statically allocated stack and a dynamically allocated TCB. */
 	performed in a way that is tailored to the particular microcontroller
 	architecture being used. */
 
-	/* A port optimised version is provided.  Call the port defined macros. */
-	#define taskRECORD_READY_PRIORITY( uxPriority )	portRECORD_READY_PRIORITY( uxPriority, uxTopReadyPriority )
+	#if ( configMAX_PRIORITIES <= taskREADY_GROUP_SIZE )
+
+		/* A port optimised version is provided.  Call the port defined macros
+		on the single bitmap held in uxTopReadyPriority. */
+		#define taskRECORD_READY_PRIORITY( uxPriority )	portRECORD_READY_PRIORITY( uxPriority, uxTopReadyPriority )
+		#define taskCLEAR_READY_PRIORITY( uxPriority ) portRESET_READY_PRIORITY( ( uxPriority ), ( uxTopReadyPriority ) )
+		#define taskGET_HIGHEST_PRIORITY( uxTopPriority ) portGET_HIGHEST_PRIORITY( uxTopPriority, uxTopReadyPriority )
+
+	#else
+
+		/* More priorities than bits in a bitmap.  Each group of
+		taskREADY_GROUP_SIZE priorities has its own bitmap in
+		uxReadyPriorityGroups[], and bit N of uxTopReadyPriority is set while
+		group N has a ready task.  The port defined macros are used on both
+		levels, so finding the highest ready priority still takes two count
+		leading zeros operations however many priorities there are. */
+		#define taskREADY_GROUP_COUNT	( ( configMAX_PRIORITIES + taskREADY_GROUP_SIZE - 1 ) / taskREADY_GROUP_SIZE )
+
+		#if( taskREADY_GROUP_COUNT > taskREADY_GROUP_SIZE )
+			#error configMAX_PRIORITIES can be at most 1024 when configUSE_PORT_OPTIMISED_TASK_SELECTION is 1.
+		#endif
+
+		#define taskRECORD_READY_PRIORITY( uxPriority )																	\
+		{																												\
+			portRECORD_READY_PRIORITY( ( uxPriority ) % taskREADY_GROUP_SIZE,											\
+				uxReadyPriorityGroups[ ( uxPriority ) / taskREADY_GROUP_SIZE ] );										\
+			portRECORD_READY_PRIORITY( ( uxPriority ) / taskREADY_GROUP_SIZE, uxTopReadyPriority );					\
+		}
+
+		#define taskCLEAR_READY_PRIORITY( uxPriority )																	\
+		{																												\
+			portRESET_READY_PRIORITY( ( uxPriority ) % taskREADY_GROUP_SIZE,											\
+				uxReadyPriorityGroups[ ( uxPriority ) / taskREADY_GROUP_SIZE ] );										\
+			if( uxReadyPriorityGroups[ ( uxPriority ) / taskREADY_GROUP_SIZE ] == ( UBaseType_t ) 0 )					\
+			{																											\
+				portRESET_READY_PRIORITY( ( uxPriority ) / taskREADY_GROUP_SIZE, uxTopReadyPriority );				\
+			}																											\
+		}
+
+		#define taskGET_HIGHEST_PRIORITY( uxTopPriority )																\
+		{																												\
+		UBaseType_t uxTopGroup;																							\
+																														\
+			portGET_HIGHEST_PRIORITY( uxTopGroup, uxTopReadyPriority );												\
+			portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorityGroups[ uxTopGroup ] );							\
+			uxTopPriority += uxTopGroup * taskREADY_GROUP_SIZE;														\
+		}
+
+	#endif /* configMAX_PRIORITIES */
 
 	/*-----------------------------------------------------------*/
 
@@ -212,7 +263,7 @@ a statically allocated stack and a dynamically allocated TCB. */
 	UBaseType_t uxTopPriority;																		\
 																									\
 		/* Find the highest priority list that contains ready tasks. */								\
-		portGET_HIGHEST_PRIORITY( uxTopPriority, uxTopReadyPriority );								\
+		taskGET_HIGHEST_PRIORITY( uxTopPriority );													\
 		configASSERT( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ uxTopPriority ] ) ) > 0 );		\
 		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) );		\
 	} /* taskSELECT_HIGHEST_PRIORITY_TASK() */
@@ -226,7 +277,7 @@ a statically allocated stack and a dynamically allocated TCB. */
 	{																									\
 		if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ ( uxPriority ) ] ) ) == ( UBaseType_t ) 0 )	\
 		{																								\
-			portRESET_READY_PRIORITY( ( uxPriority ), ( uxTopReadyPriority ) );							\
+			taskCLEAR_READY_PRIORITY( ( uxPriority ) );													\
 		}																								\
 	}
 
@@ -263,6 +314,19 @@ count overflows. */
 	tracePOST_MOVED_TASK_TO_READY_STATE( pxTCB )
 /*-----------------------------------------------------------*/
 
+/*
+ * Place a list item into one of the delayed task lists, which are pairing
+ * heaps when configUSE_DELAYED_TASK_HEAP is 1 and sorted lists otherwise.
+ */
+#if( configUSE_DELAYED_TASK_HEAP == 1 )
+	#define prvInsertInDelayedList( pxList, pxListItem )	vListInsertHeap( ( pxList ), ( pxListItem ) )
+	#define prvInitialiseDelayedList( pxList )				vListInitialiseHeap( ( pxList ) )
+#else
+	#define prvInsertInDelayedList( pxList, pxListItem )	vListInsert( ( pxList ), ( pxListItem ) )
+	#define prvInitialiseDelayedList( pxList )				vListInitialise( ( pxList ) )
+#endif
+/*-----------------------------------------------------------*/
+
 /*
  * Several functions take an TaskHandle_t parameter that can optionally be NULL,
  * where NULL is used to indicate that the handle of the currently executing
@@ -396,6 +460,9 @@ PRIVILEGED_DATA static List_t xPendingReadyList;						/*< Tasks that have been r
 PRIVILEGED_DATA static volatile UBaseType_t uxCurrentNumberOfTasks 	= ( UBaseType_t ) 0U;
 PRIVILEGED_DATA static volatile TickType_t xTickCount 				= ( TickType_t ) 0U;
 PRIVILEGED_DATA static volatile UBaseType_t uxTopReadyPriority 		= tskIDLE_PRIORITY;
+#if ( ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 ) && ( configMAX_PRIORITIES > taskREADY_GROUP_SIZE ) )
+	PRIVILEGED_DATA static volatile UBaseType_t uxReadyPriorityGroups[ taskREADY_GROUP_COUNT ];	/*< The second level of the ready bitmap, one per group of priorities. */
+#endif
 PRIVILEGED_DATA static volatile BaseType_t xSchedulerRunning 		= pdFALSE;
 PRIVILEGED_DATA static volatile UBaseType_t uxPendedTicks 			= ( UBaseType_t ) 0U;
 PRIVILEGED_DATA static volatile BaseType_t xYieldPending 			= pdFALSE;
@@ -1528,7 +1595,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 						/* It is known that the task is in its ready list so
 						there is no need to check again and the port level
 						reset macro can be called directly. */
-						portRESET_READY_PRIORITY( uxPriorityUsedOnEntry, uxTopReadyPriority );
+						taskCLEAR_READY_PRIORITY( uxPriorityUsedOnEntry );
 					}
 					else
 					{
@@ -1948,6 +2015,11 @@ void vTaskSuspendAll( void )
 	post in the FreeRTOS support forum before reporting this as a bug! -
 	http://goo.gl/wu4acr */
 	++uxSchedulerSuspended;
+
+	if( uxSchedulerSuspended == ( UBaseType_t ) 1U )
+	{
+		traceSCHEDULER_SUSPEND();
+	}
 }
 /*----------------------------------------------------------*/
 
@@ -1982,6 +2054,18 @@ void vTaskSuspendAll( void )
 			{
 				uxHigherPriorityReadyTasks = pdTRUE;
 			}
+
+			/* With two levels, bit 0 of uxTopReadyPriority covers the whole
+			first group, so its own bitmap says whether anything above the
+			idle priority is ready. */
+			#if ( configMAX_PRIORITIES > taskREADY_GROUP_SIZE )
+			{
+				if( uxReadyPriorityGroups[ 0 ] > uxLeastSignificantBit )
+				{
+					uxHigherPriorityReadyTasks = pdTRUE;
+				}
+			}
+			#endif
 		}
 		#endif
 
@@ -2034,6 +2118,8 @@ BaseType_t xAlreadyYielded = pdFALSE;
 
 		if( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE )
 		{
+			traceSCHEDULER_RESUME();
+
 			if( uxCurrentNumberOfTasks > ( UBaseType_t ) 0U )
 			{
 				/* Move any readied tasks from the pending list into the
@@ -2200,6 +2286,26 @@ TCB_t *pxTCB;
 
 		/* This function is called with the scheduler suspended. */
 
+		#if( configUSE_DELAYED_TASK_HEAP == 1 )
+		if( listLIST_IS_HEAP( pxList ) != pdFALSE )
+		{
+		ListItem_t *pxItem;
+
+			/* A heap ordered delayed list cannot be walked with its index.
+			Task names are always terminated within configMAX_TASK_NAME_LEN
+			characters. */
+			for( pxItem = ( listLIST_IS_EMPTY( pxList ) == pdFALSE ) ? listGET_HEAD_ENTRY( pxList ) : NULL; pxItem != NULL; pxItem = pxListHeapNextItem( pxItem ) )
+			{
+				pxNextTCB = ( TCB_t * ) listGET_LIST_ITEM_OWNER( pxItem );
+				if( strncmp( pxNextTCB->pcTaskName, pcNameToQuery, ( size_t ) configMAX_TASK_NAME_LEN ) == 0 )
+				{
+					pxReturn = pxNextTCB;
+					break;
+				}
+			}
+		}
+		else
+		#endif /* configUSE_DELAYED_TASK_HEAP */
 		if( listCURRENT_LIST_LENGTH( pxList ) > ( UBaseType_t ) 0 )
 		{
 			listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
@@ -2403,6 +2509,42 @@ TCB_t *pxTCB;
 #endif /* INCLUDE_xTaskGetIdleTaskHandle */
 /*----------------------------------------------------------*/
 
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+	uint32_t ulTaskGetRunTimeCounter( TaskHandle_t xTask )
+	{
+	TCB_t *pxTCB;
+	uint32_t ulReturn, ulNow;
+
+		taskENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+			ulReturn = pxTCB->ulRunTimeCounter;
+
+			/* The running task is only charged when it is switched out, so
+			add the time it has run since it was switched in. */
+			if( pxTCB == pxCurrentTCB )
+			{
+				#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
+					portALT_GET_RUN_TIME_COUNTER_VALUE( ulNow );
+				#else
+					ulNow = portGET_RUN_TIME_COUNTER_VALUE();
+				#endif
+				ulReturn += ulNow - ulTaskSwitchedInTime;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return ulReturn;
+	}
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+/*----------------------------------------------------------*/
+
 /* This conditional compilation should use inequality to 0, not equality to 1.
 This is to ensure vTaskStepTick() is available when user defined low power mode
 implementations require configUSE_TICKLESS_IDLE to be set to a value other than
@@ -2781,19 +2923,12 @@ void vTaskSwitchContext( void )
 
 				/* Add the amount of time the task has been running to the
 				accumulated time so far.  The time the task started running was
-				stored in ulTaskSwitchedInTime.  Note that there is no overflow
-				protection here so count values are only valid until the timer
-				overflows.  The guard against negative values is to protect
-				against suspect run time stat counter implementations - which
-				are provided by the application, not the kernel. */
-				if( ulTotalRunTime > ulTaskSwitchedInTime )
-				{
-					pxCurrentTCB->ulRunTimeCounter += ( ulTotalRunTime - ulTaskSwitchedInTime );
-				}
-				else
-				{
-					mtCOVERAGE_TEST_MARKER();
-				}
+				stored in ulTaskSwitchedInTime.  The subtraction is modulo 2^32,
+				so a run time counter that wraps while the task runs is still
+				charged correctly.  The accumulated counts wrap as well, so only
+				differences taken over less than one wrap period are
+				meaningful. */
+				pxCurrentTCB->ulRunTimeCounter += ( ulTotalRunTime - ulTaskSwitchedInTime );
 				ulTaskSwitchedInTime = ulTotalRunTime;
 		}
 		#endif /* configGENERATE_RUN_TIME_STATS */
@@ -3187,6 +3322,8 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 		}
 		#endif /* configUSE_IDLE_HOOK */
 
+		portIDLE_TASK_HOOK();
+
 		/* This conditional compilation should use inequality to 0, not equality
 		to 1.  This is to ensure portSUPPRESS_TICKS_AND_SLEEP() is called when
 		user defined low power mode	implementations require
@@ -3339,8 +3476,8 @@ UBaseType_t uxPriority;
 		vListInitialise( &( pxReadyTasksLists[ uxPriority ] ) );
 	}
 
-	vListInitialise( &xDelayedTaskList1 );
-	vListInitialise( &xDelayedTaskList2 );
+	prvInitialiseDelayedList( &xDelayedTaskList1 );
+	prvInitialiseDelayedList( &xDelayedTaskList2 );
 	vListInitialise( &xPendingReadyList );
 
 	#if ( INCLUDE_vTaskDelete == 1 )
@@ -3502,6 +3639,20 @@ static void prvCheckTasksWaitingTermination( void )
 	volatile TCB_t *pxNextTCB, *pxFirstTCB;
 	UBaseType_t uxTask = 0;
 
+		#if( configUSE_DELAYED_TASK_HEAP == 1 )
+		if( listLIST_IS_HEAP( pxList ) != pdFALSE )
+		{
+		ListItem_t *pxItem;
+
+			/* A heap ordered delayed list cannot be walked with its index. */
+			for( pxItem = ( listLIST_IS_EMPTY( pxList ) == pdFALSE ) ? listGET_HEAD_ENTRY( pxList ) : NULL; pxItem != NULL; pxItem = pxListHeapNextItem( pxItem ) )
+			{
+				vTaskGetInfo( ( TaskHandle_t ) listGET_LIST_ITEM_OWNER( pxItem ), &( pxTaskStatusArray[ uxTask ] ), pdTRUE, eState );
+				uxTask++;
+			}
+		}
+		else
+		#endif /* configUSE_DELAYED_TASK_HEAP */
 		if( listCURRENT_LIST_LENGTH( pxList ) > ( UBaseType_t ) 0 )
 		{
 			listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
@@ -4709,7 +4860,7 @@ const TickType_t xConstTickCount = xTickCount;
 	{
 		/* The current task must be in a ready list, so there is no need to
 		check, and the port reset macro can be called directly. */
-		portRESET_READY_PRIORITY( pxCurrentTCB->uxPriority, uxTopReadyPriority );
+		taskCLEAR_READY_PRIORITY( pxCurrentTCB->uxPriority );
 	}
 	else
 	{
@@ -4739,13 +4890,13 @@ const TickType_t xConstTickCount = xTickCount;
 			{
 				/* Wake time has overflowed.  Place this item in the overflow
 				list. */
-				vListInsert( pxOverflowDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
+				prvInsertInDelayedList( pxOverflowDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
 			}
 			else
 			{
 				/* The wake time has not overflowed, so the current block list
 				is used. */
-				vListInsert( pxDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
+				prvInsertInDelayedList( pxDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
 
 				/* If the task entering the blocked state was placed at the
 				head of the list of blocked tasks then xNextTaskUnblockTime
@@ -4774,12 +4925,12 @@ const TickType_t xConstTickCount = xTickCount;
 		if( xTimeToWake < xConstTickCount )
 		{
 			/* Wake time has overflowed.  Place this item in the overflow list. */
-			vListInsert( pxOverflowDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
+			prvInsertInDelayedList( pxOverflowDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
 		}
 		else
 		{
 			/* The wake time has not overflowed, so the current block list is used. */
-			vListInsert( pxDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
+			prvInsertInDelayedList( pxDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
 
 			/* If the task entering the blocked state was placed at the head of the
 			list of blocked tasks then xNextTaskUnblockTime needs to be updated
@@ -161,13 +161,50 @@ typedef struct tmrTimerQueueMessage
 /*lint -e956 A manual analysis and inspection has been used to determine which
 static variables must be declared volatile. */
 
-/* The list in which active timers are stored.  Timers are referenced in expire
-time order, with the nearest expiry time at the front of the list.  Only the
-timer service task is allowed to access these lists. */
-PRIVILEGED_DATA static List_t xActiveTimerList1;
-PRIVILEGED_DATA static List_t xActiveTimerList2;
-PRIVILEGED_DATA static List_t *pxCurrentTimerList;
-PRIVILEGED_DATA static List_t *pxOverflowTimerList;
+#if( configUSE_TIMER_WHEEL == 0 )
+
+	/* The list in which active timers are stored.  Timers are referenced in
+	expire time order, with the nearest expiry time at the front of the list.
+	Only the timer service task is allowed to access these lists. */
+	PRIVILEGED_DATA static List_t xActiveTimerList1;
+	PRIVILEGED_DATA static List_t xActiveTimerList2;
+	PRIVILEGED_DATA static List_t *pxCurrentTimerList;
+	PRIVILEGED_DATA static List_t *pxOverflowTimerList;
+
+#else
+
+	/* Active timers are held in a hierarchical timing wheel.  Level 0 has one
+	slot per tick, and each slot of level n covers a whole turn of level n - 1.
+	A timer is placed in the lowest level whose span covers its time to expiry,
+	in the slot selected by the matching bits of its expiry time.  When the
+	wheel reaches the start of a higher level slot the timers in it are
+	cascaded down, so starting, stopping and expiring a timer are all O(1).
+	Slots are unordered lists, and a bit per slot records which are occupied
+	so the next event can be found without scanning empty slots.  Only the
+	timer service task is allowed to access the wheel. */
+	#define tmrWHEEL_SLOT_BITS		( 6U )
+	#define tmrWHEEL_SLOTS			( 1U << tmrWHEEL_SLOT_BITS )
+	#define tmrWHEEL_SLOT_MASK		( tmrWHEEL_SLOTS - 1U )
+	#define tmrWHEEL_SPAN_MASK		( ( ( TickType_t ) 1U << ( tmrWHEEL_SLOT_BITS * configTIMER_WHEEL_LEVELS ) ) - 1U )
+
+	#if defined( __GNUC__ )
+		#define tmrCOUNT_TRAILING_ZEROS( ullBits )	( ( UBaseType_t ) __builtin_ctzll( ullBits ) )
+	#else
+		#define tmrCOUNT_TRAILING_ZEROS( ullBits )	prvCountTrailingZeros( ullBits )
+	#endif
+
+	PRIVILEGED_DATA static List_t xTimerWheel[ configTIMER_WHEEL_LEVELS ][ tmrWHEEL_SLOTS ];
+	PRIVILEGED_DATA static uint64_t ullWheelOccupied[ configTIMER_WHEEL_LEVELS ];
+
+	/* Timers that expire beyond the span of the top level.  They are placed
+	again each time the wheel turns over. */
+	PRIVILEGED_DATA static List_t xFarTimerList;
+
+	/* The time up to which the wheel has been processed.  It may lag the tick
+	count, but never beyond the next event in the wheel. */
+	PRIVILEGED_DATA static TickType_t xWheelTime = ( TickType_t ) 0U;
+
+#endif /* configUSE_TIMER_WHEEL */
 
 /* A queue that is used to send commands to the timer service task. */
 PRIVILEGED_DATA static QueueHandle_t xTimerQueue = NULL;
@@ -208,21 +245,73 @@ static void prvProcessReceivedCommands( void ) PRIVILEGED_FUNCTION;
 
 /*
  * Insert the timer into either xActiveTimerList1, or xActiveTimerList2,
- * depending on if the expire time causes a timer counter overflow.
+ * depending on if the expire time causes a timer counter overflow.  With the
+ * timer wheel the timer is placed in the wheel instead.  Returns pdTRUE if
+ * the timer has already expired and must be processed now.
  */
 static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime ) PRIVILEGED_FUNCTION;
 
 /*
- * An active timer has reached its expire time.  Reload the timer if it is an
- * auto reload timer, then call its callback.
+ * Remove the timer from whichever list of active timers it is in.
  */
-static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+static void prvRemoveTimerFromActiveList( Timer_t * const pxTimer ) PRIVILEGED_FUNCTION;
+
+#if( configUSE_TIMER_WHEEL == 0 )
+
+	/*
+	 * An active timer has reached its expire time.  Reload the timer if it is an
+	 * auto reload timer, then call its callback.
+	 */
+	static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * The tick count has overflowed.  Switch the timer lists after ensuring the
+	 * current timer list does not still reference some timers.
+	 */
+	static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
+
+#else
+
+	/*
+	 * Place an active timer in the wheel according to its expiry time.
+	 */
+	static void prvWheelInsert( Timer_t * const pxTimer ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Return pdTRUE if no timers are active.
+	 */
+	static BaseType_t prvWheelIsEmpty( void ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * The number of ticks from xWheelTime to the next time the wheel has work
+	 * to do, either expiring the timers in a level 0 slot or cascading a
+	 * higher level slot.  Must only be called when the wheel is not empty.
+	 */
+	static TickType_t prvWheelTicksToNextEvent( void ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Re-place every timer in the list, which is a slot the wheel has reached
+	 * or the list of far timers.
+	 */
+	static void prvWheelCascade( List_t * const pxList ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Move the wheel forward to xTimeNow, expiring every timer that is due in
+	 * one pass.  Auto reload timers are placed again directly, rather than by
+	 * sending a command to the timer queue.
+	 */
+	static void prvAdvanceWheel( const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+	#if !defined( __GNUC__ )
+
+		/*
+		 * Index of the lowest set bit of a non-zero occupancy mask.
+		 */
+		static UBaseType_t prvCountTrailingZeros( uint64_t ullBits ) PRIVILEGED_FUNCTION;
 
-/*
- * The tick count has overflowed.  Switch the timer lists after ensuring the
- * current timer list does not still reference some timers.
- */
-static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
+	#endif
+
+#endif /* configUSE_TIMER_WHEEL */
 
 /*
  * Obtain the current tick count, setting *pxTimerListsWereSwitched to pdTRUE
@@ -495,6 +584,8 @@ Timer_t *pxTimer = ( Timer_t * ) xTimer;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_WHEEL == 0 )
+
 static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow )
 {
 BaseType_t xResult;
@@ -533,6 +624,8 @@ Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTi
 	/* Call the timer callback. */
 	pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static void prvTimerTask( void *pvParameters )
@@ -571,6 +664,8 @@ BaseType_t xListWasEmpty;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_WHEEL == 0 )
+
 static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime, BaseType_t xListWasEmpty )
 {
 TickType_t xTimeNow;
@@ -721,12 +816,341 @@ BaseType_t xProcessTimerNow = pdFALSE;
 }
 /*-----------------------------------------------------------*/
 
+static void prvRemoveTimerFromActiveList( Timer_t * const pxTimer )
+{
+	( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+}
+
+#else /* configUSE_TIMER_WHEEL */
+
+static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime, BaseType_t xListWasEmpty )
+{
+TickType_t xTimeNow;
+
+	vTaskSuspendAll();
+	{
+		/* Distances are measured from the wheel time, so the tick count
+		overflowing needs no special handling. */
+		xTimeNow = xTaskGetTickCount();
+		if( ( xListWasEmpty == pdFALSE ) && ( ( TickType_t ) ( xNextExpireTime - xWheelTime ) <= ( TickType_t ) ( xTimeNow - xWheelTime ) ) )
+		{
+			( void ) xTaskResumeAll();
+			prvAdvanceWheel( xTimeNow );
+		}
+		else
+		{
+			/* Block until the wheel next has work to do or a command is
+			received, or indefinitely if no timers are active. */
+			vQueueWaitForMessageRestricted( xTimerQueue, ( xNextExpireTime - xTimeNow ), xListWasEmpty );
+
+			if( xTaskResumeAll() == pdFALSE )
+			{
+				portYIELD_WITHIN_API();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty )
+{
+TickType_t xNextExpireTime;
+
+	/* The next event may be a cascade rather than an expiry, in which case
+	the task wakes, moves the timers down a level and looks again. */
+	*pxListWasEmpty = prvWheelIsEmpty();
+	if( *pxListWasEmpty == pdFALSE )
+	{
+		xNextExpireTime = xWheelTime + prvWheelTicksToNextEvent();
+	}
+	else
+	{
+		xNextExpireTime = ( TickType_t ) 0U;
+	}
+
+	return xNextExpireTime;
+}
+/*-----------------------------------------------------------*/
+
+static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched )
+{
+	/* The wheel has no lists to switch when the tick count overflows. */
+	*pxTimerListsWereSwitched = pdFALSE;
+	return xTaskGetTickCount();
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime )
+{
+BaseType_t xProcessTimerNow = pdFALSE;
+
+	listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
+	listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
+
+	/* Has the expiry time elapsed between the command to start/reset a timer
+	was issued, and the time the command was processed?  Both times are
+	measured from the command time so an overflow of the tick count in
+	between does not matter. */
+	if( ( TickType_t ) ( xTimeNow - xCommandTime ) >= ( TickType_t ) ( xNextExpiryTime - xCommandTime ) ) /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+	{
+		xProcessTimerNow = pdTRUE;
+	}
+	else
+	{
+		/* An empty wheel can be moved straight to the current time, which
+		keeps the distance from the wheel time to the expiry time short. */
+		if( prvWheelIsEmpty() != pdFALSE )
+		{
+			xWheelTime = xTimeNow;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		prvWheelInsert( pxTimer );
+	}
+
+	return xProcessTimerNow;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveTimerFromActiveList( Timer_t * const pxTimer )
+{
+List_t * const pxList = ( List_t * ) listLIST_ITEM_CONTAINER( &( pxTimer->xTimerListItem ) );
+UBaseType_t uxIndex;
+
+	/* Clear the slot's occupied bit when its last timer is removed. */
+	if( uxListRemove( &( pxTimer->xTimerListItem ) ) == ( UBaseType_t ) 0 )
+	{
+		if( pxList != &xFarTimerList )
+		{
+			uxIndex = ( UBaseType_t ) ( pxList - &( xTimerWheel[ 0 ][ 0 ] ) );
+			ullWheelOccupied[ uxIndex >> tmrWHEEL_SLOT_BITS ] &= ~( ( uint64_t ) 1U << ( uxIndex & tmrWHEEL_SLOT_MASK ) );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvWheelInsert( Timer_t * const pxTimer )
+{
+const TickType_t xExpiryTime = listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) );
+const TickType_t xTicksToExpiry = xExpiryTime - xWheelTime;
+UBaseType_t uxLevel = 0U, uxSlot;
+List_t *pxList;
+
+	/* Find the lowest level whose span covers the time to expiry.  The slot
+	is selected by the expiry time itself, so the wheel first reaches the
+	slot no later than the expiry time. */
+	while( ( uxLevel < ( UBaseType_t ) configTIMER_WHEEL_LEVELS ) && ( ( xTicksToExpiry >> ( tmrWHEEL_SLOT_BITS * ( uxLevel + 1U ) ) ) != ( TickType_t ) 0U ) )
+	{
+		uxLevel++;
+	}
+
+	if( uxLevel < ( UBaseType_t ) configTIMER_WHEEL_LEVELS )
+	{
+		uxSlot = ( UBaseType_t ) ( xExpiryTime >> ( tmrWHEEL_SLOT_BITS * uxLevel ) ) & tmrWHEEL_SLOT_MASK;
+		pxList = &( xTimerWheel[ uxLevel ][ uxSlot ] );
+		ullWheelOccupied[ uxLevel ] |= ( uint64_t ) 1U << uxSlot;
+	}
+	else
+	{
+		pxList = &xFarTimerList;
+	}
+
+	vListInsertEnd( pxList, &( pxTimer->xTimerListItem ) );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWheelIsEmpty( void )
+{
+UBaseType_t uxLevel;
+BaseType_t xReturn = listLIST_IS_EMPTY( &xFarTimerList );
+
+	for( uxLevel = 0U; ( xReturn != pdFALSE ) && ( uxLevel < ( UBaseType_t ) configTIMER_WHEEL_LEVELS ); uxLevel++ )
+	{
+		if( ullWheelOccupied[ uxLevel ] != ( uint64_t ) 0U )
+		{
+			xReturn = pdFALSE;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static TickType_t prvWheelTicksToNextEvent( void )
+{
+TickType_t xTicks = portMAX_DELAY, xCandidate, xTurns;
+UBaseType_t uxLevel, uxStart, uxShift;
+uint64_t ullRotated;
+
+	/* The far list is looked at each time the wheel turns over. */
+	if( listLIST_IS_EMPTY( &xFarTimerList ) == pdFALSE )
+	{
+		xTicks = ( tmrWHEEL_SPAN_MASK - ( xWheelTime & tmrWHEEL_SPAN_MASK ) ) + 1U;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	for( uxLevel = 0U; uxLevel < ( UBaseType_t ) configTIMER_WHEEL_LEVELS; uxLevel++ )
+	{
+		if( ullWheelOccupied[ uxLevel ] != ( uint64_t ) 0U )
+		{
+			/* Search the level's slots starting with the one after the
+			current slot, wrapping round to end with the current slot
+			itself, which the wheel only reaches again after a full turn. */
+			uxShift = tmrWHEEL_SLOT_BITS * uxLevel;
+			xTurns = xWheelTime >> uxShift;
+			uxStart = ( UBaseType_t ) ( xTurns + 1U ) & tmrWHEEL_SLOT_MASK;
+			ullRotated = ullWheelOccupied[ uxLevel ];
+			if( uxStart != 0U )
+			{
+				ullRotated = ( ullRotated >> uxStart ) | ( ullRotated << ( tmrWHEEL_SLOTS - uxStart ) );
+			}
+
+			/* The slot is reached when the level's bits of the wheel time
+			next equal its index, with every lower level bit clear. */
+			xTurns += ( TickType_t ) tmrCOUNT_TRAILING_ZEROS( ullRotated ) + 1U;
+			xCandidate = ( TickType_t ) ( xTurns << uxShift ) - xWheelTime;
+
+			if( xCandidate < xTicks )
+			{
+				xTicks = xCandidate;
+			}
+		}
+	}
+
+	return xTicks;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWheelCascade( List_t * const pxList )
+{
+UBaseType_t uxCount = listCURRENT_LIST_LENGTH( pxList );
+Timer_t *pxTimer;
+
+	/* A far timer can land in the far list again, so only the timers that
+	were in the list on entry are moved. */
+	while( uxCount > ( UBaseType_t ) 0U )
+	{
+		pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxList );
+		prvRemoveTimerFromActiveList( pxTimer );
+		prvWheelInsert( pxTimer );
+		uxCount--;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvAdvanceWheel( const TickType_t xTimeNow )
+{
+TickType_t xTicksToEvent;
+UBaseType_t uxLevel, uxShift;
+List_t *pxSlot;
+Timer_t *pxTimer;
+
+	while( prvWheelIsEmpty() == pdFALSE )
+	{
+		xTicksToEvent = prvWheelTicksToNextEvent();
+		if( xTicksToEvent > ( TickType_t ) ( xTimeNow - xWheelTime ) )
+		{
+			break;
+		}
+
+		/* Nothing happens between events, so the wheel jumps straight to
+		the next one. */
+		xWheelTime += xTicksToEvent;
+
+		/* Cascade from the top down, so timers that move more than one level
+		in this step are placed before the lower slot is processed. */
+		if( ( xWheelTime & tmrWHEEL_SPAN_MASK ) == ( TickType_t ) 0U )
+		{
+			prvWheelCascade( &xFarTimerList );
+		}
+
+		for( uxLevel = ( UBaseType_t ) configTIMER_WHEEL_LEVELS - 1U; uxLevel > 0U; uxLevel-- )
+		{
+			uxShift = tmrWHEEL_SLOT_BITS * uxLevel;
+			if( ( xWheelTime & ( ( ( TickType_t ) 1U << uxShift ) - 1U ) ) == ( TickType_t ) 0U )
+			{
+				prvWheelCascade( &( xTimerWheel[ uxLevel ][ ( xWheelTime >> uxShift ) & tmrWHEEL_SLOT_MASK ] ) );
+			}
+		}
+
+		/* Every timer in the level 0 slot expires now. */
+		pxSlot = &( xTimerWheel[ 0 ][ xWheelTime & tmrWHEEL_SLOT_MASK ] );
+		while( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )
+		{
+			pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot );
+			prvRemoveTimerFromActiveList( pxTimer );
+			traceTIMER_EXPIRED( pxTimer );
+
+			/* The reload time is at least one tick after the wheel time, so
+			it never lands back in this slot.  If it is already due it is
+			expired again by a later pass of this loop. */
+			if( pxTimer->uxAutoReload == ( UBaseType_t ) pdTRUE )
+			{
+				listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xWheelTime + pxTimer->xTimerPeriodInTicks );
+				prvWheelInsert( pxTimer );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+		}
+	}
+
+	xWheelTime = xTimeNow;
+}
+/*-----------------------------------------------------------*/
+
+#if !defined( __GNUC__ )
+
+	static UBaseType_t prvCountTrailingZeros( uint64_t ullBits )
+	{
+	UBaseType_t uxCount = 0U;
+
+		while( ( ullBits & ( uint64_t ) 1U ) == ( uint64_t ) 0U )
+		{
+			ullBits >>= 1U;
+			uxCount++;
+		}
+
+		return uxCount;
+	}
+
+#endif
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
 static void	prvProcessReceivedCommands( void )
 {
 DaemonTaskMessage_t xMessage;
 Timer_t *pxTimer;
-BaseType_t xTimerListsWereSwitched, xResult;
+BaseType_t xTimerListsWereSwitched;
 TickType_t xTimeNow;
+#if( configUSE_TIMER_WHEEL == 1 )
+	TickType_t xCommandTime;
+#else
+	BaseType_t xResult;
+#endif
 
 	while( xQueueReceive( xTimerQueue, &xMessage, tmrNO_DELAY ) != pdFAIL ) /*lint !e603 xMessage does not have to be initialised as it is passed out, not in, and it is not used unless xQueueReceive() returns pdTRUE. */
 	{
@@ -763,7 +1187,7 @@ TickType_t xTimeNow;
 			if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE )
 			{
 				/* The timer is in a list, remove it. */
-				( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+				prvRemoveTimerFromActiveList( pxTimer );
 			}
 			else
 			{
@@ -788,28 +1212,52 @@ TickType_t xTimeNow;
 			    case tmrCOMMAND_RESET_FROM_ISR :
 				case tmrCOMMAND_START_DONT_TRACE :
 					/* Start or restart a timer. */
-					if( prvInsertTimerInActiveList( pxTimer,  xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, xMessage.u.xTimerParameters.xMessageValue ) != pdFALSE )
+					#if( configUSE_TIMER_WHEEL == 1 )
 					{
-						/* The timer expired before it was added to the active
-						timer list.  Process it now. */
-						pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
-						traceTIMER_EXPIRED( pxTimer );
+						/* Catch up with every period that passed before the
+						command was processed here rather than by sending
+						commands back to the timer queue, which may be full
+						when many timers are in use. */
+						xCommandTime = xMessage.u.xTimerParameters.xMessageValue;
+						while( prvInsertTimerInActiveList( pxTimer, xCommandTime + pxTimer->xTimerPeriodInTicks, xTimeNow, xCommandTime ) != pdFALSE )
+						{
+							pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+							traceTIMER_EXPIRED( pxTimer );
 
-						if( pxTimer->uxAutoReload == ( UBaseType_t ) pdTRUE )
+							if( pxTimer->uxAutoReload == ( UBaseType_t ) pdFALSE )
+							{
+								break;
+							}
+
+							xCommandTime += pxTimer->xTimerPeriodInTicks;
+						}
+					}
+					#else
+					{
+						if( prvInsertTimerInActiveList( pxTimer,  xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, xMessage.u.xTimerParameters.xMessageValue ) != pdFALSE )
 						{
-							xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, NULL, tmrNO_DELAY );
-							configASSERT( xResult );
-							( void ) xResult;
+							/* The timer expired before it was added to the active
+							timer list.  Process it now. */
+							pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+							traceTIMER_EXPIRED( pxTimer );
+
+							if( pxTimer->uxAutoReload == ( UBaseType_t ) pdTRUE )
+							{
+								xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, NULL, tmrNO_DELAY );
+								configASSERT( xResult );
+								( void ) xResult;
+							}
+							else
+							{
+								mtCOVERAGE_TEST_MARKER();
+							}
 						}
 						else
 						{
 							mtCOVERAGE_TEST_MARKER();
 						}
 					}
-					else
-					{
-						mtCOVERAGE_TEST_MARKER();
-					}
+					#endif /* configUSE_TIMER_WHEEL */
 					break;
 
 				case tmrCOMMAND_STOP :
@@ -868,6 +1316,8 @@ TickType_t xTimeNow;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_WHEEL == 0 )
+
 static void prvSwitchTimerLists( void )
 {
 TickType_t xNextExpireTime, xReloadTime;
@@ -925,6 +1375,8 @@ BaseType_t xResult;
 	pxCurrentTimerList = pxOverflowTimerList;
 	pxOverflowTimerList = pxTemp;
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static void prvCheckForValidListAndQueue( void )
@@ -936,10 +1388,28 @@ static void prvCheckForValidListAndQueue( void )
 	{
 		if( xTimerQueue == NULL )
 		{
-			vListInitialise( &xActiveTimerList1 );
-			vListInitialise( &xActiveTimerList2 );
-			pxCurrentTimerList = &xActiveTimerList1;
-			pxOverflowTimerList = &xActiveTimerList2;
+			#if( configUSE_TIMER_WHEEL == 0 )
+			{
+				vListInitialise( &xActiveTimerList1 );
+				vListInitialise( &xActiveTimerList2 );
+				pxCurrentTimerList = &xActiveTimerList1;
+				pxOverflowTimerList = &xActiveTimerList2;
+			}
+			#else
+			{
+			UBaseType_t uxLevel, uxSlot;
+
+				for( uxLevel = 0U; uxLevel < ( UBaseType_t ) configTIMER_WHEEL_LEVELS; uxLevel++ )
+				{
+					for( uxSlot = 0U; uxSlot < ( UBaseType_t ) tmrWHEEL_SLOTS; uxSlot++ )
+					{
+						vListInitialise( &( xTimerWheel[ uxLevel ][ uxSlot ] ) );
+					}
+					ullWheelOccupied[ uxLevel ] = ( uint64_t ) 0U;
+				}
+				vListInitialise( &xFarTimerList );
+			}
+			#endif /* configUSE_TIMER_WHEEL */
 
 			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
 			{
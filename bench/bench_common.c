@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench_common.h"
+
+// Exits rather than return a handle the benchmark would have to check
+void bench_create_task(TaskFunction_t code, const char *name, uint16_t stack_depth, void *parameters,
+		UBaseType_t priority, TaskHandle_t *handle)
+{
+	if (xTaskCreate(code, name, stack_depth, parameters, priority, handle) != pdPASS)
+	{
+		fprintf(stderr, "Task create failed\n");
+		exit(1);
+	}
+}
+
+// Creates the task that runs the cases and starts the kernel.  Only returns,
+// with the exit status for main(), if the kernel could not start.
+int bench_start(TaskFunction_t bench_task, UBaseType_t priority, TaskHandle_t *handle)
+{
+	bench_create_task(bench_task, "Bench", BENCH_STACK_SIZE, NULL, priority, handle);
+	vTaskStartScheduler();
+
+	fprintf(stderr, "Insufficient heap\n");
+	return 1;
+}
+
+/*-----------------------------------------------------------*/
+/* Hooks required by src/FreeRTOSConfig.h */
+
+void vApplicationMallocFailedHook( void )
+{
+	fprintf(stderr, "Out of heap\n");
+	exit(1);
+}
+
+void vApplicationStackOverflowHook( TaskHandle_t pxTask, signed char *pcTaskName )
+{
+	( void ) pxTask;
+	fprintf(stderr, "Stack overflow in %s\n", (char *) pcTaskName);
+	exit(1);
+}
+
+void vApplicationIdleHook( void )
+{
+}
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+
+void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize )
+{
+static StaticTask_t xIdleTaskTCB;
+static StackType_t uxIdleTaskStack[ configMINIMAL_STACK_SIZE ];
+
+	*ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+	*ppxIdleTaskStackBuffer = uxIdleTaskStack;
+	*pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory( StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize )
+{
+static StaticTask_t xTimerTaskTCB;
+static StackType_t uxTimerTaskStack[ configTIMER_TASK_STACK_DEPTH ];
+
+	*ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+	*ppxTimerTaskStackBuffer = uxTimerTaskStack;
+	*pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
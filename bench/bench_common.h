@@ -0,0 +1,23 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+
+/*
+ * Fixture shared by the host benchmarks that run on the real kernel.
+ *
+ * Provides the hooks src/FreeRTOSConfig.h asks for, which end the run with a
+ * message on stderr, and in static builds the idle and timer task memory.
+ * Link bench/bench_common.c into every such benchmark.
+ */
+
+// Stack of the task that runs the cases
+#define BENCH_STACK_SIZE (configMINIMAL_STACK_SIZE * 4)
+
+// Function declarations
+void bench_create_task(TaskFunction_t code, const char *name, uint16_t stack_depth, void *parameters,
+		UBaseType_t priority, TaskHandle_t *handle);
+int bench_start(TaskFunction_t bench_task, UBaseType_t priority, TaskHandle_t *handle);
+
+#endif /* BENCH_COMMON_H */
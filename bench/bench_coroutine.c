@@ -0,0 +1,237 @@
+/*
+ * Host benchmark for the co-routine job backend against a task per job.
+ *
+ * Runs on the real kernel with the virtual-time port, built with co-routines
+ * and their deadline ordered ready lists.  Each job does no work of its own, so
+ * what is measured is the cost of getting a job to run and putting it away:
+ *
+ *   task         xTaskCreate() above the bench task, which the job preempts
+ *                at once, then vTaskDelete() when it suspends, as the
+ *                dynamic build's Scheduler does for each worker.
+ *   task_static  The same with xTaskCreateStatic(), as the static build does.
+ *   coroutine    vCoRoutineSetDeadline() on a pooled co-routine and one
+ *                vCoRoutineSchedule(), which resumes it ahead of the others.
+ *
+ * Each case has 0, 8 or 64 other jobs waiting with later deadlines: ready
+ * tasks below the bench task, or ready co-routines the new job is sorted
+ * ahead of.  Build with:
+ *
+ *   gcc -O2 -DHOST_BUILD -DconfigUSE_CO_ROUTINES=1 -DconfigUSE_KERNEL_TRACE=0 \
+ *       -Isrc -IFreeRTOS_Source/include \
+ *       -IFreeRTOS_Source/portable/GCC/Posix_VirtualTime \
+ *       bench/bench_coroutine.c bench/bench_common.c FreeRTOS_Source/tasks.c \
+ *       FreeRTOS_Source/queue.c FreeRTOS_Source/list.c FreeRTOS_Source/timers.c \
+ *       FreeRTOS_Source/croutine.c \
+ *       FreeRTOS_Source/portable/MemMang/heap_3.c \
+ *       FreeRTOS_Source/portable/GCC/Posix_VirtualTime/port.c -o bench_coroutine
+ *   ./bench_coroutine > coroutine.jsonl
+ *
+ * heap_3 takes the worker tasks from malloc, as the static build only has a
+ * token heap.  Each result is one JSON object per line, first the memory each
+ * job holds, then the dispatch cost:
+ *
+ *   {"bench":"coroutine","case":"memory","impl":"task",
+ *    "control_block":168,"stack":1040,"bytes_per_job":1208}
+ *   {"bench":"coroutine","case":"dispatch","impl":"coroutine","waiting":8,
+ *    "jobs":20000,"ns_per_job":25.2}
+ *
+ * Sizes are the host's.  On the Cortex-M4 a worker holds a 92 byte TCB and a
+ * 520 byte stack, and a co-routine a 60 byte control block.  A host context
+ * switch is a thread hand-over, so the gap in dispatch cost is wider here than
+ * on the target.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+#include "../FreeRTOS_Source/include/croutine.h"
+#include "bench_common.h"
+
+#if configUSE_CO_ROUTINE_DEADLINES != 1
+#error "Build with -DconfigUSE_CO_ROUTINES=1"
+#endif
+
+#define JOBS 20000
+#define MAX_WAITING 64
+
+#define WAITING_PRIORITY 1
+#define BENCH_PRIORITY 2
+#define JOB_PRIORITY 3
+
+#define JOB_STACK_SIZE configMINIMAL_STACK_SIZE
+
+enum job_impl
+{
+	IMPL_TASK,
+	IMPL_TASK_STATIC,
+	IMPL_COROUTINE
+};
+
+static const char * const impl_names[] = { "task", "task_static", "coroutine" };
+static const uint32_t waiting_counts[] = { 0, 8, 64 };
+
+// The job being dispatched is co-routine 0, the waiting ones follow it
+static CRCB_t coroutines[1 + MAX_WAITING];
+static StaticTask_t job_tcb;
+static StackType_t job_stack[JOB_STACK_SIZE];
+static TaskHandle_t waiting_handles[MAX_WAITING];
+static volatile uint32_t jobs_run;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static void Job_Task( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	jobs_run++;
+	// Wait for the bench task to delete this task
+	vTaskSuspend(NULL);
+}
+
+static void Waiting_Task( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	// Only runs once the bench task sleeps, after the case
+	vTaskSuspend(NULL);
+}
+
+static void Job_CoRoutine(CoRoutineHandle_t xHandle, UBaseType_t uxIndex)
+{
+	( void ) uxIndex;
+
+	crSTART(xHandle);
+
+	for (;;)
+	{
+		jobs_run++;
+		// Back to the pool, behind every job still waiting
+		vCoRoutineSetDeadline(xHandle, portMAX_DELAY);
+		crDELAY(xHandle, 0);
+	}
+
+	crEND();
+}
+
+static void dispatch_task(enum job_impl impl)
+{
+	TaskHandle_t handle;
+
+	if (impl == IMPL_TASK_STATIC)
+	{
+		handle = xTaskCreateStatic(Job_Task, "Job", JOB_STACK_SIZE, NULL, JOB_PRIORITY, job_stack, &job_tcb);
+	}
+	else
+	{
+		bench_create_task(Job_Task, "Job", JOB_STACK_SIZE, NULL, JOB_PRIORITY, &handle);
+	}
+	vTaskDelete(handle);
+}
+
+static void dispatch_coroutine(TickType_t deadline)
+{
+	vCoRoutineSetDeadline(&coroutines[0], deadline);
+	vCoRoutineSchedule();
+}
+
+static void add_waiting(enum job_impl impl, uint32_t waiting)
+{
+	for (uint32_t i = 0; i < waiting; i++)
+	{
+		if (impl == IMPL_COROUTINE)
+		{
+			vCoRoutineSetDeadline(&coroutines[1 + i], portMAX_DELAY - 1 - i);
+		}
+		else
+		{
+			bench_create_task(Waiting_Task, "Waiting", configMINIMAL_STACK_SIZE, NULL, WAITING_PRIORITY,
+					&waiting_handles[i]);
+		}
+	}
+}
+
+static void remove_waiting(enum job_impl impl, uint32_t waiting)
+{
+	for (uint32_t i = 0; i < waiting; i++)
+	{
+		if (impl == IMPL_COROUTINE)
+		{
+			vCoRoutineSetDeadline(&coroutines[1 + i], portMAX_DELAY);
+		}
+		else
+		{
+			vTaskDelete(waiting_handles[i]);
+		}
+	}
+}
+
+static void run_case(enum job_impl impl, uint32_t waiting)
+{
+	uint64_t start;
+
+	add_waiting(impl, waiting);
+	jobs_run = 0;
+	start = now_ns();
+	for (uint32_t i = 0; i < JOBS; i++)
+	{
+		if (impl == IMPL_COROUTINE)
+		{
+			dispatch_coroutine(i);
+		}
+		else
+		{
+			dispatch_task(impl);
+		}
+	}
+
+	printf("{\"bench\":\"coroutine\",\"case\":\"dispatch\",\"impl\":\"%s\",\"waiting\":%u,"
+			"\"jobs\":%u,\"ns_per_job\":%.1f}\n",
+			impl_names[impl], waiting, jobs_run, (double) (now_ns() - start) / JOBS);
+	fflush(stdout);
+	remove_waiting(impl, waiting);
+}
+
+static void print_memory(enum job_impl impl, size_t control_block, size_t stack)
+{
+	printf("{\"bench\":\"coroutine\",\"case\":\"memory\",\"impl\":\"%s\","
+			"\"control_block\":%u,\"stack\":%u,\"bytes_per_job\":%u}\n",
+			impl_names[impl], (uint32_t) control_block, (uint32_t) stack, (uint32_t) (control_block + stack));
+}
+
+static void Bench_Task( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	print_memory(IMPL_TASK, sizeof(StaticTask_t), JOB_STACK_SIZE * sizeof(StackType_t));
+	print_memory(IMPL_COROUTINE, sizeof(CRCB_t), 0);
+
+	for (uint32_t impl = IMPL_TASK; impl <= IMPL_COROUTINE; impl++)
+	{
+		for (size_t i = 0; i < sizeof(waiting_counts) / sizeof(waiting_counts[0]); i++)
+		{
+			run_case((enum job_impl) impl, waiting_counts[i]);
+		}
+	}
+
+	exit(0);
+}
+
+int main(void)
+{
+	// Co-routines cannot be deleted, so the pool is made once
+	for (UBaseType_t i = 0; i < 1 + MAX_WAITING; i++)
+	{
+		xCoRoutineCreateStatic(Job_CoRoutine, 0, i, &coroutines[i]);
+	}
+
+	return bench_start(Bench_Task, BENCH_PRIORITY, NULL);
+}
@@ -0,0 +1,135 @@
+/*
+ * Host benchmark for the delayed task lists with many blocked tasks.
+ *
+ * Runs on the real kernel with the virtual-time port.  Each case creates 10 to
+ * 2000 sleeper tasks that repeatedly call vTaskDelayUntil() with periods of 1
+ * to 1000 ticks, so every wakeup costs one removal in the tick handler and one
+ * insert into a delayed list, on top of the two context switches both builds
+ * pay alike.  Build once with the pairing heap and once with the sorted lists:
+ *
+ *   gcc -O2 -DHOST_BUILD -DconfigUSE_DELAYED_TASK_HEAP=$CONFIG \
+ *       -DconfigSUPPORT_STATIC_ALLOCATION=0 -DconfigUSE_KERNEL_TRACE=0 -Isrc \
+ *       -IFreeRTOS_Source/include -IFreeRTOS_Source/portable/GCC/Posix_VirtualTime \
+ *       bench/bench_delay.c bench/bench_common.c FreeRTOS_Source/tasks.c \
+ *       FreeRTOS_Source/queue.c FreeRTOS_Source/list.c FreeRTOS_Source/timers.c \
+ *       FreeRTOS_Source/portable/MemMang/heap_3.c \
+ *       FreeRTOS_Source/portable/GCC/Posix_VirtualTime/port.c -o bench_delay
+ *   ./bench_delay > delay.jsonl
+ *
+ * CONFIG is 1 for the heap and 0 for the lists.  Kernel tracing is left out so
+ * its hooks do not add to the cost being measured.  heap_3 is used because the
+ * sleepers' stacks do not fit the application's heap.  Each result is one JSON
+ * object per line:
+ *
+ *   {"bench":"delay","impl":"heap","tasks":1000,"ticks":20000,
+ *    "wakeups":84113,"ns_per_wakeup":412.5}
+ *
+ * Every sleeper draws its periods from its own generator, so both builds run
+ * the same wakeups and the wakeup counts must match.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+#include "bench_common.h"
+
+#define MAX_SLEEPERS 2000
+#define MAX_PERIOD 1000
+#define RUN_TICKS 20000
+
+#define SLEEPER_PRIORITY 1
+#define BENCH_PRIORITY 2
+
+#if configUSE_DELAYED_TASK_HEAP == 1
+static const char * const impl_name = "heap";
+#else
+static const char * const impl_name = "list";
+#endif
+
+static const uint32_t sleeper_counts[] = { 10, 100, 1000, 2000 };
+
+static uint32_t seeds[MAX_SLEEPERS];
+static volatile BaseType_t measuring;
+static volatile BaseType_t stopping;
+static uint32_t wakeups;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static TickType_t next_period(uint32_t *seed)
+{
+	*seed = *seed * 1664525U + 1013904223U;
+	return 1 + (TickType_t) ((*seed >> 8) % MAX_PERIOD);
+}
+
+static void Sleeper_Task( void *pvParameters )
+{
+	uint32_t *seed = pvParameters;
+	TickType_t wake_time = xTaskGetTickCount();
+
+	while (stopping == pdFALSE)
+	{
+		vTaskDelayUntil(&wake_time, next_period(seed));
+		if (measuring != pdFALSE)
+		{
+			wakeups++;
+		}
+	}
+
+	vTaskDelete(NULL);
+}
+
+static void run_case(uint32_t sleepers)
+{
+	uint64_t start;
+
+	stopping = pdFALSE;
+	wakeups = 0;
+	for (uint32_t i = 0; i < sleepers; i++)
+	{
+		seeds[i] = i + 1;
+		bench_create_task(Sleeper_Task, "Sleeper", configMINIMAL_STACK_SIZE, &seeds[i], SLEEPER_PRIORITY, NULL);
+	}
+
+	// Let every sleeper block once before timing starts
+	vTaskDelay(MAX_PERIOD);
+	measuring = pdTRUE;
+	start = now_ns();
+	vTaskDelay(RUN_TICKS);
+	measuring = pdFALSE;
+
+	printf("{\"bench\":\"delay\",\"impl\":\"%s\",\"tasks\":%u,\"ticks\":%d,"
+			"\"wakeups\":%u,\"ns_per_wakeup\":%.1f}\n",
+			impl_name, sleepers, RUN_TICKS, wakeups, (double) (now_ns() - start) / wakeups);
+	fflush(stdout);
+
+	// Every sleeper wakes within MAX_PERIOD ticks and deletes itself, then
+	// the idle task frees it
+	stopping = pdTRUE;
+	vTaskDelay(MAX_PERIOD + 1);
+}
+
+static void Bench_Task( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	for (size_t i = 0; i < sizeof(sleeper_counts) / sizeof(sleeper_counts[0]); i++)
+	{
+		run_case(sleeper_counts[i]);
+	}
+
+	exit(0);
+}
+
+int main(void)
+{
+	return bench_start(Bench_Task, BENCH_PRIORITY, NULL);
+}
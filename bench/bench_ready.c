@@ -0,0 +1,131 @@
+/*
+ * Host benchmark for selecting the highest priority ready task.
+ *
+ * Runs on the real kernel with the virtual-time port, built with 1024
+ * priorities.  Each case has a low task at priority 1 wake a high task at the
+ * top of 8 to 1024 priority levels, which blocks again at once, so every round
+ * trip is two context switches.  The second one has to find the low task far
+ * below the high one: the generic selection scans every empty ready list in
+ * between, the two level bitmap takes two count leading zeros.  Build once
+ * with each:
+ *
+ *   gcc -O2 -DHOST_BUILD -DconfigUSE_PORT_OPTIMISED_TASK_SELECTION=$CONFIG \
+ *       -DconfigMAX_PRIORITIES=1024 -DconfigSUPPORT_STATIC_ALLOCATION=0 \
+ *       -DconfigUSE_KERNEL_TRACE=0 -Isrc -IFreeRTOS_Source/include \
+ *       -IFreeRTOS_Source/portable/GCC/Posix_VirtualTime \
+ *       bench/bench_ready.c bench/bench_common.c FreeRTOS_Source/tasks.c \
+ *       FreeRTOS_Source/queue.c FreeRTOS_Source/list.c FreeRTOS_Source/timers.c \
+ *       FreeRTOS_Source/portable/MemMang/heap_3.c \
+ *       FreeRTOS_Source/portable/GCC/Posix_VirtualTime/port.c -o bench_ready
+ *   ./bench_ready > ready.jsonl
+ *
+ * CONFIG is 1 for the bitmap and 0 for the scan.  Kernel tracing is left out
+ * so its hooks do not add to the cost being measured.  Each result is one JSON
+ * object per line:
+ *
+ *   {"bench":"ready","impl":"bitmap","levels":256,"ticks":2000,
+ *    "round_trips":48213,"ns_per_switch":180.4}
+ *
+ * Time only advances with kernel events, so both builds run the same number
+ * of round trips in each case.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+#include "bench_common.h"
+
+#define RUN_TICKS 2000
+
+#define LOW_PRIORITY 1
+#define BENCH_PRIORITY (configMAX_PRIORITIES - 1)
+
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+static const char * const impl_name = "bitmap";
+#else
+static const char * const impl_name = "scan";
+#endif
+
+static const uint32_t level_counts[] = { 8, 32, 256, 1024 };
+
+static TaskHandle_t high_handle;
+static volatile BaseType_t measuring;
+static uint32_t round_trips;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static void High_Task( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	for (;;)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+}
+
+static void Low_Task( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	for (;;)
+	{
+		// Runs the high task and comes back once it blocks
+		xTaskNotifyGive(high_handle);
+		if (measuring != pdFALSE)
+		{
+			round_trips++;
+		}
+	}
+}
+
+static void run_case(uint32_t levels)
+{
+	TaskHandle_t low_handle;
+	uint64_t start;
+
+	round_trips = 0;
+	bench_create_task(High_Task, "High", configMINIMAL_STACK_SIZE, NULL, levels - 1, &high_handle);
+	bench_create_task(Low_Task, "Low", configMINIMAL_STACK_SIZE, NULL, LOW_PRIORITY, &low_handle);
+
+	// The Bench task outranks both, so they only run while it sleeps
+	vTaskDelay(1);
+	measuring = pdTRUE;
+	start = now_ns();
+	vTaskDelay(RUN_TICKS);
+	measuring = pdFALSE;
+
+	printf("{\"bench\":\"ready\",\"impl\":\"%s\",\"levels\":%u,\"ticks\":%d,"
+			"\"round_trips\":%u,\"ns_per_switch\":%.1f}\n",
+			impl_name, levels, RUN_TICKS, round_trips, (double) (now_ns() - start) / (2.0 * round_trips));
+	fflush(stdout);
+
+	vTaskDelete(low_handle);
+	vTaskDelete(high_handle);
+}
+
+static void Bench_Task( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	for (size_t i = 0; i < sizeof(level_counts) / sizeof(level_counts[0]); i++)
+	{
+		run_case(level_counts[i]);
+	}
+
+	exit(0);
+}
+
+int main(void)
+{
+	return bench_start(Bench_Task, BENCH_PRIORITY, NULL);
+}
@@ -0,0 +1,351 @@
+/*
+ * Host benchmark for the scheduler data path in src/dd_scheduler.c.
+ *
+ * Drives the release, complete, monitor snapshot (full list dump) and monitor
+ * delta (records added since the previous report) paths with 10 to 10,000
+ * concurrent jobs at several utilizations.  No kernel is linked: the few
+ * kernel calls the scheduler makes are stubbed below, the tick count is a
+ * virtual clock and every heap allocation is counted.
+ *
+ * Build and run from the repository root:
+ *
+ *   gcc -O2 -DconfigSUPPORT_STATIC_ALLOCATION=0 -DconfigUSE_KERNEL_TRACE=0 \
+ *       -Isrc -IFreeRTOS_Source/include -Ibench/port \
+ *       -Wl,--wrap=malloc -Wl,--wrap=free \
+ *       bench/bench_scheduler.c src/dd_scheduler.c src/telemetry.c \
+ *       -o bench_scheduler
+ *   ./bench_scheduler [max_jobs] > scheduler.jsonl
+ *
+ * The dynamic build is used so job records come from the heap, as the static
+ * job store only holds DD_JOB_STORE_SIZE of them, and without kernel tracing,
+ * which needs the kernel.
+ *
+ * Each result is one JSON object per line:
+ *
+ *   {"bench":"scheduler","op":"release","jobs":1000,"utilization":0.90,
+ *    "history":0,"iterations":41,"ns_per_op":51234.0,"allocs_per_op":12.5,
+ *    "peak_bytes":40960}
+ *
+ * "history" is the number of completed and overdue records held at the end of
+ * the run and "peak_bytes" is the peak live heap of the configuration.
+ * The output of the monitor snapshot is discarded so that only the cost of
+ * walking and formatting the lists is measured.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dd_scheduler.h"
+#include "output.h"
+
+#define EXECUTION_TICKS 10
+#define TIME_BUDGET_NS 50000000ULL
+#define MAX_ITERATIONS 1000
+
+static const uint32_t job_counts[] = { 10, 100, 1000, 10000 };
+static const double utilizations[] = { 0.5, 0.9, 1.2 };
+
+/*-----------------------------------------------------------*/
+/* Allocation accounting */
+
+void *__real_malloc(size_t size);
+void __real_free(void *ptr);
+
+typedef union alloc_header
+{
+	size_t size;
+	max_align_t align;
+} alloc_header;
+
+static uint64_t alloc_count;
+static size_t live_bytes;
+static size_t peak_bytes;
+
+void *__wrap_malloc(size_t size)
+{
+	alloc_header *header = __real_malloc(sizeof(alloc_header) + size);
+
+	if (header == NULL)
+	{
+		return NULL;
+	}
+
+	header->size = size;
+	alloc_count++;
+	live_bytes += size;
+	if (live_bytes > peak_bytes)
+	{
+		peak_bytes = live_bytes;
+	}
+	return header + 1;
+}
+
+void __wrap_free(void *ptr)
+{
+	if (ptr != NULL)
+	{
+		alloc_header *header = (alloc_header *) ptr - 1;
+		live_bytes -= header->size;
+		__real_free(header);
+	}
+}
+
+/*-----------------------------------------------------------*/
+/* Kernel stubs */
+
+static TickType_t virtual_tick;
+
+TickType_t xTaskGetTickCount( void )
+{
+	return virtual_tick;
+}
+
+void vTaskPrioritySet( TaskHandle_t xTask, UBaseType_t uxNewPriority )
+{
+	( void ) xTask;
+	( void ) uxNewPriority;
+}
+
+void vTaskDelete( TaskHandle_t xTaskToDelete )
+{
+	( void ) xTaskToDelete;
+}
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+	return malloc(xWantedSize);
+}
+
+void vPortFree( void *pv )
+{
+	free(pv);
+}
+
+// Telemetry frames go straight out, with no other task to share the port with
+void output_write(const void *data, uint32_t length)
+{
+	( void ) write(1, data, length);
+}
+
+/*-----------------------------------------------------------*/
+/* Workload */
+
+static size_t base_bytes;
+static uint32_t rng_state;
+static uint32_t next_task_id;
+
+static uint32_t next_random(void)
+{
+	rng_state = rng_state * 1664525u + 1013904223u;
+	return rng_state >> 8;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static uint32_t list_length(const dd_task_list *task_list)
+{
+	uint32_t length = 0;
+
+	while (task_list != NULL)
+	{
+		length++;
+		task_list = task_list->next_task;
+	}
+	return length;
+}
+
+static void free_list(dd_task_list *task_list)
+{
+	while (task_list != NULL)
+	{
+		dd_task_list *next = task_list->next_task;
+		vPortFree(task_list);
+		task_list = next;
+	}
+}
+
+// Relative deadline that gives the requested utilization for the job count
+static TickType_t relative_deadline(uint32_t jobs, double utilization)
+{
+	return (TickType_t) ((double) EXECUTION_TICKS * jobs / utilization) + EXECUTION_TICKS;
+}
+
+static void release_job(dd_task_lists *lists, TickType_t deadline)
+{
+	dd_task task;
+
+	memset(&task, 0, sizeof(task));
+	task.type = PERIODIC;
+	task.task_id = next_task_id++;
+	task.release_time = virtual_tick;
+	task.absolute_deadline = virtual_tick + deadline;
+	task.execution_time = EXECUTION_TICKS;
+	release_dd_task(lists, &task);
+}
+
+static void refill(dd_task_lists *lists, uint32_t jobs, TickType_t deadline)
+{
+	uint32_t length = list_length(lists->active);
+
+	// Latest possible deadline, so the new node is already in sorted position
+	while (length++ < jobs)
+	{
+		release_job(lists, deadline);
+	}
+}
+
+static void reset_history(dd_task_lists *lists)
+{
+	free_list(lists->completed);
+	free_list(lists->overdue);
+	lists->completed = NULL;
+	lists->overdue = NULL;
+}
+
+static void report(FILE *out, const char *op, const dd_task_lists *lists, uint32_t jobs,
+		double utilization, uint32_t iterations, uint64_t elapsed_ns, uint64_t allocs)
+{
+	uint32_t history = list_length(lists->completed) + list_length(lists->overdue);
+
+	fprintf(out, "{\"bench\":\"scheduler\",\"op\":\"%s\",\"jobs\":%u,\"utilization\":%.2f,"
+			"\"history\":%u,\"iterations\":%u,\"ns_per_op\":%.1f,\"allocs_per_op\":%.2f,"
+			"\"peak_bytes\":%zu}\n",
+			op, jobs, utilization, history, iterations, (double) elapsed_ns / iterations,
+			(double) allocs / iterations, peak_bytes - base_bytes);
+	fflush(out);
+}
+
+static void run_configuration(FILE *out, uint32_t jobs, double utilization)
+{
+	dd_task_lists lists;
+	TickType_t deadline = relative_deadline(jobs, utilization);
+	uint64_t elapsed_ns, allocs, start;
+	uint32_t iterations;
+
+	memset(&lists, 0, sizeof(lists));
+	rng_state = jobs;
+	virtual_tick = 0;
+	base_bytes = live_bytes;
+	peak_bytes = live_bytes;
+	refill(&lists, jobs, deadline);
+
+	// Release: a job with a deadline anywhere in the window joins a full set
+	elapsed_ns = 0;
+	allocs = 0;
+	for (iterations = 0; iterations < MAX_ITERATIONS && elapsed_ns < TIME_BUDGET_NS; iterations++)
+	{
+		TickType_t window = deadline / 2 + next_random() % (deadline / 2 + 1);
+		uint64_t allocs_before = alloc_count;
+
+		start = now_ns();
+		release_job(&lists, window);
+		elapsed_ns += now_ns() - start;
+		allocs += alloc_count - allocs_before;
+
+		virtual_tick += EXECUTION_TICKS;
+		complete_dd_task(&lists, virtual_tick);
+		refill(&lists, jobs, deadline);
+	}
+	report(out, "release", &lists, jobs, utilization, iterations, elapsed_ns, allocs);
+
+	// Complete: the head job finishes and moves to the completed history
+	reset_history(&lists);
+	elapsed_ns = 0;
+	allocs = 0;
+	for (iterations = 0; iterations < MAX_ITERATIONS && elapsed_ns < TIME_BUDGET_NS; iterations++)
+	{
+		uint64_t allocs_before = alloc_count;
+
+		virtual_tick += EXECUTION_TICKS;
+		start = now_ns();
+		complete_dd_task(&lists, virtual_tick);
+		elapsed_ns += now_ns() - start;
+		allocs += alloc_count - allocs_before;
+
+		refill(&lists, jobs, deadline);
+	}
+	report(out, "complete", &lists, jobs, utilization, iterations, elapsed_ns, allocs);
+
+	// Monitor snapshot: walk and format all three lists, one period of history
+	reset_history(&lists);
+	for (uint32_t i = 0; i < jobs; i++)
+	{
+		virtual_tick += EXECUTION_TICKS;
+		complete_dd_task(&lists, virtual_tick);
+		refill(&lists, jobs, deadline);
+	}
+	elapsed_ns = 0;
+	allocs = 0;
+	for (iterations = 0; iterations < MAX_ITERATIONS && elapsed_ns < TIME_BUDGET_NS; iterations++)
+	{
+		uint64_t allocs_before = alloc_count;
+
+		start = now_ns();
+		output_task_lists(lists.active, lists.completed, lists.overdue);
+		elapsed_ns += now_ns() - start;
+		allocs += alloc_count - allocs_before;
+	}
+	report(out, "monitor_snapshot", &lists, jobs, utilization, iterations, elapsed_ns, allocs);
+
+	// Monitor delta: one job finishes per period on top of the same history
+	dd_monitor_cursor cursor;
+	memset(&cursor, 0, sizeof(cursor));
+	output_task_deltas(&cursor, lists.active, lists.completed, lists.overdue);
+	elapsed_ns = 0;
+	allocs = 0;
+	for (iterations = 0; iterations < MAX_ITERATIONS && elapsed_ns < TIME_BUDGET_NS; iterations++)
+	{
+		uint64_t allocs_before;
+
+		virtual_tick += EXECUTION_TICKS;
+		complete_dd_task(&lists, virtual_tick);
+		refill(&lists, jobs, deadline);
+
+		allocs_before = alloc_count;
+		start = now_ns();
+		output_task_deltas(&cursor, lists.active, lists.completed, lists.overdue);
+		elapsed_ns += now_ns() - start;
+		allocs += alloc_count - allocs_before;
+	}
+	report(out, "monitor_delta", &lists, jobs, utilization, iterations, elapsed_ns, allocs);
+
+	free_list(lists.active);
+	reset_history(&lists);
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t max_jobs = argc > 1 ? (uint32_t) strtoul(argv[1], NULL, 10) : 10000;
+	FILE *out = fdopen(dup(STDOUT_FILENO), "w");
+
+	// Monitor output is not part of the result stream
+	if (out == NULL || freopen("/dev/null", "w", stdout) == NULL)
+	{
+		fprintf(stderr, "Unable to redirect monitor output\n");
+		return 1;
+	}
+
+	for (size_t i = 0; i < sizeof(job_counts) / sizeof(job_counts[0]); i++)
+	{
+		if (job_counts[i] > max_jobs)
+		{
+			break;
+		}
+		for (size_t j = 0; j < sizeof(utilizations) / sizeof(utilizations[0]); j++)
+		{
+			run_configuration(out, job_counts[i], utilizations[j]);
+		}
+	}
+
+	fclose(out);
+	return 0;
+}
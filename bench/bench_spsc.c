@@ -0,0 +1,219 @@
+/*
+ * Host microbenchmark for src/spsc_ring.c against FreeRTOS queues.
+ *
+ * Runs on the real kernel with the virtual-time port, so every xQueueSend and
+ * xQueueReceive takes its full path: critical sections, event list checks and
+ * yields.  Three cases are measured for 4 and 16 byte items:
+ *
+ *   "pair"     one task sends then receives a single item, nothing ever blocks
+ *   "burst"    one task fills 32 items then drains them
+ *   "handoff"  a producer task passes items to a higher priority consumer that
+ *              blocks whenever it is empty, so each item costs a wakeup and two
+ *              context switches (spsc_ring_wait() against a blocking receive)
+ *
+ * Build and run from the repository root:
+ *
+ *   gcc -O2 -DHOST_BUILD -DconfigSUPPORT_STATIC_ALLOCATION=0 -DconfigUSE_KERNEL_TRACE=0 \
+ *       -Isrc -IFreeRTOS_Source/include \
+ *       -IFreeRTOS_Source/portable/GCC/Posix_VirtualTime \
+ *       bench/bench_spsc.c bench/bench_common.c src/spsc_ring.c \
+ *       FreeRTOS_Source/tasks.c FreeRTOS_Source/queue.c FreeRTOS_Source/list.c \
+ *       FreeRTOS_Source/timers.c \
+ *       FreeRTOS_Source/portable/MemMang/heap_4.c \
+ *       FreeRTOS_Source/portable/GCC/Posix_VirtualTime/port.c -o bench_spsc
+ *   ./bench_spsc > spsc.jsonl
+ *
+ * Each result is one JSON object per line:
+ *
+ *   {"bench":"spsc","impl":"ring","case":"pair","item_bytes":4,
+ *    "iterations":1000000,"ns_per_item":15.9}
+ *
+ * On the host the ring's ordered accesses are plain loads and stores, and the
+ * port's critical sections cost a little more than BASEPRI writes do on the
+ * Cortex-M4, so the ratio rather than the absolute numbers carries over.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/queue.h"
+#include "../FreeRTOS_Source/include/task.h"
+#include "bench_common.h"
+#include "spsc_ring.h"
+
+#define RING_CAPACITY 32
+#define MAX_ITEM_BYTES 16
+#define PAIR_ITERATIONS 1000000
+#define BURST_ROUNDS 20000
+#define HANDOFF_ITEMS 200000
+
+#define BENCH_PRIORITY 1
+#define CONSUMER_PRIORITY 2
+
+enum bench_impl
+{
+	IMPL_RING,
+	IMPL_QUEUE
+};
+
+static const char * const impl_names[] = { "ring", "queue" };
+static const size_t item_sizes[] = { 4, 16 };
+
+static uint8_t ring_storage[RING_CAPACITY * MAX_ITEM_BYTES];
+static spsc_ring ring;
+static QueueHandle_t queue;
+
+// Handoff state shared with the consumer task
+static enum bench_impl handoff_impl;
+static volatile uint32_t handoff_received;
+static TaskHandle_t bench_task;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static void report(enum bench_impl impl, const char *name, size_t item_bytes, uint32_t items, uint64_t elapsed_ns)
+{
+	printf("{\"bench\":\"spsc\",\"impl\":\"%s\",\"case\":\"%s\",\"item_bytes\":%zu,"
+			"\"iterations\":%u,\"ns_per_item\":%.1f}\n",
+			impl_names[impl], name, item_bytes, items, (double) elapsed_ns / items);
+	fflush(stdout);
+}
+
+static void send_item(enum bench_impl impl, const uint8_t *item)
+{
+	if (impl == IMPL_RING)
+	{
+		spsc_ring_push(&ring, item);
+	}
+	else
+	{
+		xQueueSend(queue, item, 0);
+	}
+}
+
+static BaseType_t receive_item(enum bench_impl impl, uint8_t *item)
+{
+	if (impl == IMPL_RING)
+	{
+		return spsc_ring_pop(&ring, item);
+	}
+	return xQueueReceive(queue, item, 0);
+}
+
+static void run_pair(enum bench_impl impl, size_t item_bytes)
+{
+	uint8_t item[MAX_ITEM_BYTES] = { 0 };
+	uint64_t start = now_ns();
+
+	for (uint32_t i = 0; i < PAIR_ITERATIONS; i++)
+	{
+		item[0] = (uint8_t) i;
+		send_item(impl, item);
+		receive_item(impl, item);
+	}
+	report(impl, "pair", item_bytes, PAIR_ITERATIONS, now_ns() - start);
+}
+
+static void run_burst(enum bench_impl impl, size_t item_bytes)
+{
+	uint8_t item[MAX_ITEM_BYTES] = { 0 };
+	uint64_t start = now_ns();
+
+	for (uint32_t round = 0; round < BURST_ROUNDS; round++)
+	{
+		for (uint32_t i = 0; i < RING_CAPACITY; i++)
+		{
+			send_item(impl, item);
+		}
+		while (receive_item(impl, item) == pdTRUE)
+		{
+		}
+	}
+	report(impl, "burst", item_bytes, BURST_ROUNDS * RING_CAPACITY, now_ns() - start);
+}
+
+static void Consumer_Task( void *pvParameters )
+{
+	uint8_t item[MAX_ITEM_BYTES];
+
+	( void ) pvParameters;
+
+	while (handoff_received < HANDOFF_ITEMS)
+	{
+		if (handoff_impl == IMPL_RING)
+		{
+			spsc_ring_wait(&ring, portMAX_DELAY);
+			while (spsc_ring_pop(&ring, item) == pdTRUE)
+			{
+				handoff_received++;
+			}
+		}
+		else if (xQueueReceive(queue, item, portMAX_DELAY) == pdTRUE)
+		{
+			handoff_received++;
+		}
+	}
+
+	xTaskNotifyGive(bench_task);
+	vTaskDelete(NULL);
+}
+
+static void run_handoff(enum bench_impl impl, size_t item_bytes)
+{
+	uint8_t item[MAX_ITEM_BYTES] = { 0 };
+	TaskHandle_t consumer;
+	uint64_t start;
+
+	handoff_impl = impl;
+	handoff_received = 0;
+
+	// The ring needs the consumer's handle before the consumer first runs
+	vTaskSuspendAll();
+	bench_create_task(Consumer_Task, "Consumer", configMINIMAL_STACK_SIZE, NULL, CONSUMER_PRIORITY, &consumer);
+	spsc_ring_init(&ring, ring_storage, RING_CAPACITY, item_bytes, consumer);
+	xTaskResumeAll();
+
+	// The consumer runs first and blocks on the empty ring or queue
+	start = now_ns();
+	for (uint32_t i = 0; i < HANDOFF_ITEMS; i++)
+	{
+		send_item(impl, item);
+	}
+	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	report(impl, "handoff", item_bytes, HANDOFF_ITEMS, now_ns() - start);
+}
+
+static void Bench_Task( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	for (size_t i = 0; i < sizeof(item_sizes) / sizeof(item_sizes[0]); i++)
+	{
+		size_t item_bytes = item_sizes[i];
+
+		queue = xQueueCreate(RING_CAPACITY, item_bytes);
+		for (enum bench_impl impl = IMPL_RING; impl <= IMPL_QUEUE; impl++)
+		{
+			spsc_ring_init(&ring, ring_storage, RING_CAPACITY, item_bytes, NULL);
+			run_pair(impl, item_bytes);
+			run_burst(impl, item_bytes);
+			run_handoff(impl, item_bytes);
+		}
+		vQueueDelete(queue);
+	}
+
+	exit(0);
+}
+
+int main(void)
+{
+	return bench_start(Bench_Task, BENCH_PRIORITY, &bench_task);
+}
@@ -0,0 +1,185 @@
+/*
+ * Host benchmark for the software timer service with 1000 concurrent timers.
+ *
+ * Runs on the real kernel with the virtual-time port, so each case includes
+ * the command queue, the timer task's wakeups and the callbacks.  Build once
+ * with the timing wheel and once with the sorted timer lists:
+ *
+ *   "restart"  1000 one-shot timers with long periods are kept running while
+ *              random ones are reset.  Commands are sent in batches of 32 by a
+ *              task above the timer task, which drains a batch at a time.
+ *   "expire"   1000 auto-reload timers with periods of 100 to 1099 ticks run
+ *              for 50000 ticks while the benchmark task sleeps.
+ *
+ * Build and run from the repository root, with CONFIG set to 1 for the wheel
+ * and 0 for the lists:
+ *
+ *   gcc -O2 -DHOST_BUILD -DconfigUSE_TIMER_WHEEL=$CONFIG \
+ *       -DconfigSUPPORT_STATIC_ALLOCATION=0 -DconfigUSE_KERNEL_TRACE=0 -Isrc \
+ *       -IFreeRTOS_Source/include -IFreeRTOS_Source/portable/GCC/Posix_VirtualTime \
+ *       bench/bench_timers.c bench/bench_common.c FreeRTOS_Source/tasks.c \
+ *       FreeRTOS_Source/queue.c FreeRTOS_Source/list.c FreeRTOS_Source/timers.c \
+ *       FreeRTOS_Source/portable/MemMang/heap_3.c \
+ *       FreeRTOS_Source/portable/GCC/Posix_VirtualTime/port.c -o bench_timers
+ *   ./bench_timers > timers.jsonl
+ *
+ * heap_3 is used because 1000 timers do not fit the application's heap, and
+ * kernel tracing is left out so its hooks do not add to the cost being
+ * measured.  Each
+ * result is one JSON object per line:
+ *
+ *   {"bench":"timers","impl":"wheel","case":"expire","timers":1000,
+ *    "operations":82514,"ns_per_op":101.3,"max_late_ticks":0}
+ *
+ * max_late_ticks is how far the latest callback ran after its expiry time and
+ * should always be 0.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+#include "../FreeRTOS_Source/include/timers.h"
+#include "bench_common.h"
+
+#define TIMER_COUNT 1000
+#define RESTART_OPERATIONS 200000
+#define RESTART_BATCH 32
+#define RESTART_MIN_PERIOD 10000
+#define EXPIRE_MIN_PERIOD 100
+#define EXPIRE_PERIOD_RANGE 1000
+#define EXPIRE_TICKS 50000
+
+#define BENCH_PRIORITY 1
+#define BATCH_PRIORITY (configTIMER_TASK_PRIORITY + 1)
+
+#if configUSE_TIMER_WHEEL == 1
+static const char * const impl_name = "wheel";
+#else
+static const char * const impl_name = "list";
+#endif
+
+static TimerHandle_t timers[TIMER_COUNT];
+
+// Updated by the callbacks, which run in the timer task
+static uint32_t callbacks;
+static TickType_t max_late_ticks;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static void report(const char *name, uint32_t operations, uint64_t elapsed_ns)
+{
+	printf("{\"bench\":\"timers\",\"impl\":\"%s\",\"case\":\"%s\",\"timers\":%d,"
+			"\"operations\":%u,\"ns_per_op\":%.1f,\"max_late_ticks\":%u}\n",
+			impl_name, name, TIMER_COUNT, operations, (double) elapsed_ns / operations,
+			(unsigned) max_late_ticks);
+	fflush(stdout);
+}
+
+// An auto-reload timer is already given its next expiry when the callback runs
+static void Timer_Callback( TimerHandle_t xTimer )
+{
+	TickType_t expiry = xTimerGetExpiryTime(xTimer);
+	TickType_t late;
+
+	if (xTimerGetPeriod(xTimer) < RESTART_MIN_PERIOD)
+	{
+		expiry -= xTimerGetPeriod(xTimer);
+	}
+	late = xTaskGetTickCount() - expiry;
+	if (late > max_late_ticks)
+	{
+		max_late_ticks = late;
+	}
+	callbacks++;
+}
+
+static void create_timers(TickType_t min_period, TickType_t period_range, UBaseType_t auto_reload)
+{
+	for (uint32_t i = 0; i < TIMER_COUNT; i++)
+	{
+		timers[i] = xTimerCreate("Bench", min_period + (TickType_t) (rand() % period_range),
+				auto_reload, NULL, Timer_Callback);
+		if (timers[i] == NULL)
+		{
+			fprintf(stderr, "Timer create failed\n");
+			exit(1);
+		}
+		xTimerStart(timers[i], portMAX_DELAY);
+	}
+}
+
+static void delete_timers(void)
+{
+	for (uint32_t i = 0; i < TIMER_COUNT; i++)
+	{
+		xTimerDelete(timers[i], portMAX_DELAY);
+	}
+
+	// Let the timer task process the deletes before the next case
+	vTaskDelay(1);
+}
+
+static void run_restart(void)
+{
+	uint64_t start;
+
+	create_timers(RESTART_MIN_PERIOD, RESTART_MIN_PERIOD, pdFALSE);
+	vTaskPrioritySet(NULL, BATCH_PRIORITY);
+	callbacks = 0;
+	max_late_ticks = 0;
+
+	start = now_ns();
+	for (uint32_t i = 0; i < RESTART_OPERATIONS; i += RESTART_BATCH)
+	{
+		for (uint32_t j = 0; j < RESTART_BATCH; j++)
+		{
+			xTimerReset(timers[rand() % TIMER_COUNT], 0);
+		}
+		vTaskDelay(1);
+	}
+	report("restart", RESTART_OPERATIONS, now_ns() - start);
+
+	vTaskPrioritySet(NULL, BENCH_PRIORITY);
+	delete_timers();
+}
+
+static void run_expire(void)
+{
+	uint64_t start;
+
+	create_timers(EXPIRE_MIN_PERIOD, EXPIRE_PERIOD_RANGE, pdTRUE);
+	vTaskDelay(1);
+	callbacks = 0;
+	max_late_ticks = 0;
+
+	start = now_ns();
+	vTaskDelay(EXPIRE_TICKS);
+	report("expire", callbacks, now_ns() - start);
+
+	delete_timers();
+}
+
+static void Bench_Task( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	srand(1);
+	run_restart();
+	run_expire();
+
+	exit(0);
+}
+
+int main(void)
+{
+	return bench_start(Bench_Task, BENCH_PRIORITY, NULL);
+}
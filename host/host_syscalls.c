@@ -0,0 +1,43 @@
+/*
+ * System calls for running the firmware as a Linux process on the POSIX port
+ * in FreeRTOS_Source/portable/GCC/Posix.
+ *
+ * On the target, src/tiny_printf.c formats straight into _write() and
+ * src/syscalls.c sends the bytes to the ITM.  The host build links the same
+ * tiny_printf.c and sends the bytes to the process's file descriptors, so no
+ * task ever holds a stdio lock: the port can stop a task at any instruction
+ * outside a critical section, and a task stopped inside stdio would block
+ * every other task that prints.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
+int _write(int file, char *ptr, int len)
+{
+	int written = 0;
+
+	while (written < len)
+	{
+		ssize_t result = write(file, ptr + written, (size_t) (len - written));
+
+		if (result < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return -1;
+		}
+		written += (int) result;
+	}
+	return written;
+}
+
+// tiny_printf does not buffer, so there is never anything to flush
+int fflush(FILE *stream)
+{
+	(void) stream;
+	return 0;
+}
@@ -90,9 +90,26 @@ extern uint32_t SystemCoreClock;
 #define configUSE_TICK_HOOK				0
 #define configCPU_CLOCK_HZ				( SystemCoreClock )
 #define configTICK_RATE_HZ				( ( TickType_t ) 1000 )
-#define configMAX_PRIORITIES			( 5 )
+/* Above 32, port optimised task selection switches to a two level ready bitmap
+in tasks.c.  Left overridable so bench/bench_ready.c can build with 1024. */
+#ifndef configMAX_PRIORITIES
+	#define configMAX_PRIORITIES		( 5 )
+#endif
 #define configMINIMAL_STACK_SIZE		( ( unsigned short ) 130 )
-#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 100 * 1024 ) )
+/* Place every long-lived object in compile-time sized arenas, so the linker
+map shows the whole RAM budget and nothing comes from the heap once the
+scheduler runs.  Set to 0 to take them from heap_4 instead.  Dynamic
+allocation stays available for the benchmarks, but the static build leaves
+it only a token heap, so a stray allocation reaches the malloc failed hook. */
+#ifndef configSUPPORT_STATIC_ALLOCATION
+	#define configSUPPORT_STATIC_ALLOCATION	1
+#endif
+#define configSUPPORT_DYNAMIC_ALLOCATION	1
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 1 * 1024 ) )
+#else
+	#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 100 * 1024 ) )
+#endif
 #define configMAX_TASK_NAME_LEN			( 10 )
 #define configUSE_TRACE_FACILITY		0
 #define configUSE_16_BIT_TICKS			0
@@ -104,19 +121,66 @@ extern uint32_t SystemCoreClock;
 #define configUSE_MALLOC_FAILED_HOOK	1
 #define configUSE_APPLICATION_TASK_TAG	0
 #define configUSE_COUNTING_SEMAPHORES	1
-#define configGENERATE_RUN_TIME_STATS	0
+#define configUSE_REFERENCE_QUEUES		1
+#define configUSE_QUEUE_SETS			1
+#define configUSE_ORDERED_QUEUES		1
+/* Keep the delayed task lists as pairing heaps.  Left overridable so
+bench/bench_delay.c can build both. */
+#ifndef configUSE_DELAYED_TASK_HEAP
+	#define configUSE_DELAYED_TASK_HEAP	1
+#endif
 #define INCLUDE_eTaskGetState 1
 
-/* Co-routine definitions. */
-#define configUSE_CO_ROUTINES 		0
+/* Run time stats feed the Monitor's CPU report (src/cpu_stats.c).  The target
+counts core clock cycles with the DWT cycle counter, host builds count
+nanoseconds of the monotonic clock.  Both are 32 bits wide and wrap, after about
+25 s at 168 MHz and 4 s on the host, which is far longer than a Monitor
+period. */
+#define configGENERATE_RUN_TIME_STATS	1
+#ifdef HOST_BUILD
+	#include <time.h>
+	static inline uint32_t ulHostRunTimeCounter( void )
+	{
+	struct timespec xNow;
+
+		clock_gettime( CLOCK_MONOTONIC, &xNow );
+		return ( uint32_t ) ( ( uint64_t ) xNow.tv_sec * 1000000000ULL + ( uint64_t ) xNow.tv_nsec );
+	}
+	#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+	#define portGET_RUN_TIME_COUNTER_VALUE()	ulHostRunTimeCounter()
+#else
+	extern void cpu_stats_timer_init( void );
+	#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	cpu_stats_timer_init()
+	/* DWT->CYCCNT, spelled out so the kernel does not need the CMSIS headers. */
+	#define portGET_RUN_TIME_COUNTER_VALUE()	( *( volatile uint32_t * ) 0xE0001004UL )
+#endif
+
+/* Co-routine definitions.  Co-routines only run jobs for the co-routine job
+backend (src/dd_coroutine.h), which DD_JOB_BACKEND selects with the value 2, and
+are resumed in order of their jobs' deadlines.  Left overridable so
+bench/bench_coroutine.c can build them without the backend. */
+#ifndef configUSE_CO_ROUTINES
+	#if defined( DD_JOB_BACKEND ) && ( DD_JOB_BACKEND == 2 )
+		#define configUSE_CO_ROUTINES	1
+	#else
+		#define configUSE_CO_ROUTINES	0
+	#endif
+#endif
+#define configUSE_CO_ROUTINE_DEADLINES	configUSE_CO_ROUTINES
 #define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
 
 /* Software timer definitions. */
 #define configUSE_TIMERS				1
 #define configTIMER_TASK_PRIORITY		( 3 )
-#define configTIMER_QUEUE_LENGTH		5
+#define configTIMER_QUEUE_LENGTH		32
 #define configTIMER_TASK_STACK_DEPTH	( configMINIMAL_STACK_SIZE * 2 )
 
+/* Hold active timers in a hierarchical timing wheel rather than sorted lists.
+Left overridable so bench/bench_timers.c can build both. */
+#ifndef configUSE_TIMER_WHEEL
+	#define configUSE_TIMER_WHEEL		1
+#endif
+
 /* Set the following definitions to 1 to include the API function, or zero
 to exclude the API function. */
 #define INCLUDE_vTaskPrioritySet		1
@@ -126,6 +190,9 @@ to exclude the API function. */
 #define INCLUDE_vTaskSuspend			1
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
+#define INCLUDE_xTaskGetIdleTaskHandle	1
+#define INCLUDE_xTaskGetCurrentTaskHandle	1
+#define INCLUDE_uxTaskGetStackHighWaterMark	1
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
@@ -162,5 +229,37 @@ standard names. */
 #define xPortPendSVHandler PendSV_Handler
 #define xPortSysTickHandler SysTick_Handler
 
+/* Record kernel events into the trace ring in src/trace.h, which also defines
+the trace hook macros.  Left overridable so the benchmarks can measure the
+kernel without it. */
+#ifndef configUSE_KERNEL_TRACE
+	#define configUSE_KERNEL_TRACE		1
+#endif
+#include "trace.h"
+
+/* Attribute the time around each deadline miss, in src/miss_report.h.  Its
+hooks also live in the application, so it is left out along with the trace
+unless set on its own. */
+#ifndef configUSE_MISS_REPORT
+	#define configUSE_MISS_REPORT		configUSE_KERNEL_TRACE
+#endif
+#include "miss_report.h"
+
+/* Track each task's stack high-water mark and suggest stack sizes, in
+src/stack_stats.h.  Like the miss report it hooks the kernel, so it follows the
+trace unless set on its own. */
+#ifndef configUSE_STACK_STATS
+	#define configUSE_STACK_STATS		configUSE_KERNEL_TRACE
+#endif
+#include "stack_stats.h"
+
+/* Time critical sections, interrupt masking and scheduler suspension, in
+src/critical_stats.h.  It adds to every critical section, so it is only built
+on request. */
+#ifndef configUSE_CRITICAL_STATS
+	#define configUSE_CRITICAL_STATS	0
+#endif
+#include "critical_stats.h"
+
 #endif /* FREERTOS_CONFIG_H */
 
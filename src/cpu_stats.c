@@ -0,0 +1,128 @@
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#ifndef HOST_BUILD
+#include "stm32f4xx.h"
+#endif
+/* Kernel includes. */
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+#include "../FreeRTOS_Source/include/timers.h"
+
+#include "cpu_stats.h"
+#include "dd_scheduler.h"
+#include "telemetry.h"
+
+static TaskHandle_t tracked_tasks[CPU_STATS_JOBS];
+static uint32_t previous_run_time[CPU_STATS_JOBS];
+static uint32_t previous_total;
+// Written by the Scheduler, read by the Monitor
+static volatile uint32_t jobs_charged;
+static uint32_t previous_jobs_charged;
+
+#ifndef HOST_BUILD
+// Called by the kernel as the scheduler starts
+void cpu_stats_timer_init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+#endif
+
+// Handles may be registered before the scheduler starts
+void cpu_stats_track(enum cpu_stats_task task, TaskHandle_t handle)
+{
+	configASSERT(task < CPU_STATS_JOBS);
+	tracked_tasks[task] = handle;
+}
+
+// Adds the kernel's own tasks and starts the first window, from a running task
+void cpu_stats_start(void)
+{
+	cpu_stats_sample sample;
+
+	cpu_stats_track(CPU_STATS_TIMER, xTimerGetTimerDaemonTaskHandle());
+	cpu_stats_track(CPU_STATS_IDLE, xTaskGetIdleTaskHandle());
+	cpu_stats_take_sample(&sample);
+}
+
+// Called by the Scheduler task with run time it spent in jobs
+void cpu_stats_charge_jobs(uint32_t run_time)
+{
+	jobs_charged += run_time;
+}
+
+void cpu_stats_take_sample(cpu_stats_sample *sample)
+{
+	uint32_t tracked = 0;
+	uint32_t total = portGET_RUN_TIME_COUNTER_VALUE();
+	uint32_t charged = jobs_charged;
+	uint32_t moved = charged - previous_jobs_charged;
+
+	// Differences are modulo 2^32, so the counters may wrap between samples
+	sample->window = total - previous_total;
+	previous_total = total;
+
+	for (uint32_t i = 0; i < CPU_STATS_JOBS; i++)
+	{
+		uint32_t run_time = 0;
+
+		if (tracked_tasks[i] != NULL)
+		{
+			run_time = ulTaskGetRunTimeCounter(tracked_tasks[i]);
+		}
+		sample->run_time[i] = run_time - previous_run_time[i];
+		previous_run_time[i] = run_time;
+		tracked += sample->run_time[i];
+	}
+
+	// Time the Scheduler spent in jobs moves from its share to theirs
+	previous_jobs_charged = charged;
+	moved = min(moved, sample->run_time[CPU_STATS_SCHEDULER]);
+	sample->run_time[CPU_STATS_SCHEDULER] -= moved;
+	tracked -= moved;
+
+	// The tracked counters are read after the total, so they can be slightly ahead
+	sample->run_time[CPU_STATS_JOBS] = tracked < sample->window ? sample->window - tracked : 0;
+}
+
+uint16_t cpu_stats_permille(const cpu_stats_sample *sample, enum cpu_stats_task task)
+{
+	if (sample->window == 0)
+	{
+		return 0;
+	}
+	return (uint16_t) min((uint64_t) sample->run_time[task] * 1000 / sample->window, 1000);
+}
+
+#if MONITOR_TELEMETRY == 1
+
+void output_cpu_stats(const cpu_stats_sample *sample)
+{
+	telemetry_begin(xTaskGetTickCount());
+	for (uint32_t i = 0; i < CPU_STATS_TASK_COUNT; i++)
+	{
+		telemetry_add_cpu((enum cpu_stats_task) i, sample->run_time[i], cpu_stats_permille(sample, i));
+	}
+	telemetry_flush();
+}
+
+#else
+
+void output_cpu_stats(const cpu_stats_sample *sample)
+{
+	static const char * const task_names[] = { "Scheduler", "Generator", "Monitor", "Log", "Timer", "Idle", "Jobs" };
+
+	printf("CPU");
+	for (uint32_t i = 0; i < CPU_STATS_TASK_COUNT; i++)
+	{
+		uint16_t permille = cpu_stats_permille(sample, i);
+
+		printf("%s %s: %u.%u%%", i == 0 ? "" : ",", task_names[i], permille / 10, permille % 10);
+	}
+	printf("\n\n");
+	fflush(stdout);
+}
+
+#endif /* MONITOR_TELEMETRY */
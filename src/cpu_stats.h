@@ -0,0 +1,54 @@
+#ifndef CPU_STATS_H
+#define CPU_STATS_H
+
+#include <stdint.h>
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+
+/*
+ * Per-task CPU utilization for the Monitor.
+ *
+ * The kernel charges each task's run time counter on every context switch,
+ * using the run time stats clock set up in FreeRTOSConfig.h.  Every Monitor
+ * period cpu_stats_sample() reads the counters of the long-lived tasks with
+ * ulTaskGetRunTimeCounter() and reports how much each one grew against the
+ * clock.  Worker tasks come and go with their jobs, so whatever the tracked
+ * tasks did not use is charged to the jobs, deleted workers included.
+ *
+ * Jobs that run on the Scheduler's own stack report the run time they took
+ * from it with cpu_stats_charge_jobs(), and the next sample moves that time
+ * from the Scheduler's share to the jobs.
+ *
+ * The Scheduler's share is the number to watch for scheduling overhead
+ * regressions: it covers releases, completions, worker handling and status
+ * reports, and nothing the jobs themselves do.
+ */
+
+enum cpu_stats_task
+{
+	CPU_STATS_SCHEDULER,
+	CPU_STATS_GENERATOR,
+	CPU_STATS_MONITOR,
+	CPU_STATS_LOG,
+	CPU_STATS_TIMER,
+	CPU_STATS_IDLE,
+	CPU_STATS_JOBS,
+	CPU_STATS_TASK_COUNT
+};
+
+typedef struct cpu_stats_sample
+{
+	uint32_t window;	/* Run time clock counts since the previous sample */
+	uint32_t run_time[CPU_STATS_TASK_COUNT];
+} cpu_stats_sample;
+
+// Function declarations
+void cpu_stats_timer_init(void);
+void cpu_stats_track(enum cpu_stats_task task, TaskHandle_t handle);
+void cpu_stats_start(void);
+void cpu_stats_charge_jobs(uint32_t run_time);
+void cpu_stats_take_sample(cpu_stats_sample *sample);
+uint16_t cpu_stats_permille(const cpu_stats_sample *sample, enum cpu_stats_task task);
+void output_cpu_stats(const cpu_stats_sample *sample);
+
+#endif /* CPU_STATS_H */
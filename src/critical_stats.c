@@ -0,0 +1,100 @@
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+/* Kernel includes. */
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+
+#include "critical_stats.h"
+#include "dd_scheduler.h"
+#include "telemetry.h"
+
+#if configUSE_CRITICAL_STATS == 1
+
+// The interval of each kind in progress.  Kinds cannot interleave with
+// themselves: a task critical section masks the interrupts that would begin
+// another, and only one task runs while the scheduler is suspended.
+typedef struct critical_stats_open
+{
+	uint32_t began_at;
+	void *site;
+} critical_stats_open;
+
+// Written with interrupts masked, read by the Monitor without locking
+static critical_stats_entry entries[CRITICAL_STATS_KIND_COUNT];
+static critical_stats_open open_intervals[CRITICAL_STATS_KIND_COUNT];
+
+static void output_critical_entry(enum critical_stats_kind kind, const critical_stats_entry *entry);
+
+void critical_stats_begin(enum critical_stats_kind kind, void *site)
+{
+	open_intervals[kind].site = site;
+	open_intervals[kind].began_at = portGET_RUN_TIME_COUNTER_VALUE();
+}
+
+void critical_stats_end(enum critical_stats_kind kind)
+{
+	critical_stats_entry *entry = &entries[kind];
+	uint32_t duration = portGET_RUN_TIME_COUNTER_VALUE() - open_intervals[kind].began_at;
+	// Compiles to a single CLZ on the target
+	uint32_t bucket = duration == 0 ? 0 : 31 - (uint32_t) __builtin_clz(duration);
+
+	entry->count++;
+	entry->total += duration;
+	entry->histogram[min(bucket, CRITICAL_STATS_BUCKETS - 1)]++;
+	if (duration > entry->max)
+	{
+		entry->max = duration;
+		entry->max_site = (uintptr_t) open_intervals[kind].site;
+	}
+}
+
+// Totals since the scheduler started, one line per kind
+void output_critical_stats(void)
+{
+#if MONITOR_TELEMETRY == 1
+	telemetry_begin(xTaskGetTickCount());
+#endif
+	for (uint32_t i = 0; i < CRITICAL_STATS_KIND_COUNT; i++)
+	{
+		output_critical_entry((enum critical_stats_kind) i, &entries[i]);
+	}
+#if MONITOR_TELEMETRY == 1
+	telemetry_flush();
+#else
+	printf("\n");
+	fflush(stdout);
+#endif
+}
+
+#if MONITOR_TELEMETRY == 1
+
+static void output_critical_entry(enum critical_stats_kind kind, const critical_stats_entry *entry)
+{
+	telemetry_add_critical(kind, entry);
+}
+
+#else
+
+static void output_critical_entry(enum critical_stats_kind kind, const critical_stats_entry *entry)
+{
+	static const char * const kind_names[] = { "Task", "ISR", "Suspended" };
+	uint32_t count = entry->count;
+	const char *separator = " ";
+
+	printf("CRITICAL %s: %u, Mean: %u, Max: %u at 0x%x, Histogram:", kind_names[kind], count,
+			count == 0 ? 0 : (uint32_t) (entry->total / count), entry->max, (uint32_t) entry->max_site);
+	for (uint32_t i = 0; i < CRITICAL_STATS_BUCKETS; i++)
+	{
+		if (entry->histogram[i] != 0)
+		{
+			printf("%s<2^%u: %u", separator, i + 1, entry->histogram[i]);
+			separator = ", ";
+		}
+	}
+	printf("\n");
+}
+
+#endif /* MONITOR_TELEMETRY */
+
+#endif /* configUSE_CRITICAL_STATS */
@@ -0,0 +1,73 @@
+#ifndef CRITICAL_STATS_H
+#define CRITICAL_STATS_H
+
+#include <stdint.h>
+
+/*
+ * How long interrupts stay masked and the scheduler stays suspended.
+ *
+ * Kernel hooks time three kinds of interval with the run time clock: task
+ * critical sections, from the outermost portENTER_CRITICAL() to its exit;
+ * interrupts masked by an interrupt, in the tick handler or a FromISR API
+ * function; and the scheduler suspended, from the outermost vTaskSuspendAll()
+ * to its xTaskResumeAll().  Each kind keeps a count, the mean, the longest
+ * interval with the address of the code that began it, and a histogram with
+ * one bucket per power of two.  The longest masked interval bounds how late
+ * any interrupt, the tick included, can be served, and so how late a release
+ * can be seen.
+ *
+ * The site of a task critical section or a suspension is the caller of
+ * vPortEnterCritical() or vTaskSuspendAll(), usually a kernel API function.
+ * `addr2line -f -e <elf>` turns it into a name.  On the target the context
+ * switch's own BASEPRI raise in PendSV is not covered.  The host ports have no
+ * interrupts to mask, so their tick shows up as a task critical section.
+ *
+ * Every outermost critical section pays a run time clock read and a histogram
+ * update, so this is off unless configUSE_CRITICAL_STATS is set to 1.  This
+ * header is included by FreeRTOSConfig.h, so it only depends on the
+ * definitions made there.
+ */
+
+#define CRITICAL_STATS_BUCKETS 24		/* The last one takes everything longer */
+
+enum critical_stats_kind
+{
+	CRITICAL_STATS_TASK,				/* Task critical sections */
+	CRITICAL_STATS_ISR,					/* Masked by an interrupt */
+	CRITICAL_STATS_SUSPENDED,			/* Scheduler suspended */
+	CRITICAL_STATS_KIND_COUNT
+};
+
+// Times are in run time clock counts
+typedef struct critical_stats_entry
+{
+	uint32_t count;
+	uint32_t max;
+	uintptr_t max_site;			/* Code that began the longest interval */
+	uint64_t total;
+	uint32_t histogram[CRITICAL_STATS_BUCKETS];	/* Bucket N holds [2^N, 2^(N+1)) */
+} critical_stats_entry;
+
+#if configUSE_CRITICAL_STATS == 1
+
+// Function declarations
+void critical_stats_begin(enum critical_stats_kind kind, void *site);
+void critical_stats_end(enum critical_stats_kind kind);
+void output_critical_stats(void);
+
+/* Kernel hooks.  Task critical sections and suspensions take their site from
+the return address of the kernel function the hook expands in. */
+#define traceCRITICAL_ENTER() critical_stats_begin( CRITICAL_STATS_TASK, __builtin_return_address( 0 ) )
+#define traceCRITICAL_EXIT() critical_stats_end( CRITICAL_STATS_TASK )
+#define traceISR_MASK( pvSite ) critical_stats_begin( CRITICAL_STATS_ISR, ( void * ) ( pvSite ) )
+#define traceISR_UNMASK() critical_stats_end( CRITICAL_STATS_ISR )
+#define traceSCHEDULER_SUSPEND() critical_stats_begin( CRITICAL_STATS_SUSPENDED, __builtin_return_address( 0 ) )
+#define traceSCHEDULER_RESUME() critical_stats_end( CRITICAL_STATS_SUSPENDED )
+
+#else
+
+#define output_critical_stats()
+
+#endif /* configUSE_CRITICAL_STATS */
+
+#endif /* CRITICAL_STATS_H */
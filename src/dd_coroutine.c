@@ -0,0 +1,175 @@
+/* Standard includes. */
+#include <stdint.h>
+/* Kernel includes. */
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+#include "../FreeRTOS_Source/include/croutine.h"
+
+#include "cpu_stats.h"
+#include "dd_coroutine.h"
+#include "dd_scheduler.h"
+
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_COROUTINE
+
+// A pool co-routine and the job it holds
+typedef struct dd_coroutine_slot
+{
+	CRCB_t crcb;
+	dd_task task;				/* A copy, as a dropped job's record can be freed first */
+	BaseType_t busy;
+	BaseType_t dropped;
+	TickType_t run_ticks;
+	TickType_t seen_at;
+} dd_coroutine_slot;
+
+// Only used by the Scheduler task and the co-routines it runs
+static dd_coroutine_slot slots[DD_COROUTINE_POOL_SIZE];
+static uint32_t busy_count;
+static dd_coroutine_slot *last_run;
+static dd_task_lists *job_lists;
+
+static dd_coroutine_slot *find_slot(uint32_t task_id);
+
+void dd_coroutine_init(dd_task_lists *lists, crCOROUTINE_CODE job)
+{
+	job_lists = lists;
+	for (UBaseType_t i = 0; i < DD_COROUTINE_POOL_SIZE; i++)
+	{
+		xCoRoutineCreateStatic(job, 0, i, &slots[i].crcb);
+	}
+}
+
+// Returns pdFALSE if every co-routine holds a job
+BaseType_t dd_coroutine_release(const dd_task *task)
+{
+	for (uint32_t i = 0; i < DD_COROUTINE_POOL_SIZE; i++)
+	{
+		dd_coroutine_slot *slot = &slots[i];
+
+		if (slot->busy == pdFALSE)
+		{
+			slot->task = *task;
+			slot->busy = pdTRUE;
+			slot->dropped = pdFALSE;
+			slot->run_ticks = 0;
+			// The previous job's ticks must not run on into this one
+			if (last_run == slot)
+			{
+				last_run = NULL;
+			}
+			busy_count++;
+			vCoRoutineSetDeadline(&slot->crcb, task->absolute_deadline);
+			return pdTRUE;
+		}
+	}
+	return pdFALSE;
+}
+
+BaseType_t dd_coroutine_pending(void)
+{
+	return busy_count > 0;
+}
+
+// Resumes the most urgent job until it next yields
+void dd_coroutine_run(void)
+{
+	if (busy_count > 0)
+	{
+		uint32_t started = ulTaskGetRunTimeCounter(NULL);
+
+		vCoRoutineSchedule();
+		cpu_stats_charge_jobs(ulTaskGetRunTimeCounter(NULL) - started);
+	}
+}
+
+// The job held by a co-routine, or NULL while it waits in the pool
+const dd_task *dd_coroutine_job(UBaseType_t index)
+{
+	return slots[index].busy != pdFALSE ? &slots[index].task : NULL;
+}
+
+BaseType_t dd_coroutine_dropped(UBaseType_t index)
+{
+	return slots[index].dropped;
+}
+
+// Counts the ticks since the job last looked, and returns pdTRUE if there
+// were any, when the job should yield.  Ticks that passed while another job
+// ran are not the job's own.
+BaseType_t dd_coroutine_tick(UBaseType_t index)
+{
+	dd_coroutine_slot *slot = &slots[index];
+	TickType_t now = xTaskGetTickCount();
+	TickType_t elapsed;
+
+	if (last_run != slot)
+	{
+		last_run = slot;
+		slot->seen_at = now;
+	}
+	elapsed = now - slot->seen_at;
+	slot->seen_at = now;
+	slot->run_ticks += elapsed;
+	return elapsed != 0;
+}
+
+// Ticks counted by dd_coroutine_tick() so far
+TickType_t dd_coroutine_run_ticks(UBaseType_t index)
+{
+	return slots[index].run_ticks;
+}
+
+// Completes the job unless it was dropped, and returns the co-routine to the
+// pool.  A job that can no longer finish in time is dropped rather than resumed.
+void dd_coroutine_job_done(UBaseType_t index)
+{
+	dd_coroutine_slot *slot = &slots[index];
+
+	if (slot->dropped == pdFALSE)
+	{
+		complete_dd_task_id(job_lists, slot->task.task_id, xTaskGetTickCount());
+	}
+	slot->busy = pdFALSE;
+	busy_count--;
+	vCoRoutineSetDeadline(&slot->crcb, portMAX_DELAY);
+	drop_overdue_dd_tasks(job_lists);
+}
+
+// Ticks run by a job so far, including the current tick if it is running
+TickType_t dd_coroutine_job_ticks(uint32_t task_id)
+{
+	dd_coroutine_slot *slot = find_slot(task_id);
+
+	if (slot == NULL)
+	{
+		return 0;
+	}
+	return slot->run_ticks + (last_run == slot ? xTaskGetTickCount() - slot->seen_at : 0);
+}
+
+// Called by drop_overdue_dd_tasks() as it drops a job.  The co-routine goes to
+// the front so it frees its slot at the next dd_coroutine_run().
+void dd_coroutine_job_dropped(uint32_t task_id)
+{
+	dd_coroutine_slot *slot = find_slot(task_id);
+
+	if (slot != NULL)
+	{
+		slot->dropped = pdTRUE;
+		vCoRoutineSetDeadline(&slot->crcb, 0);
+	}
+}
+
+static dd_coroutine_slot *find_slot(uint32_t task_id)
+{
+	for (uint32_t i = 0; i < DD_COROUTINE_POOL_SIZE; i++)
+	{
+		if (slots[i].busy != pdFALSE && slots[i].dropped == pdFALSE && slots[i].task.task_id == task_id)
+		{
+			return &slots[i];
+		}
+	}
+	return NULL;
+}
+
+#endif /* DD_JOB_BACKEND */
@@ -0,0 +1,70 @@
+#ifndef DD_COROUTINE_H
+#define DD_COROUTINE_H
+
+#include <stdint.h>
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/croutine.h"
+
+#include "dd_scheduler.h"
+
+/*
+ * Co-routine job backend.
+ *
+ * With DD_JOB_BACKEND set to DD_JOB_BACKEND_COROUTINE, jobs run as stackless
+ * co-routines that the Scheduler task resumes on its own stack.  A job costs a
+ * co-routine control block and a slot rather than a TCB and a stack.  Co-routines
+ * cannot be deleted, so dd_coroutine_init() creates a fixed pool of
+ * DD_COROUTINE_POOL_SIZE and each takes one job at a time.
+ *
+ * The kernel keeps ready co-routines in deadline order
+ * (configUSE_CO_ROUTINE_DEADLINES).  dd_coroutine_release() hands a job to a
+ * free co-routine and gives the co-routine the job's deadline, so
+ * dd_coroutine_run() always resumes the most urgent job.  A job yields with
+ * crDELAY( xHandle, 0 ) when dd_coroutine_tick() reports a new tick.  The
+ * Scheduler then serves its messages, and a job released with an earlier
+ * deadline runs next.  Unlike the executor's nested calls, a preempted job
+ * simply waits for its turn in the ready list, so there is no nesting limit.
+ *
+ * Locals do not survive a yield, so a job reads its state back from its slot.
+ * dd_coroutine_run_ticks() gives the ticks a job has run, less those taken
+ * by other jobs while it waited.
+ *
+ * A job in progress is only dropped as overdue once the time it has left to
+ * run no longer fits before its deadline.  Its co-routine is moved to the front
+ * of the ready list, sees dd_coroutine_dropped() and goes back to the pool.
+ *
+ * As with the executor, the Scheduler passes the run time of each
+ * dd_coroutine_run() to cpu_stats_charge_jobs(), so the CPU report counts it
+ * as the jobs' share, and jobs get no MISS report.
+ */
+
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_COROUTINE
+#if configUSE_CO_ROUTINE_DEADLINES != 1
+#error "The co-routine job backend needs configUSE_CO_ROUTINES and configUSE_CO_ROUTINE_DEADLINES"
+#endif
+#if configSUPPORT_STATIC_ALLOCATION != 1
+// xCoRoutineCreate() returns no handle, and the pool needs one to set deadlines
+#error "The co-routine job backend needs configSUPPORT_STATIC_ALLOCATION"
+#endif
+#endif
+
+// Jobs that can hold a co-routine at once, from release until completion or
+// until they are dropped as overdue
+#ifndef DD_COROUTINE_POOL_SIZE
+#define DD_COROUTINE_POOL_SIZE 8
+#endif
+
+// Function declarations
+void dd_coroutine_init(dd_task_lists *lists, crCOROUTINE_CODE job);
+BaseType_t dd_coroutine_release(const dd_task *task);
+BaseType_t dd_coroutine_pending(void);
+void dd_coroutine_run(void);
+const dd_task *dd_coroutine_job(UBaseType_t index);
+BaseType_t dd_coroutine_dropped(UBaseType_t index);
+BaseType_t dd_coroutine_tick(UBaseType_t index);
+TickType_t dd_coroutine_run_ticks(UBaseType_t index);
+void dd_coroutine_job_done(UBaseType_t index);
+TickType_t dd_coroutine_job_ticks(uint32_t task_id);
+void dd_coroutine_job_dropped(uint32_t task_id);
+
+#endif /* DD_COROUTINE_H */
@@ -0,0 +1,149 @@
+/* Standard includes. */
+#include <stdint.h>
+/* Kernel includes. */
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+
+#include "cpu_stats.h"
+#include "dd_executor.h"
+#include "dd_scheduler.h"
+
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_EXECUTOR
+
+// A job in progress on the Scheduler's stack
+typedef struct dd_executor_frame
+{
+	uint32_t task_id;
+	TickType_t absolute_deadline;
+	TickType_t started_at;
+	TickType_t preempted;		/* Ticks run by jobs nested inside this one */
+	BaseType_t dropped;
+} dd_executor_frame;
+
+// Only used by the Scheduler task.  Frames are innermost last.
+static dd_executor_frame frames[DD_EXECUTOR_MAX_NESTING];
+static uint32_t depth;
+static dd_task_lists *job_lists;
+static dd_job_function run_job;
+static dd_executor_poll poll_messages;
+static void *poll_context;
+static TickType_t seen_at;
+static BaseType_t poll_pending;
+// The Scheduler's run time counter when the innermost job last started or resumed
+static uint32_t job_run_time;
+
+void dd_executor_init(dd_task_lists *lists, dd_job_function job, dd_executor_poll poll, void *context)
+{
+	job_lists = lists;
+	run_job = job;
+	poll_messages = poll;
+	poll_context = context;
+}
+
+// Runs jobs from the head of the active list for as long as the head is more
+// urgent than the job in progress.  At the outermost level that is until the
+// list is empty.
+void dd_executor_dispatch(void)
+{
+	while (depth < DD_EXECUTOR_MAX_NESTING)
+	{
+		dd_task task;
+		dd_executor_frame *frame;
+
+		// A job that can no longer finish in time is dropped rather than started
+		drop_overdue_dd_tasks(job_lists);
+		if (job_lists->active == NULL ||
+				(depth > 0 && job_lists->active->task.absolute_deadline >= frames[depth - 1].absolute_deadline))
+		{
+			return;
+		}
+
+		// A dropped job's record can be freed while the job still runs, so it
+		// runs on a copy
+		task = job_lists->active->task;
+		frame = &frames[depth++];
+		frame->task_id = task.task_id;
+		frame->absolute_deadline = task.absolute_deadline;
+		frame->started_at = xTaskGetTickCount();
+		frame->preempted = 0;
+		frame->dropped = pdFALSE;
+
+		job_run_time = ulTaskGetRunTimeCounter(NULL);
+		run_job(&task);
+		cpu_stats_charge_jobs(ulTaskGetRunTimeCounter(NULL) - job_run_time);
+
+		depth--;
+		if (depth > 0)
+		{
+			frames[depth - 1].preempted += xTaskGetTickCount() - frame->started_at;
+		}
+		if (frame->dropped == pdFALSE)
+		{
+			complete_dd_task_id(job_lists, task.task_id, xTaskGetTickCount());
+		}
+	}
+}
+
+// Returns pdFALSE if the calling job has been dropped and must return.
+// Releases only arrive on a tick, so messages are served once per tick, at the
+// second preemption point after it.  A job that ends on the tick gets to see
+// it first and completes before the releases due then, as on a worker task.
+BaseType_t dd_executor_preemption_point(void)
+{
+	TickType_t now = xTaskGetTickCount();
+
+	configASSERT(depth > 0);
+
+	if (now != seen_at)
+	{
+		seen_at = now;
+		poll_pending = pdTRUE;
+	}
+	else if (poll_pending != pdFALSE)
+	{
+		poll_pending = pdFALSE;
+		// Serving messages is the Scheduler's time, and nested jobs charge their own
+		cpu_stats_charge_jobs(ulTaskGetRunTimeCounter(NULL) - job_run_time);
+		poll_messages(poll_context);
+		dd_executor_dispatch();
+		job_run_time = ulTaskGetRunTimeCounter(NULL);
+	}
+	return frames[depth - 1].dropped == pdFALSE;
+}
+
+// Ticks the calling job has run, leaving out the jobs nested inside it
+TickType_t dd_executor_run_ticks(void)
+{
+	configASSERT(depth > 0);
+
+	return dd_executor_job_ticks(frames[depth - 1].task_id);
+}
+
+// Ticks run by a job in progress, 0 for any other job
+TickType_t dd_executor_job_ticks(uint32_t task_id)
+{
+	TickType_t now = xTaskGetTickCount();
+
+	for (uint32_t i = 0; i < depth; i++)
+	{
+		if (frames[i].task_id == task_id)
+		{
+			return now - frames[i].started_at - frames[i].preempted;
+		}
+	}
+	return 0;
+}
+
+// Called by drop_overdue_dd_tasks() as it drops a job
+void dd_executor_job_dropped(uint32_t task_id)
+{
+	for (uint32_t i = 0; i < depth; i++)
+	{
+		if (frames[i].task_id == task_id)
+		{
+			frames[i].dropped = pdTRUE;
+		}
+	}
+}
+
+#endif /* DD_JOB_BACKEND */
@@ -0,0 +1,60 @@
+#ifndef DD_EXECUTOR_H
+#define DD_EXECUTOR_H
+
+#include <stdint.h>
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+
+#include "dd_scheduler.h"
+
+/*
+ * Run-to-completion job executor.
+ *
+ * With DD_JOB_BACKEND set to DD_JOB_BACKEND_EXECUTOR, jobs are plain function
+ * calls made by the Scheduler task on its own stack, rather than worker tasks
+ * with a TCB and a stack each.  A pending job is only its record in the active
+ * list.
+ *
+ * dd_executor_dispatch() calls the job at the head of the active list and
+ * completes it when the call returns.  A job calls
+ * dd_executor_preemption_point() whenever it can be interrupted.  Once per
+ * tick, a preemption point serves the Scheduler's waiting messages through the
+ * poll function.  If a release has put a job with an earlier deadline at
+ * the head, it calls that job at once, nested on the same stack.
+ * dd_executor_run_ticks() gives the ticks a job has run, less those taken by
+ * the jobs nested inside it.
+ *
+ * Under EDF a job only preempts jobs with a later deadline, and it finishes
+ * before any of them resumes, so the jobs in progress always nest like calls.
+ * At most DD_EXECUTOR_MAX_NESTING jobs are in progress at once, which bounds
+ * the Scheduler's stack.  Any more urgent job waits for the innermost one to
+ * finish.
+ *
+ * A job in progress is only dropped as overdue once the time it has left to
+ * run no longer fits before its deadline.  A dropped job cannot be cut off.
+ * Instead its preemption point returns pdFALSE and the job must return at once.
+ *
+ * The Scheduler task's run time spent inside jobs, less the messages served at
+ * their preemption points, is passed to cpu_stats_charge_jobs(), so the CPU
+ * report counts it as the jobs' share.  Without a task of its own, a job gets
+ * no MISS report.
+ */
+
+#ifndef DD_EXECUTOR_MAX_NESTING
+#define DD_EXECUTOR_MAX_NESTING 4
+#endif
+
+// Runs the job to completion, calling the preemption point regularly
+typedef void (*dd_job_function)(const dd_task *task);
+
+// Serves every message waiting for the Scheduler without blocking
+typedef void (*dd_executor_poll)(void *context);
+
+// Function declarations
+void dd_executor_init(dd_task_lists *lists, dd_job_function job, dd_executor_poll poll, void *context);
+void dd_executor_dispatch(void);
+BaseType_t dd_executor_preemption_point(void);
+TickType_t dd_executor_run_ticks(void);
+TickType_t dd_executor_job_ticks(uint32_t task_id);
+void dd_executor_job_dropped(uint32_t task_id);
+
+#endif /* DD_EXECUTOR_H */
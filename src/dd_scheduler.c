@@ -0,0 +1,556 @@
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+/* Kernel includes. */
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+
+#include "dd_coroutine.h"
+#include "dd_executor.h"
+#include "dd_scheduler.h"
+#include "miss_report.h"
+#include "telemetry.h"
+#include "trace.h"
+
+static dd_task_list *alloc_task_record(void);
+static void free_task_record(dd_task_list *record);
+static dd_task_list *drop_before(dd_task_list *task_list, dd_task_list *last_reported);
+static void finish_dd_task(dd_task_lists *lists, dd_task_list **link, TickType_t completion_time);
+static void set_job_priority(const dd_task_list *job, UBaseType_t priority);
+static TickType_t time_left(const dd_task *task);
+static void stop_job(const dd_task *task);
+static void append_dd_task(dd_task_list **task_list, dd_task_list *new_task);
+static void insert_dd_task(dd_task_list **task_list, dd_task_list *new_task);
+static dd_task_list *collect_new_tasks(dd_status_batch *batch, dd_status_sink sink, void *context,
+		dd_task_list *cursor, dd_task_list *task_list, enum telemetry_job_state state,
+		uint32_t *count, TickType_t *worst_lateness);
+static void add_status_record(dd_status_batch *batch, dd_status_sink sink, void *context,
+		enum telemetry_job_state state, const dd_task *task);
+static void output_status_sink(const dd_status_batch *batch, size_t length, void *context);
+static void report_begin(enum telemetry_job_state state);
+static void report_section(enum telemetry_job_state state);
+static void report_task(enum telemetry_job_state state, const dd_task *task);
+static void report_summary(const dd_status_summary *summary);
+
+// Section of the report being rendered, carried across the batches of a report
+static enum telemetry_job_state rendered_section;
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+// Records never handed out yet, then those returned by drop_reported_tasks()
+static dd_task_list job_store[DD_JOB_STORE_SIZE];
+static uint32_t job_store_used;
+static dd_task_list *free_records;
+#endif
+
+// Returns pdFALSE, leaving the lists unchanged, if there is no record for the job
+BaseType_t release_dd_task(dd_task_lists *lists, const dd_task *task)
+{
+	dd_task_list *new_task = alloc_task_record();
+
+	if (new_task == NULL)
+	{
+		return pdFALSE;
+	}
+
+	// The current head may no longer be the most urgent task
+	if (lists->active != NULL)
+	{
+		set_job_priority(lists->active, PENDING_TASK_PRIORITY);
+	}
+
+	new_task->task = *task;
+	trace_job(TRACE_JOB_RELEASE, task->task_id, task->absolute_deadline);
+	miss_report_release(task);
+	insert_dd_task(&lists->active, new_task);
+	drop_overdue_dd_tasks(lists);
+
+	if (lists->active != NULL)
+	{
+		set_job_priority(lists->active, ACTIVE_TASK_PRIORITY);
+	}
+	return pdTRUE;
+}
+
+// Remove the jobs at the head that can no longer finish before their deadline
+void drop_overdue_dd_tasks(dd_task_lists *lists)
+{
+	while (lists->active != NULL &&
+			lists->active->task.absolute_deadline <
+			time_left(&lists->active->task) + xTaskGetTickCount())
+	{
+		dd_task_list *overdue_task = lists->active;
+		lists->active = overdue_task->next_task;
+		overdue_task->next_task = NULL;
+		overdue_task->task.completion_time = xTaskGetTickCount();
+		trace_job(TRACE_JOB_OVERDUE, overdue_task->task.task_id, overdue_task->task.absolute_deadline);
+		miss_report_overdue(&overdue_task->task);
+
+		append_dd_task(&lists->overdue, overdue_task);
+		stop_job(&overdue_task->task);
+	}
+}
+
+void complete_dd_task(dd_task_lists *lists, TickType_t completion_time)
+{
+	if (lists->active != NULL)
+	{
+		finish_dd_task(lists, &lists->active, completion_time);
+	}
+}
+
+// Completes a job anywhere in the active list, as the executor may finish a
+// job while a more urgent one waits.  Returns pdFALSE if the job is not active.
+BaseType_t complete_dd_task_id(dd_task_lists *lists, uint32_t task_id, TickType_t completion_time)
+{
+	dd_task_list **link = &lists->active;
+
+	while (*link != NULL && (*link)->task.task_id != task_id)
+	{
+		link = &(*link)->next_task;
+	}
+	if (*link == NULL)
+	{
+		return pdFALSE;
+	}
+
+	finish_dd_task(lists, link, completion_time);
+	return pdTRUE;
+}
+
+static void finish_dd_task(dd_task_lists *lists, dd_task_list **link, TickType_t completion_time)
+{
+	dd_task_list *completed_task = *link;
+
+	completed_task->task.completion_time = completion_time;
+	trace_job(TRACE_JOB_COMPLETE, completed_task->task.task_id, completion_time);
+	miss_report_complete(&completed_task->task);
+	*link = completed_task->next_task;
+	completed_task->next_task = NULL;
+	append_dd_task(&lists->completed, completed_task);
+
+	if (lists->active != NULL)
+	{
+		set_job_priority(lists->active, ACTIVE_TASK_PRIORITY);
+	}
+}
+
+// Jobs run by the executor have no task, it follows the list order itself
+static void set_job_priority(const dd_task_list *job, UBaseType_t priority)
+{
+	if (job->task.t_handle != NULL)
+	{
+		vTaskPrioritySet(job->task.t_handle, priority);
+	}
+}
+
+// A worker is treated as if it had not started, as its progress is unknown
+static TickType_t time_left(const dd_task *task)
+{
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_EXECUTOR
+	return task->execution_time - min(dd_executor_job_ticks(task->task_id) * portTICK_PERIOD_MS, task->execution_time);
+#elif DD_JOB_BACKEND == DD_JOB_BACKEND_COROUTINE
+	return task->execution_time - min(dd_coroutine_job_ticks(task->task_id) * portTICK_PERIOD_MS, task->execution_time);
+#else
+	return task->execution_time;
+#endif
+}
+
+static void stop_job(const dd_task *task)
+{
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_EXECUTOR
+	dd_executor_job_dropped(task->task_id);
+#elif DD_JOB_BACKEND == DD_JOB_BACKEND_COROUTINE
+	dd_coroutine_job_dropped(task->task_id);
+#else
+	vTaskDelete(task->t_handle);
+#endif
+}
+
+static dd_task_list *alloc_task_record(void)
+{
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	dd_task_list *record = free_records;
+
+	if (record != NULL)
+	{
+		free_records = record->next_task;
+	}
+	else if (job_store_used < DD_JOB_STORE_SIZE)
+	{
+		record = &job_store[job_store_used++];
+	}
+	return record;
+#else
+	return pvPortMalloc( sizeof(dd_task_list));
+#endif
+}
+
+static void free_task_record(dd_task_list *record)
+{
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	record->next_task = free_records;
+	free_records = record;
+#else
+	vPortFree(record);
+#endif
+}
+
+// Free the completed and overdue records the Monitor has already been sent.
+// The last one reported stays, as the cursor continues from it.
+void drop_reported_tasks(dd_monitor_cursor *cursor, dd_task_lists *lists)
+{
+	lists->completed = drop_before(lists->completed, cursor->completed);
+	lists->overdue = drop_before(lists->overdue, cursor->overdue);
+}
+
+static dd_task_list *drop_before(dd_task_list *task_list, dd_task_list *last_reported)
+{
+	if (last_reported == NULL)
+	{
+		return task_list;
+	}
+
+	while (task_list != last_reported)
+	{
+		dd_task_list *next = task_list->next_task;
+		free_task_record(task_list);
+		task_list = next;
+	}
+	return task_list;
+}
+
+static void append_dd_task(dd_task_list **task_list, dd_task_list *new_task)
+{
+	dd_task_list *end_list = *task_list;
+
+	if (end_list == NULL)
+	{
+		*task_list = new_task;
+		return;
+	}
+
+	while (end_list->next_task != NULL)
+	{
+		end_list = end_list->next_task;
+	}
+	end_list->next_task = new_task;
+}
+
+// After the jobs with the same deadline, so the list stays in release order
+// among them as it did when it was sorted after each append
+static void insert_dd_task(dd_task_list **task_list, dd_task_list *new_task)
+{
+	while (*task_list != NULL && (*task_list)->task.absolute_deadline <= new_task->task.absolute_deadline)
+	{
+		task_list = &(*task_list)->next_task;
+	}
+	new_task->next_task = *task_list;
+	*task_list = new_task;
+}
+
+void collect_task_deltas(dd_monitor_cursor *cursor, const dd_task_lists *lists, dd_status_sink sink, void *context)
+{
+	// Only the Scheduler task collects a report, so one batch is enough
+	static dd_status_batch batch;
+	dd_status_summary *summary = &batch.summary;
+	dd_task_list *cur_elem;
+	uint32_t total;
+
+	batch.first = 1;
+	batch.final = 0;
+	batch.record_count = 0;
+	memset(summary, 0, sizeof(dd_status_summary));
+
+	// Active tasks are reported once, when first seen after their release
+	uint32_t newest_id = cursor->last_active_id;
+	uint8_t reported = cursor->active_reported;
+
+	for (cur_elem = lists->active; cur_elem != NULL; cur_elem = cur_elem->next_task)
+	{
+		summary->active_count++;
+		if (!cursor->active_reported ||
+				(int32_t) (cur_elem->task.task_id - cursor->last_active_id) > 0)
+		{
+			add_status_record(&batch, sink, context, TELEMETRY_JOB_ACTIVE, &cur_elem->task);
+			if (!reported || (int32_t) (cur_elem->task.task_id - newest_id) > 0)
+			{
+				newest_id = cur_elem->task.task_id;
+				reported = 1;
+			}
+		}
+	}
+	cursor->last_active_id = newest_id;
+	cursor->active_reported = reported;
+
+	// The completed and overdue lists only grow at the tail
+	cursor->completed = collect_new_tasks(&batch, sink, context, cursor->completed, lists->completed,
+			TELEMETRY_JOB_COMPLETED, &cursor->completed_count, &cursor->worst_lateness);
+	cursor->overdue = collect_new_tasks(&batch, sink, context, cursor->overdue, lists->overdue,
+			TELEMETRY_JOB_OVERDUE, &cursor->overdue_count, &cursor->worst_lateness);
+
+	summary->completed_count = cursor->completed_count;
+	summary->overdue_count = cursor->overdue_count;
+	summary->worst_lateness = cursor->worst_lateness;
+	total = cursor->completed_count + cursor->overdue_count;
+	if (total != 0)
+	{
+		summary->miss_permille = (uint32_t) (((uint64_t) cursor->overdue_count * 1000) / total);
+	}
+
+	batch.final = 1;
+	sink(&batch, dd_status_batch_length(&batch), context);
+}
+
+static dd_task_list *collect_new_tasks(dd_status_batch *batch, dd_status_sink sink, void *context,
+		dd_task_list *cursor, dd_task_list *task_list, enum telemetry_job_state state,
+		uint32_t *count, TickType_t *worst_lateness)
+{
+	dd_task_list *cur_elem = (cursor == NULL) ? task_list : cursor->next_task;
+
+	while (cur_elem != NULL)
+	{
+		if (cur_elem->task.completion_time > cur_elem->task.absolute_deadline)
+		{
+			*worst_lateness = max(*worst_lateness,
+					cur_elem->task.completion_time - cur_elem->task.absolute_deadline);
+		}
+		(*count)++;
+		add_status_record(batch, sink, context, state, &cur_elem->task);
+		cursor = cur_elem;
+		cur_elem = cur_elem->next_task;
+	}
+	return cursor;
+}
+
+static void add_status_record(dd_status_batch *batch, dd_status_sink sink, void *context,
+		enum telemetry_job_state state, const dd_task *task)
+{
+	// Hand over a full batch before reusing it
+	if (batch->record_count == DD_STATUS_BATCH_RECORDS)
+	{
+		sink(batch, dd_status_batch_length(batch), context);
+		batch->first = 0;
+		batch->record_count = 0;
+	}
+
+	batch->records[batch->record_count].state = (uint8_t) state;
+	batch->records[batch->record_count].task = *task;
+	batch->record_count++;
+}
+
+void output_status_batch(const dd_status_batch *batch)
+{
+	if (batch->first)
+	{
+		rendered_section = TELEMETRY_JOB_ACTIVE;
+		report_begin(TELEMETRY_JOB_ACTIVE);
+	}
+
+	// Records arrive in section order, empty sections still get a header
+	for (uint16_t i = 0; i < batch->record_count; i++)
+	{
+		const dd_status_record *record = &batch->records[i];
+
+		while (rendered_section < record->state)
+		{
+			report_section(++rendered_section);
+		}
+		report_task(rendered_section, &record->task);
+	}
+
+	if (batch->final)
+	{
+		while (rendered_section < TELEMETRY_JOB_OVERDUE)
+		{
+			report_section(++rendered_section);
+		}
+		report_summary(&batch->summary);
+	}
+}
+
+void output_task_deltas(dd_monitor_cursor *cursor, dd_task_list *active_task_list, dd_task_list *completed_task_list, dd_task_list *overdue_task_list)
+{
+	dd_task_lists lists = { active_task_list, completed_task_list, overdue_task_list };
+
+	collect_task_deltas(cursor, &lists, output_status_sink, NULL);
+}
+
+static void output_status_sink(const dd_status_batch *batch, size_t length, void *context)
+{
+	( void ) length;
+	( void ) context;
+	output_status_batch(batch);
+}
+
+#if MONITOR_TELEMETRY == 1
+
+static void report_begin(enum telemetry_job_state state)
+{
+	( void ) state;
+	telemetry_begin(xTaskGetTickCount());
+}
+
+static void report_section(enum telemetry_job_state state)
+{
+	( void ) state;
+}
+
+static void report_task(enum telemetry_job_state state, const dd_task *task)
+{
+	telemetry_add_job(state, task);
+}
+
+static void report_summary(const dd_status_summary *summary)
+{
+	telemetry_summary_record record;
+
+	record.active_count = summary->active_count;
+	record.completed_count = summary->completed_count;
+	record.overdue_count = summary->overdue_count;
+	record.worst_lateness = summary->worst_lateness;
+	record.miss_permille = (uint16_t) summary->miss_permille;
+	telemetry_add_summary(&record);
+	telemetry_flush();
+}
+
+#else
+
+static void report_begin(enum telemetry_job_state state)
+{
+	report_section(state);
+}
+
+static void report_section(enum telemetry_job_state state)
+{
+	static const char * const section_names[] = { "NEW ACTIVE\n", "NEW COMPLETED\n", "NEW OVERDUE\n" };
+
+	printf("%s", section_names[state]);
+	fflush(stdout);
+}
+
+static void report_task(enum telemetry_job_state state, const dd_task *task)
+{
+	( void ) state;
+	printf("Task ID: %u, Release time: %u, Absolute deadline: %u, Completion time: %u\n",
+			task->task_id, task->release_time, task->absolute_deadline, task->completion_time);
+	fflush(stdout);
+}
+
+static void report_summary(const dd_status_summary *summary)
+{
+	printf("SUMMARY\n");
+	printf("Active tasks: %u, Completed tasks: %u, Overdue tasks: %u\n",
+			summary->active_count, summary->completed_count, summary->overdue_count);
+	printf("Miss ratio: %u.%u%%, Worst lateness: %u\n\n",
+			summary->miss_permille / 10, summary->miss_permille % 10, summary->worst_lateness);
+	fflush(stdout);
+}
+
+#endif /* MONITOR_TELEMETRY */
+
+void output_task_lists(dd_task_list *active_task_list, dd_task_list *completed_task_list, dd_task_list *overdue_task_list)
+{
+	dd_task_list *cur_elem;
+	uint16_t counter = 0;
+
+	printf("ACTIVE LIST\n");
+	cur_elem = active_task_list;
+	while (cur_elem != NULL)
+	{
+		counter++;
+		printf("Task ID: %d, ", cur_elem->task.task_id);
+		fflush(stdout);
+		printf("Release time: %d, ", cur_elem->task.release_time);
+		fflush(stdout);
+		printf("Absolute deadline: %d, ", cur_elem->task.absolute_deadline);
+		fflush(stdout);
+		printf("Completion time: %d\n", cur_elem->task.completion_time);
+		fflush(stdout);
+		cur_elem = cur_elem->next_task;
+	}
+	printf("Number active tasks: %d\n\n", counter);
+	fflush(stdout);
+
+	counter = 0;
+	printf("COMPLETED LIST\n");
+	fflush(stdout);
+	cur_elem = completed_task_list;
+	while (cur_elem != NULL)
+	{
+		counter++;
+		printf("Task ID: %d, ", cur_elem->task.task_id);
+		fflush(stdout);
+		printf("Release time: %d, ", cur_elem->task.release_time);
+		fflush(stdout);
+		printf("Absolute deadline: %d, ", cur_elem->task.absolute_deadline);
+		fflush(stdout);
+		printf("Completion time: %d\n", cur_elem->task.completion_time);
+		fflush(stdout);
+		cur_elem = cur_elem->next_task;
+	}
+	printf("Number completed tasks: %d\n\n", counter);
+	fflush(stdout);
+
+	counter = 0;
+	printf("OVERDUE LIST\n");
+	fflush(stdout);
+	if (overdue_task_list != NULL)
+	{
+		cur_elem = overdue_task_list;
+		while (cur_elem != NULL)
+		{
+			counter++;
+			printf("Task ID: %d, ", cur_elem->task.task_id);
+			fflush(stdout);
+			printf("Release time: %d, ", cur_elem->task.release_time);
+			fflush(stdout);
+			printf("Absolute deadline: %d, ", cur_elem->task.absolute_deadline);
+			fflush(stdout);
+			printf("Completion time: %d\n", cur_elem->task.completion_time);
+			fflush(stdout);
+			cur_elem = cur_elem->next_task;
+		}
+	}
+	printf("Number overdue tasks: %d\n", counter);
+	fflush(stdout);
+}
+
+void sort_dd_task_list(dd_task_list *task_list)
+{
+	uint8_t swapped;
+	dd_task_list *ptr1;
+	dd_task_list *lptr = NULL;
+
+	// Check for empty list
+	if (task_list == NULL)
+	{
+		return;
+	}
+
+	do
+	{
+		swapped = 0;
+		ptr1 = task_list;
+
+		while (ptr1->next_task != lptr)
+		{
+			if (ptr1->task.absolute_deadline > ptr1->next_task->task.absolute_deadline)
+			{
+				swap_nodes(ptr1, ptr1->next_task);
+				swapped = 1;
+			}
+			ptr1 = ptr1->next_task;
+		}
+		lptr = ptr1;
+	}
+	while(swapped);
+}
+
+void swap_nodes(dd_task_list *a, dd_task_list *b)
+{
+	dd_task temp = a->task;
+	a->task = b->task;
+	b->task = temp;
+}
@@ -0,0 +1,138 @@
+#ifndef DD_SCHEDULER_H
+#define DD_SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+
+#define PENDING_TASK_PRIORITY 0
+#define ACTIVE_TASK_PRIORITY 3
+
+// 1: Monitor reports as binary telemetry frames, 0: as text
+#ifndef MONITOR_TELEMETRY
+#define MONITOR_TELEMETRY 1
+#endif
+
+// How jobs run: each on a worker task of its own, as function calls made to
+// completion on the Scheduler's stack by src/dd_executor.h, or as co-routines
+// resumed in deadline order by src/dd_coroutine.h
+#define DD_JOB_BACKEND_TASK 0
+#define DD_JOB_BACKEND_EXECUTOR 1
+#define DD_JOB_BACKEND_COROUTINE 2
+#ifndef DD_JOB_BACKEND
+#define DD_JOB_BACKEND DD_JOB_BACKEND_TASK
+#endif
+
+// Return maximum value of two numbers
+#define max(a,b) \
+	({ __typeof__ (a) _a = (a); \
+    	__typeof__ (b) _b = (b); \
+    	_a > _b ? _a : _b; })
+
+// Return minimum value of two numbers
+ #define min(a,b) \
+	({ __typeof__ (a) _a = (a); \
+    	__typeof__ (b) _b = (b); \
+    	_a < _b ? _a : _b; })
+
+// Enum definitions
+enum task_type
+{
+	PERIODIC,
+	APERIODIC
+};
+
+// Struct definitions
+typedef struct dd_task
+{
+	TaskHandle_t t_handle;
+	enum task_type type;
+	uint32_t task_id;
+	TickType_t release_time;
+	TickType_t absolute_deadline;
+	TickType_t completion_time;
+	TickType_t execution_time;
+} dd_task;
+
+typedef struct dd_task_list
+{
+	dd_task task;
+	struct dd_task_list *next_task;
+} dd_task_list;
+
+// The three lists owned by the Scheduler task
+typedef struct dd_task_lists
+{
+	dd_task_list *active;
+	dd_task_list *completed;
+	dd_task_list *overdue;
+} dd_task_lists;
+
+// Monitor state carried between reports so only new records are printed
+typedef struct dd_monitor_cursor
+{
+	dd_task_list *completed;
+	dd_task_list *overdue;
+	uint32_t last_active_id;
+	uint8_t active_reported;
+	uint32_t completed_count;
+	uint32_t overdue_count;
+	TickType_t worst_lateness;
+} dd_monitor_cursor;
+
+// Job records in the static build's job store: the active jobs plus the
+// history not yet reported to the Monitor
+#ifndef DD_JOB_STORE_SIZE
+#define DD_JOB_STORE_SIZE 32
+#endif
+
+// Job records per status batch, kept small as batches live in static RAM
+#define DD_STATUS_BATCH_RECORDS 8
+
+typedef struct dd_status_record
+{
+	uint8_t state;
+	dd_task task;
+} dd_status_record;
+
+typedef struct dd_status_summary
+{
+	uint32_t active_count;
+	uint32_t completed_count;
+	uint32_t overdue_count;
+	TickType_t worst_lateness;
+	uint32_t miss_permille;
+} dd_status_summary;
+
+// One report is one or more batches, the summary is only valid in the final one
+typedef struct dd_status_batch
+{
+	uint8_t first;
+	uint8_t final;
+	uint16_t record_count;
+	dd_status_summary summary;
+	dd_status_record records[DD_STATUS_BATCH_RECORDS];
+} dd_status_batch;
+
+// Bytes of a batch that are in use, so only those are copied
+#define dd_status_batch_length(batch) \
+	(offsetof(dd_status_batch, records) + (batch)->record_count * sizeof(dd_status_record))
+
+// Receives each batch as it fills up and the final batch of a report
+typedef void (*dd_status_sink)(const dd_status_batch *batch, size_t length, void *context);
+
+// Function declarations
+BaseType_t release_dd_task(dd_task_lists *lists, const dd_task *task);
+void complete_dd_task(dd_task_lists *lists, TickType_t completion_time);
+void drop_overdue_dd_tasks(dd_task_lists *lists);
+BaseType_t complete_dd_task_id(dd_task_lists *lists, uint32_t task_id, TickType_t completion_time);
+void collect_task_deltas(dd_monitor_cursor *cursor, const dd_task_lists *lists, dd_status_sink sink, void *context);
+void drop_reported_tasks(dd_monitor_cursor *cursor, dd_task_lists *lists);
+void output_status_batch(const dd_status_batch *batch);
+void output_task_deltas(dd_monitor_cursor *cursor, dd_task_list *active_task_list, dd_task_list *completed_task_list, dd_task_list *overdue_task_list);
+void output_task_lists(dd_task_list *active_task_list, dd_task_list *completed_task_list, dd_task_list *overdue_task_list);
+void sort_dd_task_list(dd_task_list *dd_task_list);
+void swap_nodes(dd_task_list *a, dd_task_list *b);
+
+#endif /* DD_SCHEDULER_H */
@@ -0,0 +1,217 @@
+/* Standard includes. */
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+/* Kernel includes. */
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+
+#include "logger.h"
+#include "output.h"
+
+#define LOG_RING_MASK (LOG_RING_SIZE - 1)
+
+/*
+ * Bounded multi-producer ring.  Each slot carries a sequence number: a
+ * producer may fill the slot at position pos once its sequence equals pos,
+ * and the consumer may read it once the sequence equals pos + 1.  Producers
+ * claim positions with a compare-and-swap, which GCC emits as LDREX/STREX on
+ * the Cortex-M4, so no critical section or kernel call is involved.  In
+ * deferred mode format points into .logstr and is only used as an ID.
+ */
+typedef struct log_slot
+{
+	uint32_t sequence;
+	const char *format;
+	uint32_t arg_count;
+	uint32_t args[LOG_MAX_ARGS];
+} log_slot;
+
+static log_slot log_ring[LOG_RING_SIZE];
+static uint32_t enqueue_position;
+static uint32_t dequeue_position;
+static uint32_t dropped_count;
+
+static BaseType_t log_read(log_slot *entry);
+
+void log_init(void)
+{
+	for (uint32_t i = 0; i < LOG_RING_SIZE; i++)
+	{
+		__atomic_store_n(&log_ring[i].sequence, i, __ATOMIC_RELAXED);
+	}
+	enqueue_position = 0;
+	dequeue_position = 0;
+	__atomic_store_n(&dropped_count, 0, __ATOMIC_RELEASE);
+}
+
+BaseType_t log_write(const char *format, uint32_t arg_count, ...)
+{
+	uint32_t position = __atomic_load_n(&enqueue_position, __ATOMIC_RELAXED);
+	log_slot *slot;
+	va_list va;
+
+	for (;;)
+	{
+		slot = &log_ring[position & LOG_RING_MASK];
+		int32_t difference = (int32_t) (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - position);
+
+		if (difference == 0)
+		{
+			// On failure position is reloaded with the current value
+			if (__atomic_compare_exchange_n(&enqueue_position, &position, position + 1,
+					pdTRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			// Ring full, never wait for the drain task
+			__atomic_fetch_add(&dropped_count, 1, __ATOMIC_RELAXED);
+			return pdFALSE;
+		}
+		else
+		{
+			position = __atomic_load_n(&enqueue_position, __ATOMIC_RELAXED);
+		}
+	}
+
+	if (arg_count > LOG_MAX_ARGS)
+	{
+		arg_count = LOG_MAX_ARGS;
+	}
+
+	slot->format = format;
+	slot->arg_count = arg_count;
+	va_start(va, arg_count);
+	for (uint32_t i = 0; i < LOG_MAX_ARGS; i++)
+	{
+		slot->args[i] = (i < arg_count) ? va_arg(va, uint32_t) : 0;
+	}
+	va_end(va);
+
+	__atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+	return pdTRUE;
+}
+
+uint32_t log_dropped_count(void)
+{
+	return __atomic_load_n(&dropped_count, __ATOMIC_RELAXED);
+}
+
+// Single consumer, only called from Log_Task
+static BaseType_t log_read(log_slot *entry)
+{
+	log_slot *slot = &log_ring[dequeue_position & LOG_RING_MASK];
+
+	if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != dequeue_position + 1)
+	{
+		return pdFALSE;
+	}
+
+	*entry = *slot;
+	__atomic_store_n(&slot->sequence, dequeue_position + LOG_RING_SIZE, __ATOMIC_RELEASE);
+	dequeue_position++;
+	return pdTRUE;
+}
+
+#if LOG_DEFERRED == 1
+
+static uint8_t drain_buffer[LOG_DRAIN_BUFFER_SIZE];
+static uint16_t drain_length;
+
+static void log_flush(void)
+{
+	if (drain_length != 0)
+	{
+		output_write(drain_buffer, drain_length);
+		drain_length = 0;
+	}
+}
+
+// Fletcher-16 over the bytes that follow the record header's checksum
+static uint16_t log_checksum(const uint8_t *data, uint16_t length)
+{
+	uint16_t sum1 = 0;
+	uint16_t sum2 = 0;
+
+	for (uint16_t i = 0; i < length; i++)
+	{
+		sum1 = (sum1 + data[i]) % 255;
+		sum2 = (sum2 + sum1) % 255;
+	}
+	return (uint16_t) ((sum2 << 8) | sum1);
+}
+
+// Never dereferences the format, it is not loaded on the target
+static void log_output(const log_slot *entry)
+{
+	log_record record;
+	uint16_t length = sizeof(record) + entry->arg_count * sizeof(uint32_t);
+	uint8_t *start;
+
+	if (drain_length + length > LOG_DRAIN_BUFFER_SIZE)
+	{
+		log_flush();
+	}
+
+	record.magic[0] = LOG_MAGIC_0;
+	record.magic[1] = LOG_MAGIC_1;
+	record.version = LOG_VERSION;
+	record.arg_count = (uint8_t) entry->arg_count;
+	record.length = length;
+	record.checksum = 0;
+	record.id = (uint32_t) (uintptr_t) entry->format;
+	start = &drain_buffer[drain_length];
+	memcpy(start, &record, sizeof(record));
+	memcpy(start + sizeof(record), entry->args, entry->arg_count * sizeof(uint32_t));
+	// The id and arguments are contiguous in the buffer
+	record.checksum = log_checksum(start + offsetof(log_record, id), length - offsetof(log_record, id));
+	memcpy(start + offsetof(log_record, checksum), &record.checksum, sizeof(record.checksum));
+	drain_length += length;
+}
+
+#else
+
+static void log_flush(void)
+{
+	fflush(stdout);
+}
+
+static void log_output(const log_slot *entry)
+{
+	// Unused trailing arguments are ignored by printf
+	printf(entry->format, entry->args[0], entry->args[1], entry->args[2], entry->args[3]);
+}
+
+#endif /* LOG_DEFERRED */
+
+void Log_Task( void *pvParameters )
+{
+	log_slot entry;
+	uint32_t reported_dropped = 0;
+
+	( void ) pvParameters;
+
+	while (1)
+	{
+		while (log_read(&entry) == pdTRUE)
+		{
+			log_output(&entry);
+		}
+		log_flush();
+
+		// The ring has room again, the report goes out with the next batch
+		uint32_t dropped = log_dropped_count();
+		if (dropped != reported_dropped)
+		{
+			log_printf("Log overflow: %u messages dropped\n", dropped - reported_dropped);
+			reported_dropped = dropped;
+		}
+
+		vTaskDelay(LOG_DRAIN_PERIOD_MS / portTICK_PERIOD_MS);
+	}
+}
@@ -0,0 +1,73 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdint.h>
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+
+/*
+ * Asynchronous logger.
+ *
+ * log_printf() never blocks: it claims a slot in a lock-free multi-producer
+ * ring, stores the format string and its integer arguments, and returns.  If
+ * the ring is full the message is dropped and counted.  Log_Task drains the
+ * ring at low priority and does the actual printf through ITM.
+ *
+ * The format string must be a literal and arguments are 32-bit integers
+ * (%c, %d, %i, %u, %x), at most LOG_MAX_ARGS of them.  Safe to call from
+ * tasks and interrupts.
+ *
+ * With LOG_DEFERRED set, formatting moves to the host.  Each format string
+ * is placed in the .logstr section, which the linker keeps in the ELF but
+ * never loads, and its address becomes the message ID.  Log_Task then sends
+ * binary log_record frames holding only the ID and the argument words, and
+ * tools/log_decode.py turns them back into text using the string table
+ * extracted from the ELF.  Each record carries its length and a Fletcher-16
+ * checksum of the ID and arguments, so the decoder can reject a record torn
+ * or corrupted in transit and resynchronise on the next one.
+ */
+
+#define LOG_RING_SIZE 32	/* Must be a power of two */
+#define LOG_MAX_ARGS 4
+#define LOG_DRAIN_PERIOD_MS 10
+#define LOG_DRAIN_BUFFER_SIZE 128
+
+// 1: send message IDs and raw arguments, 0: format on the target
+#ifndef LOG_DEFERRED
+#define LOG_DEFERRED 1
+#endif
+
+#define LOG_MAGIC_0 'D'
+#define LOG_MAGIC_1 'L'
+#define LOG_VERSION 2
+
+// Binary record sent in deferred mode, followed by arg_count 32-bit words
+typedef struct __attribute__((packed)) log_record
+{
+	uint8_t magic[2];
+	uint8_t version;
+	uint8_t arg_count;
+	uint16_t length;	/* Bytes in the record, arguments included */
+	uint16_t checksum;	/* Fletcher-16 of the id and argument words */
+	uint32_t id;
+} log_record;
+
+// Number of variadic arguments, 0 to LOG_MAX_ARGS
+#define LOG_NARGS(...) LOG_NARGS_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, N, ...) N
+
+#if LOG_DEFERRED == 1
+// The string only exists in the ELF, its address is the message ID
+#define log_printf(format, ...) \
+	({ static const char _log_format[] __attribute__((section(".logstr"), used)) = format; \
+		log_write(_log_format, LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__); })
+#else
+#define log_printf(format, ...) log_write((format), LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__)
+#endif
+
+// Function declarations
+void log_init(void);
+BaseType_t log_write(const char *format, uint32_t arg_count, ...);
+uint32_t log_dropped_count(void);
+void Log_Task( void *pvParameters );
+
+#endif /* LOGGER_H */
@@ -2,19 +2,63 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#ifndef HOST_BUILD
 #include "stm32f4_discovery.h"
 /* Kernel includes. */
 #include "stm32f4xx.h"
 #include "stm32f4xx_gpio.h"
+#endif
 #include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/message_buffer.h"
 #include "../FreeRTOS_Source/include/queue.h"
 #include "../FreeRTOS_Source/include/semphr.h"
 #include "../FreeRTOS_Source/include/task.h"
 #include "../FreeRTOS_Source/include/timers.h"
+#ifndef HOST_BUILD
 #include "../inc/stm32f4xx_rcc.h"
+#endif
 
 #include "string.h"
-#define mainQUEUE_LENGTH 100
+#include "cpu_stats.h"
+#include "critical_stats.h"
+#include "dd_coroutine.h"
+#include "dd_executor.h"
+#include "dd_scheduler.h"
+#include "logger.h"
+#include "miss_report.h"
+#include "output.h"
+#include "stack_stats.h"
+#include "trace.h"
+#define MESSAGE_POOL_SIZE 16
+// A data lane never holds more messages than its pool has buffers
+#define DATA_LANE_LENGTH MESSAGE_POOL_SIZE
+#define CONTROL_LANE_LENGTH 4
+#define LANE_SET_LENGTH (2 * DATA_LANE_LENGTH + CONTROL_LANE_LENGTH)
+// Releases due within the horizon are taken together with the most urgent one
+#define RELEASE_BATCH_HORIZON 50
+#define RELEASE_BATCH_MAX 4
+// Room for two full status batches, so the Scheduler rarely waits on the Monitor
+#define STATUS_BUFFER_SIZE (2 * (sizeof(dd_status_batch) + sizeof(size_t)))
+// Jobs that can hold a worker task at once, from release until completion or
+// until they are dropped as overdue
+#define WORKER_POOL_SIZE 8
+
+// Stack sizes in words, see the Monitor's STACK report for suggested values
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_EXECUTOR
+// Each job in progress adds its own frame, the dispatch and a preemption point
+#define EXECUTOR_NESTING_STACK_SIZE 48
+#define SCHEDULER_STACK_SIZE (configMINIMAL_STACK_SIZE + DD_EXECUTOR_MAX_NESTING * EXECUTOR_NESTING_STACK_SIZE)
+#elif DD_JOB_BACKEND == DD_JOB_BACKEND_COROUTINE
+// Only one job runs at a time, through vCoRoutineSchedule()
+#define COROUTINE_JOB_STACK_SIZE 48
+#define SCHEDULER_STACK_SIZE (configMINIMAL_STACK_SIZE + COROUTINE_JOB_STACK_SIZE)
+#else
+#define SCHEDULER_STACK_SIZE configMINIMAL_STACK_SIZE
+#endif
+#define GENERATOR_STACK_SIZE configMINIMAL_STACK_SIZE
+#define MONITOR_STACK_SIZE configMINIMAL_STACK_SIZE
+#define LOG_STACK_SIZE configMINIMAL_STACK_SIZE
+#define WORKER_STACK_SIZE configMINIMAL_STACK_SIZE
 
 #define TASK1_EXECUTION_TIME 100
 #define TASK2_EXECUTION_TIME 200
@@ -26,8 +70,7 @@
 #define SCHEDULER_PRIORITY 1
 #define GENERATOR_PRIORITY 2
 #define MONITOR_PRIORITY 4
-#define PENDING_TASK_PRIORITY 0
-#define ACTIVE_TASK_PRIORITY 3
+#define LOG_PRIORITY 0
 
 #define MONITOR_PERIOD_MS 500
 
@@ -36,39 +79,14 @@ enum message_type
 {
 	RELEASE_DD_TASK,
 	COMPLETE_DD_TASK,
-	GET_ACTIVE_DD_TASK_LIST,
-	GET_COMPLETED_DD_TASK_LIST,
-	GET_OVERDUE_DD_TASK_LIST
-};
-
-enum task_type
-{
-	PERIODIC,
-	APERIODIC
+	GET_DD_TASK_STATUS
 };
 
 // Struct definitions
-typedef struct dd_task
-{
-	TaskHandle_t t_handle;
-	enum task_type type;
-	uint32_t task_id;
-	TickType_t release_time;
-	TickType_t absolute_deadline;
-	TickType_t completion_time;
-	TickType_t execution_time;
-} dd_task;
-
-typedef struct dd_task_list
-{
-	dd_task task;
-	struct dd_task_list *next_task;
-} dd_task_list;
-
 typedef struct queue_message
 {
 	enum message_type type;
-	dd_task *parameters;
+	dd_task parameters;
 } queue_message;
 
 typedef struct generator_task_parameters
@@ -84,24 +102,54 @@ typedef struct user_defined_parameters
 	uint32_t task_id;
 } user_defined_parameters;
 
+// The Scheduler's lists and the Monitor's cursor, passed to the executor's
+// poll so preemption points can serve messages
+typedef struct scheduler_state
+{
+	dd_task_lists lists;
+	dd_monitor_cursor cursor;
+} scheduler_state;
+
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_TASK
+
+// A worker task and the job it runs.  The Scheduler deletes the task itself,
+// on completion or when the job is dropped, so a slot never waits for the
+// idle task's cleanup before it can be reused.
+typedef struct worker_slot
+{
+	user_defined_parameters parameters;
+	TaskHandle_t t_handle;
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	StaticTask_t tcb;
+	StackType_t stack[WORKER_STACK_SIZE];
+#endif
+} worker_slot;
 
-// Return maximum value of two numbers
-#define max(a,b) \
-	({ __typeof__ (a) _a = (a); \
-    	__typeof__ (b) _b = (b); \
-    	_a > _b ? _a : _b; })
+#endif /* DD_JOB_BACKEND */
 
-// Return minimum value of two numbers
- #define min(a,b) \
-	({ __typeof__ (a) _a = (a); \
-    	__typeof__ (b) _b = (b); \
-    	_a < _b ? _a : _b; })
 
 // Function declarations
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_TASK
 static void UserDefined_Task( void *pvParameters );
+static worker_slot *take_worker_slot(const dd_task_lists *lists);
+static void retire_worker(TaskHandle_t t_handle);
+#elif DD_JOB_BACKEND == DD_JOB_BACKEND_EXECUTOR
+static void UserDefined_Job(const dd_task *task);
+static void serve_waiting_messages(void *context);
+#else
+static void UserDefined_CoRoutine(CoRoutineHandle_t xHandle, UBaseType_t uxIndex);
+#endif
 static void Generator_Task( void *pvParameters );
 static void Scheduler_Task( void *pvParameters );
 static void Monitor_Task( void *pvParameters );
+static BaseType_t send_request(enum message_type type, TickType_t ticks_to_wait);
+static void serve_message(scheduler_state *state);
+static BaseType_t receive_next_message(queue_message **message, enum message_type *request);
+static void release_message(dd_task_lists *lists, queue_message *message);
+static void release_due_messages(dd_task_lists *lists);
+static void create_lanes(void);
+static void create_tasks(void);
+static void send_status_batch(const dd_status_batch *batch, size_t length, void *context);
 
 
 void create_dd_task(
@@ -111,36 +159,73 @@ void create_dd_task(
 		uint32_t absolute_deadline
 );
 void delete_dd_task(uint32_t task_id);
-dd_task_list** get_active_dd_task_list(void);
-dd_task_list** get_complete_dd_task_list(void);
-dd_task_list** get_overdue_dd_task_list(void);
 void init_user_defined_task_parameters(generator_task_parameters *user_defined_tasks[3]);
-void sort_dd_task_list(dd_task_list *dd_task_list);
-void swap_nodes(dd_task_list *a, dd_task_list *b);
 static void prvSetupHardware( void );
-void output_task_lists(dd_task_list *active_task_list, dd_task_list *completed_task_list, dd_task_list *overdue_task_list);
 
 
-// Queue declarations
-xQueueHandle xQueue_message_handle = 0;
-xQueueHandle xQueue_monitor_handle = 0;
+// Lanes from the other tasks to the Scheduler, served completion first, then
+// control, then release, so neither waits behind a backlog of releases.  The
+// release lane is ordered by absolute deadline.
+xQueueHandle xComplete_lane_handle = 0;
+xQueueHandle xControl_lane_handle = 0;
+xQueueHandle xRelease_lane_handle = 0;
+QueueSetHandle_t xLane_set_handle = 0;
+
+// Job status batches from the Scheduler to the Monitor
+MessageBufferHandle_t xStatus_buffer_handle = 0;
+
+// Message buffers passed by reference through the data lanes.  Completions
+// have their own pool so a burst of releases cannot hold them up.
+BufferPoolHandle_t xRelease_pool_handle = 0;
+BufferPoolHandle_t xComplete_pool_handle = 0;
+
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_TASK
+// Only used by the Scheduler
+static worker_slot workers[WORKER_POOL_SIZE];
+#endif
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+// Arenas for everything created before the scheduler starts
+static StaticQueue_t complete_lane, control_lane, release_lane, lane_set;
+static uint8_t complete_lane_storage[DATA_LANE_LENGTH * sizeof(void *)];
+static uint8_t control_lane_storage[CONTROL_LANE_LENGTH * sizeof(enum message_type)];
+static uint8_t release_lane_storage[queueORDERED_STORAGE_SIZE(DATA_LANE_LENGTH, sizeof(QueueOrderedReference_t))];
+static uint8_t lane_set_storage[LANE_SET_LENGTH * sizeof(QueueSetMemberHandle_t)];
+
+static StaticBufferPool_t release_pool, complete_pool;
+static uint8_t release_pool_storage[queueBUFFER_POOL_STORAGE_SIZE(MESSAGE_POOL_SIZE, sizeof(queue_message))]
+		__attribute__((aligned(portBYTE_ALIGNMENT)));
+static uint8_t complete_pool_storage[queueBUFFER_POOL_STORAGE_SIZE(MESSAGE_POOL_SIZE, sizeof(queue_message))]
+		__attribute__((aligned(portBYTE_ALIGNMENT)));
+
+static StaticMessageBuffer_t status_buffer;
+static uint8_t status_buffer_storage[STATUS_BUFFER_SIZE + 1];
+
+static StaticTask_t generator_tcb, scheduler_tcb, monitor_tcb, log_tcb;
+static StackType_t generator_stack[GENERATOR_STACK_SIZE];
+static StackType_t scheduler_stack[SCHEDULER_STACK_SIZE];
+static StackType_t monitor_stack[MONITOR_STACK_SIZE];
+static StackType_t log_stack[LOG_STACK_SIZE];
+#endif
 
 int main(void)
 {
 	prvSetupHardware();
+	output_init();
+	log_init();
+	miss_report_init();
 
-	// Create the queues
-	xQueue_message_handle = xQueueCreate(mainQUEUE_LENGTH, sizeof(queue_message*));
-	xQueue_monitor_handle = xQueueCreate(mainQUEUE_LENGTH, sizeof(dd_task_list*));
+	create_lanes();
+	xQueueAddToSet(xComplete_lane_handle, xLane_set_handle);
+	xQueueAddToSet(xControl_lane_handle, xLane_set_handle);
+	xQueueAddToSet(xRelease_lane_handle, xLane_set_handle);
 
 	// Add the queues to the registry
-	vQueueAddToRegistry(xQueue_message_handle, "MessageQueue");
-	vQueueAddToRegistry(xQueue_monitor_handle, "MonitorQueue");
+	vQueueAddToRegistry(xComplete_lane_handle, "CompleteLane");
+	vQueueAddToRegistry(xControl_lane_handle, "ControlLane");
+	vQueueAddToRegistry(xRelease_lane_handle, "ReleaseLane");
 
-	// Create the  tasks used in the program
-	xTaskCreate(Generator_Task, "Generator", configMINIMAL_STACK_SIZE, NULL, GENERATOR_PRIORITY, NULL);
-	xTaskCreate(Scheduler_Task, "Scheduler", configMINIMAL_STACK_SIZE, NULL, SCHEDULER_PRIORITY, NULL);
-	xTaskCreate(Monitor_Task, "Monitor", configMINIMAL_STACK_SIZE, NULL, MONITOR_PRIORITY, NULL);
+	create_tasks();
 
 	/* Start the tasks and timer running. */
 	fflush(stdout);
@@ -152,35 +237,152 @@ int main(void)
 
 }
 
+// Create the queues, pools and message buffer
+static void create_lanes(void)
+{
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	xComplete_lane_handle = xQueueCreateReferenceStatic(DATA_LANE_LENGTH, complete_lane_storage, &complete_lane);
+	xControl_lane_handle = xQueueCreateStatic(CONTROL_LANE_LENGTH, sizeof(enum message_type),
+			control_lane_storage, &control_lane);
+	xRelease_lane_handle = xQueueCreateOrderedReferenceStatic(DATA_LANE_LENGTH, release_lane_storage, &release_lane);
+	xLane_set_handle = xQueueCreateSetStatic(LANE_SET_LENGTH, lane_set_storage, &lane_set);
+	xRelease_pool_handle = xQueueCreateBufferPoolStatic(MESSAGE_POOL_SIZE, sizeof(queue_message),
+			release_pool_storage, &release_pool);
+	xComplete_pool_handle = xQueueCreateBufferPoolStatic(MESSAGE_POOL_SIZE, sizeof(queue_message),
+			complete_pool_storage, &complete_pool);
+	xStatus_buffer_handle = xMessageBufferCreateStatic(STATUS_BUFFER_SIZE, status_buffer_storage, &status_buffer);
+#else
+	xComplete_lane_handle = xQueueCreateReference(DATA_LANE_LENGTH);
+	xControl_lane_handle = xQueueCreate(CONTROL_LANE_LENGTH, sizeof(enum message_type));
+	xRelease_lane_handle = xQueueCreateOrderedReference(DATA_LANE_LENGTH);
+	xLane_set_handle = xQueueCreateSet(LANE_SET_LENGTH);
+	xRelease_pool_handle = xQueueCreateBufferPool(MESSAGE_POOL_SIZE, sizeof(queue_message));
+	xComplete_pool_handle = xQueueCreateBufferPool(MESSAGE_POOL_SIZE, sizeof(queue_message));
+	xStatus_buffer_handle = xMessageBufferCreate(STATUS_BUFFER_SIZE);
+#endif
+}
+
+// Create the  tasks used in the program
+static void create_tasks(void)
+{
+	TaskHandle_t generator_handle = NULL, scheduler_handle = NULL, monitor_handle = NULL, log_handle = NULL;
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	generator_handle = xTaskCreateStatic(Generator_Task, "Generator", GENERATOR_STACK_SIZE, NULL, GENERATOR_PRIORITY,
+			generator_stack, &generator_tcb);
+	scheduler_handle = xTaskCreateStatic(Scheduler_Task, "Scheduler", SCHEDULER_STACK_SIZE, NULL, SCHEDULER_PRIORITY,
+			scheduler_stack, &scheduler_tcb);
+	monitor_handle = xTaskCreateStatic(Monitor_Task, "Monitor", MONITOR_STACK_SIZE, NULL, MONITOR_PRIORITY,
+			monitor_stack, &monitor_tcb);
+	log_handle = xTaskCreateStatic(Log_Task, "Log", LOG_STACK_SIZE, NULL, LOG_PRIORITY, log_stack, &log_tcb);
+#else
+	xTaskCreate(Generator_Task, "Generator", GENERATOR_STACK_SIZE, NULL, GENERATOR_PRIORITY, &generator_handle);
+	xTaskCreate(Scheduler_Task, "Scheduler", SCHEDULER_STACK_SIZE, NULL, SCHEDULER_PRIORITY, &scheduler_handle);
+	xTaskCreate(Monitor_Task, "Monitor", MONITOR_STACK_SIZE, NULL, MONITOR_PRIORITY, &monitor_handle);
+	xTaskCreate(Log_Task, "Log", LOG_STACK_SIZE, NULL, LOG_PRIORITY, &log_handle);
+#endif
+
+	cpu_stats_track(CPU_STATS_GENERATOR, generator_handle);
+	cpu_stats_track(CPU_STATS_SCHEDULER, scheduler_handle);
+	cpu_stats_track(CPU_STATS_MONITOR, monitor_handle);
+	cpu_stats_track(CPU_STATS_LOG, log_handle);
+	miss_report_track(MISS_REPORT_SCHEDULER, scheduler_handle);
+	stack_stats_track(STACK_STATS_GENERATOR, generator_handle, GENERATOR_STACK_SIZE);
+	stack_stats_track(STACK_STATS_SCHEDULER, scheduler_handle, SCHEDULER_STACK_SIZE);
+	stack_stats_track(STACK_STATS_MONITOR, monitor_handle, MONITOR_STACK_SIZE);
+	stack_stats_track(STACK_STATS_LOG, log_handle, LOG_STACK_SIZE);
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_TASK
+	stack_stats_track(STACK_STATS_WORKERS, NULL, WORKER_STACK_SIZE);
+#endif
+}
+
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_TASK
+
 static void UserDefined_Task ( void *pvParameters )
 {
-	user_defined_parameters *parameters = (user_defined_parameters *) pvParameters;
+	worker_slot *worker = (worker_slot *) pvParameters;
+	user_defined_parameters *parameters = &worker->parameters;
 	TickType_t start_ticks = xTaskGetTickCount();
 
 	while (xTaskGetTickCount() - start_ticks < parameters->execution_time / portTICK_PERIOD_MS) {};
 
-	queue_message *message = pvPortMalloc( sizeof(queue_message) );
+	queue_message *message = pvQueueAllocateBuffer(xComplete_pool_handle, portMAX_DELAY);
 	message->type = COMPLETE_DD_TASK;
-	dd_task *message_parameters = pvPortMalloc (sizeof(dd_task) );
-	message_parameters->task_id = parameters->task_id;
-	message_parameters->completion_time = xTaskGetTickCount();
-	message->parameters = message_parameters;
+	message->parameters.task_id = parameters->task_id;
+	message->parameters.completion_time = xTaskGetTickCount();
+	message->parameters.t_handle = worker->t_handle;
+
+	// On success the Scheduler owns the message and releases it
+	if(xQueueSendReference(xComplete_lane_handle, message, 1000) != pdTRUE)
+	{
+		vQueueReleaseBuffer(message);
+		log_printf("User Defined Task Failed!\n");
+	}
+
+	// Wait for the Scheduler to delete this task
+	vTaskSuspend( NULL );
+}
+
+#elif DD_JOB_BACKEND == DD_JOB_BACKEND_EXECUTOR
+
+// Runs on the Scheduler's stack, and returns at once if it is dropped
+static void UserDefined_Job(const dd_task *task)
+{
+	while (dd_executor_run_ticks() < task->execution_time / portTICK_PERIOD_MS)
+	{
+		if (dd_executor_preemption_point() != pdTRUE)
+		{
+			return;
+		}
+	}
+}
+
+#else
+
+// Runs on the Scheduler's stack.  Locals do not survive crDELAY, so the job is
+// read back from the slot after every yield.
+static void UserDefined_CoRoutine(CoRoutineHandle_t xHandle, UBaseType_t uxIndex)
+{
+	BaseType_t new_tick;
+
+	crSTART(xHandle);
 
-	if(xQueueSend(xQueue_message_handle, &message, 1000) != pdTRUE)
+	for (;;)
 	{
-		printf("User Defined Task Failed!\n");
-		fflush(stdout);
+		// Wait in the pool until the Scheduler hands over a job
+		while (dd_coroutine_job(uxIndex) == NULL)
+		{
+			crDELAY(xHandle, 0);
+		}
+
+		// Yields once per tick, and stops at once if the job is dropped.  A job
+		// that finishes on the tick completes before the releases due then.
+		while (dd_coroutine_dropped(uxIndex) != pdTRUE)
+		{
+			new_tick = dd_coroutine_tick(uxIndex);
+			if (dd_coroutine_run_ticks(uxIndex) >= dd_coroutine_job(uxIndex)->execution_time / portTICK_PERIOD_MS)
+			{
+				break;
+			}
+			if (new_tick == pdTRUE)
+			{
+				crDELAY(xHandle, 0);
+			}
+		}
+		dd_coroutine_job_done(uxIndex);
 	}
 
-	vTaskDelete( NULL );
+	crEND();
 }
 
+#endif /* DD_JOB_BACKEND */
+
 static void Generator_Task ( void *pvParameters )
 {
 	uint8_t task_index = 0;
 	generator_task_parameters *user_defined_tasks[3];
 	init_user_defined_task_parameters(user_defined_tasks);
-	uint16_t task_id = 0;
+	uint32_t task_id = 0;
 
 	TickType_t sleep_times[3];
 	for (int i = 0; i < 3; ++i)
@@ -192,7 +394,8 @@ static void Generator_Task ( void *pvParameters )
 	{
 		// Create dd_task
 		uint8_t cur_task_index = task_index++;
-		dd_task *cur_task = pvPortMalloc( sizeof (dd_task) );
+		queue_message *message = pvQueueAllocateBuffer(xRelease_pool_handle, portMAX_DELAY);
+		dd_task *cur_task = &message->parameters;
 		cur_task->task_id = task_id++;
 		cur_task->type = PERIODIC;
 		cur_task->release_time = xTaskGetTickCount();
@@ -201,15 +404,14 @@ static void Generator_Task ( void *pvParameters )
 		cur_task->execution_time = user_defined_tasks[cur_task_index % 3]->execution_time;
 		cur_task->t_handle = NULL;
 		sleep_times[cur_task_index % 3] = cur_task->absolute_deadline;
+		miss_report_mark_release(cur_task);
 
 		//Send message
-		queue_message *message = pvPortMalloc( sizeof(queue_message) );
 		message->type = RELEASE_DD_TASK;
-		message->parameters = cur_task;
-		if(xQueueSend(xQueue_message_handle, &message, 1000) != pdTRUE)
+		if(xQueueSendReferenceOrdered(xRelease_lane_handle, message, cur_task->absolute_deadline, 1000) != pdTRUE)
 		{
-			printf("Generator Task Failed!\n");
-			fflush(stdout);
+			vQueueReleaseBuffer(message);
+			log_printf("Generator Task Failed!\n");
 		}
 
 		// Sleep
@@ -224,333 +426,337 @@ static void Generator_Task ( void *pvParameters )
 
 static void Scheduler_Task ( void *pvParameters )
 {
-	dd_task_list *active_task_list = pvPortMalloc( sizeof(dd_task_list));
-	memset( active_task_list, 0, sizeof(dd_task_list));
-	active_task_list = NULL;
-
-	dd_task_list *completed_task_list = pvPortMalloc( sizeof(dd_task_list));
-	memset( completed_task_list, 0, sizeof(dd_task_list));
-	completed_task_list = NULL;
+	scheduler_state state;
+	memset( &state, 0, sizeof(scheduler_state));
 
-	dd_task_list *overdue_task_list = pvPortMalloc( sizeof(dd_task_list));
-	memset( overdue_task_list, 0, sizeof(dd_task_list));
-	overdue_task_list = NULL;
-
-	dd_task_list *comparison_list = pvPortMalloc( sizeof(dd_task_list));
-	memset( comparison_list, 0, sizeof(dd_task_list));
-	comparison_list = NULL;
-	queue_message *message;
-	user_defined_parameters *parameters = pvPortMalloc( sizeof(user_defined_parameters) );
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_EXECUTOR
+	dd_executor_init(&state.lists, UserDefined_Job, serve_waiting_messages, &state);
+#elif DD_JOB_BACKEND == DD_JOB_BACKEND_COROUTINE
+	dd_coroutine_init(&state.lists, UserDefined_CoRoutine);
+#endif
 
 	while (1)
 	{
-		if (xQueueReceive(xQueue_message_handle, &message, 1000) == pdPASS)
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_COROUTINE
+		// While jobs are waiting, serve one message between runs of the most
+		// urgent job, each until its next tick.  Draining the lanes could run
+		// into the next tick and start the next job a tick late.
+		if (dd_coroutine_pending() == pdTRUE)
 		{
-			switch (message->type)
-			{
-			case RELEASE_DD_TASK:
+			if (xQueueSelectFromSet(xLane_set_handle, 0) != NULL)
 			{
-				// Create new task
-				if (active_task_list != comparison_list)
-				{
-					vTaskPrioritySet(active_task_list->task.t_handle, PENDING_TASK_PRIORITY);
-				}
+				serve_message(&state);
+			}
+			dd_coroutine_run();
+			continue;
+		}
+#endif
+		if (xQueueSelectFromSet(xLane_set_handle, 1000) == NULL)
+		{
+			continue;
+		}
 
-				parameters->task_id = message->parameters->task_id;
-				parameters->execution_time = message->parameters->execution_time;
+		serve_message(&state);
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_EXECUTOR
+		// Runs the active jobs to completion, serving messages in between
+		dd_executor_dispatch();
+#elif DD_JOB_BACKEND == DD_JOB_BACKEND_COROUTINE
+		// A job just released starts at once, ahead of the messages that arrived
+		// with it
+		dd_coroutine_run();
+#endif
+	}
+}
 
-				xTaskCreate(UserDefined_Task, "UserDefined", configMINIMAL_STACK_SIZE,
-						parameters, PENDING_TASK_PRIORITY, &message->parameters->t_handle);
-				dd_task_list *new_task = pvPortMalloc( sizeof(dd_task_list));
-				new_task->task = *message->parameters;
-				new_task->next_task = NULL;
+// Handle one message after a successful select on the lane set
+static void serve_message(scheduler_state *state)
+{
+	queue_message *message;
+	enum message_type request;
 
-				dd_task_list *end_active_list = active_task_list;
-				if (active_task_list == comparison_list)
-				{
-					active_task_list = new_task;
-				}
-				else
-				{
-					while (end_active_list->next_task != NULL)
-					{
-						end_active_list = end_active_list->next_task;
-					}
-					end_active_list->next_task = new_task;
-					sort_dd_task_list(active_task_list);
-				}
+	if (receive_next_message(&message, &request) != pdPASS)
+	{
+		log_printf("Scheduler Task Failed! - Lanes empty\n");
+		return;
+	}
 
-				// Remove overdue tasks
-				while (active_task_list->task.absolute_deadline <
-						active_task_list->task.execution_time + xTaskGetTickCount())
-				{
-					dd_task_list *end_overdue_list = overdue_task_list;
-					while (end_overdue_list->next_task != NULL)
-					{
-						end_overdue_list = end_overdue_list->next_task;
-					}
-					end_overdue_list->next_task = active_task_list;
-					active_task_list = active_task_list->next_task;
-					end_overdue_list->next_task->next_task = NULL;
-
-					end_overdue_list->next_task->task.completion_time = xTaskGetTickCount();
-					vTaskDelete(end_overdue_list->next_task->task.t_handle);
-				}
+	switch (message != NULL ? message->type : request)
+	{
+	case RELEASE_DD_TASK:
+	{
+		release_message(&state->lists, message);
+		release_due_messages(&state->lists);
+		break;
+	}
 
-				if (active_task_list != comparison_list)
-				{
-					vTaskPrioritySet( active_task_list->task.t_handle, ACTIVE_TASK_PRIORITY);
-				}
-				break;
-			}
+	case COMPLETE_DD_TASK:
+	{
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_TASK
+		// A job dropped as overdue after it finished has already lost its worker
+		if (state->lists.active != NULL && state->lists.active->task.t_handle == message->parameters.t_handle)
+		{
+			complete_dd_task(&state->lists, message->parameters.completion_time);
+			retire_worker(message->parameters.t_handle);
+		}
+#endif
+		break;
+	}
 
-			case COMPLETE_DD_TASK:
-			{
-				active_task_list->task.completion_time = message->parameters->completion_time;
+	case GET_DD_TASK_STATUS:
+	{
+		// Report what changed since the previous request, in as few batches as fit
+		collect_task_deltas(&state->cursor, &state->lists, send_status_batch, NULL);
+		// Reported records go back to the job store
+		drop_reported_tasks(&state->cursor, &state->lists);
+		break;
+	}
 
-				dd_task_list *end_completed_list = completed_task_list;
-				if (completed_task_list == comparison_list)
-				{
-					completed_task_list = active_task_list;
-					active_task_list = active_task_list->next_task;
-					completed_task_list->next_task = NULL;
-				}
-				else
-				{
-					while (end_completed_list->next_task != NULL)
-					{
-						end_completed_list = end_completed_list->next_task;
-					}
-					end_completed_list->next_task = active_task_list;
-					active_task_list = active_task_list->next_task;
-					end_completed_list->next_task->next_task = NULL;
-				}
+	default:
+	{
+		log_printf("Message type error in Scheduler Task!\n");
+	}
+	}
 
-				if (active_task_list != comparison_list)
-				{
-					vTaskPrioritySet( active_task_list->task.t_handle, ACTIVE_TASK_PRIORITY);
-				}
+	// The lists keep their own copy of the task, so the message can go
+	if (message != NULL)
+	{
+		vQueueReleaseBuffer(message);
+	}
+}
 
-				break;
-			}
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_EXECUTOR
 
-			case GET_ACTIVE_DD_TASK_LIST:
-			{
-				// Send active task list via queue
-				if(xQueueSend(xQueue_monitor_handle, &active_task_list, 3000) != pdTRUE)
-				{
-					printf("Generator Task Failed!\n");
-					fflush(stdout);
-				}
-				break;
-			}
+// The executor's poll, called from preemption points
+static void serve_waiting_messages(void *context)
+{
+	while (xQueueSelectFromSet(xLane_set_handle, 0) != NULL)
+	{
+		serve_message((scheduler_state *) context);
+	}
+}
 
-			case GET_COMPLETED_DD_TASK_LIST:
-			{
-				// Send completed task list via queue
-				if(xQueueSend(xQueue_monitor_handle, &completed_task_list, 3000) != pdTRUE)
-				{
-					printf("Generator Task Failed!\n");
-					fflush(stdout);
-				}
-				break;
-			}
+#endif /* DD_JOB_BACKEND */
 
-			case GET_OVERDUE_DD_TASK_LIST:
-			{
-				// Send overdue task list via queue
-				if(xQueueSend(xQueue_monitor_handle, &overdue_task_list, 3000) != pdTRUE)
-				{
-					printf("Generator Task Failed!\n");
-					fflush(stdout);
-				}
-				break;
-			}
+// Take one message from the most urgent non-empty lane.  Each message in a
+// lane has one entry in the set, so after a successful select some lane holds
+// a message even if it is not the one the set reported.  Data messages are
+// returned in message, control requests by value in request.
+static BaseType_t receive_next_message(queue_message **message, enum message_type *request)
+{
+	*message = NULL;
 
-			default:
-			{
-				printf("Message type error in Scheduler Task!\n");
-				fflush(stdout);
-			}
-			}
-		}
+	if (xQueueReceiveReference(xComplete_lane_handle, (void **) message, 0) == pdPASS)
+	{
+		return pdPASS;
 	}
+	if (xQueueReceive(xControl_lane_handle, request, 0) == pdPASS)
+	{
+		return pdPASS;
+	}
+	return xQueueReceiveReference(xRelease_lane_handle, (void **) message, 0);
 }
 
-static void Monitor_Task ( void *pvParameters )
+#if DD_JOB_BACKEND == DD_JOB_BACKEND_TASK
+
+// Start a worker for a release message and add the job to the lists
+static void release_message(dd_task_lists *lists, queue_message *message)
 {
-	dd_task_list *active_task_list;
-	dd_task_list *completed_task_list;
-	dd_task_list *overdue_task_list;
+	worker_slot *worker = take_worker_slot(lists);
 
-	queue_message *active_message = pvPortMalloc( sizeof(queue_message) );
-	memset( active_message, 0, sizeof(queue_message));
+	if (worker == NULL)
+	{
+		log_printf("Scheduler Task Failed! - No free worker\n");
+		return;
+	}
 
-	active_message->type = GET_ACTIVE_DD_TASK_LIST;
+	worker->parameters.task_id = message->parameters.task_id;
+	worker->parameters.execution_time = message->parameters.execution_time;
 
-	queue_message *overdue_message = pvPortMalloc( sizeof(queue_message) );
-	memset( overdue_message, 0, sizeof(queue_message));
-	overdue_message->type = GET_OVERDUE_DD_TASK_LIST;
+	// The worker runs below the Scheduler, so t_handle is set before it reads it
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	worker->t_handle = xTaskCreateStatic(UserDefined_Task, "UserDefined", WORKER_STACK_SIZE,
+			worker, PENDING_TASK_PRIORITY, worker->stack, &worker->tcb);
+#else
+	if (xTaskCreate(UserDefined_Task, "UserDefined", WORKER_STACK_SIZE,
+			worker, PENDING_TASK_PRIORITY, &worker->t_handle) != pdPASS)
+	{
+		worker->t_handle = NULL;
+		log_printf("Scheduler Task Failed! - Create worker\n");
+		return;
+	}
+#endif
+	message->parameters.t_handle = worker->t_handle;
 
-	queue_message *completed_message = pvPortMalloc( sizeof(queue_message) );
-	memset( completed_message, 0, sizeof(queue_message));
-	completed_message->type = GET_COMPLETED_DD_TASK_LIST;
+	if (release_dd_task(lists, &message->parameters) != pdTRUE)
+	{
+		retire_worker(worker->t_handle);
+		log_printf("Scheduler Task Failed! - Job store full\n");
+	}
+}
 
-	while (1)
+// A slot is free when its task was never started, was retired on completion or
+// was deleted by release_dd_task() along with an overdue job
+static worker_slot *take_worker_slot(const dd_task_lists *lists)
+{
+	for (uint32_t i = 0; i < WORKER_POOL_SIZE; i++)
 	{
-		// Active queue
-		if(xQueueSend(xQueue_message_handle, &active_message, 1000) != pdTRUE)
-		{
-			printf("Monitor Task Failed! - Send active\n");
-			fflush(stdout);
-		}
-		if (xQueueReceive(xQueue_monitor_handle, &active_task_list, 1000) != pdPASS)
-		{
-			printf("Monitor Task Failed! - Receive active\n");
-			fflush(stdout);
-		}
+		const dd_task_list *job = lists->active;
 
-		// Completed queue
-		if(xQueueSend(xQueue_message_handle, &completed_message, 1000) != pdTRUE)
+		while (job != NULL && job->task.t_handle != workers[i].t_handle)
 		{
-			printf("Monitor Task Failed! - Send Completed\n");
-			fflush(stdout);
+			job = job->next_task;
 		}
-		if (xQueueReceive(xQueue_monitor_handle, &completed_task_list, 1000) != pdPASS)
+		if (workers[i].t_handle == NULL || job == NULL)
 		{
-			printf("Monitor Task Failed! - receive completed\n");
-			fflush(stdout);
+			workers[i].t_handle = NULL;
+			return &workers[i];
 		}
+	}
+	return NULL;
+}
 
-		// Overdue queue
-		if(xQueueSend(xQueue_message_handle, &overdue_message, 1000) != pdTRUE)
-		{
-			printf("Monitor Task Failed! - send overdue\n");
-			fflush(stdout);
-		}
-		if (xQueueReceive(xQueue_monitor_handle, &overdue_task_list, 1000) != pdPASS)
+// Delete a worker whose job is no longer active and free its slot
+static void retire_worker(TaskHandle_t t_handle)
+{
+	if (t_handle == NULL)
+	{
+		return;
+	}
+
+	// A worker deleted while holding a completion buffer would leak it
+	vQueueReclaimBuffers(xComplete_pool_handle, t_handle);
+	vTaskDelete(t_handle);
+	for (uint32_t i = 0; i < WORKER_POOL_SIZE; i++)
+	{
+		if (workers[i].t_handle == t_handle)
 		{
-			printf("Monitor Task Failed - overdue task list receive\n");
-			fflush(stdout);
+			workers[i].t_handle = NULL;
 		}
-
-		output_task_lists(active_task_list, completed_task_list, overdue_task_list);
-
-		vTaskDelay(MONITOR_PERIOD_MS / portTICK_PERIOD_MS);
 	}
 }
 
-void output_task_lists(dd_task_list *active_task_list, dd_task_list *completed_task_list, dd_task_list *overdue_task_list)
-{
-	dd_task_list *cur_elem;
-	uint16_t counter = 0;
+#elif DD_JOB_BACKEND == DD_JOB_BACKEND_EXECUTOR
 
-	printf("ACTIVE LIST\n");
-	cur_elem = active_task_list;
-	while (cur_elem != NULL)
+// The job only needs its record, the executor runs it from the lists
+static void release_message(dd_task_lists *lists, queue_message *message)
+{
+	if (release_dd_task(lists, &message->parameters) != pdTRUE)
 	{
-		counter++;
-		printf("Task ID: %d, ", cur_elem->task.task_id);
-		fflush(stdout);
-		printf("Release time: %d, ", cur_elem->task.release_time);
-		fflush(stdout);
-		printf("Absolute deadline: %d, ", cur_elem->task.absolute_deadline);
-		fflush(stdout);
-		printf("Completion time: %d\n", cur_elem->task.completion_time);
-		fflush(stdout);
-		cur_elem = cur_elem->next_task;
+		log_printf("Scheduler Task Failed! - Job store full\n");
 	}
-	printf("Number active tasks: %d\n\n", counter);
-	fflush(stdout);
+}
 
-	counter = 0;
-	printf("COMPLETED LIST\n");
-	fflush(stdout);
-	cur_elem = completed_task_list;
-	while (cur_elem != NULL)
+#else
+
+// Hand the job to a co-routine before adding it to the lists, which may drop
+// it at once
+static void release_message(dd_task_lists *lists, queue_message *message)
+{
+	if (dd_coroutine_release(&message->parameters) != pdTRUE)
 	{
-		counter++;
-		printf("Task ID: %d, ", cur_elem->task.task_id);
-		fflush(stdout);
-		printf("Release time: %d, ", cur_elem->task.release_time);
-		fflush(stdout);
-		printf("Absolute deadline: %d, ", cur_elem->task.absolute_deadline);
-		fflush(stdout);
-		printf("Completion time: %d\n", cur_elem->task.completion_time);
-		fflush(stdout);
-		cur_elem = cur_elem->next_task;
+		log_printf("Scheduler Task Failed! - No free co-routine\n");
+		return;
 	}
-	printf("Number completed tasks: %d\n\n", counter);
-	fflush(stdout);
 
-	counter = 0;
-	printf("OVERDUE LIST\n");
-	fflush(stdout);
-	if (overdue_task_list != NULL)
+	if (release_dd_task(lists, &message->parameters) != pdTRUE)
 	{
-		cur_elem = overdue_task_list;
-		while (cur_elem != NULL)
-		{
-			counter++;
-			printf("Task ID: %d, ", cur_elem->task.task_id);
-			fflush(stdout);
-			printf("Release time: %d, ", cur_elem->task.release_time);
-			fflush(stdout);
-			printf("Absolute deadline: %d, ", cur_elem->task.absolute_deadline);
-			fflush(stdout);
-			printf("Completion time: %d\n", cur_elem->task.completion_time);
-			fflush(stdout);
-			cur_elem = cur_elem->next_task;
-		}
+		dd_coroutine_job_dropped(message->parameters.task_id);
+		log_printf("Scheduler Task Failed! - Job store full\n");
 	}
-	printf("Number overdue tasks: %d\n", counter);
-	fflush(stdout);
 }
 
-void sort_dd_task_list(dd_task_list *task_list)
+#endif /* DD_JOB_BACKEND */
+
+// Release the other pending tasks whose deadlines fall within the horizon in
+// one pass.  The set still holds an entry for each of them, consumed here.
+static void release_due_messages(dd_task_lists *lists)
 {
-	uint8_t swapped;
-	dd_task_list *ptr1;
-	dd_task_list *lptr = NULL;
+	queue_message *messages[RELEASE_BATCH_MAX];
+	UBaseType_t count = uxQueueReceiveReferenceBelow(xRelease_lane_handle, (void **) messages,
+			RELEASE_BATCH_MAX, xTaskGetTickCount() + RELEASE_BATCH_HORIZON);
 
-	// Check for empty list
-	if (task_list == NULL)
+	for (UBaseType_t i = 0; i < count; i++)
 	{
-		return;
+		release_message(lists, messages[i]);
+		vQueueReleaseBuffer(messages[i]);
+		xQueueSelectFromSet(xLane_set_handle, 0);
 	}
+}
 
-	do
-	{
-		swapped = 0;
-		ptr1 = task_list;
+static void Monitor_Task ( void *pvParameters )
+{
+	// Too large for the task stack
+	static dd_status_batch batch;
+	cpu_stats_sample cpu;
 
-		while (ptr1->next_task != lptr)
+	cpu_stats_start();
+	miss_report_start();
+	stack_stats_start();
+
+	while (1)
+	{
+		// One lock for the whole report rather than one per frame
+		output_lock();
+		if(send_request(GET_DD_TASK_STATUS, 1000) != pdTRUE)
 		{
-			if (ptr1->task.absolute_deadline > ptr1->next_task->task.absolute_deadline)
+			log_printf("Monitor Task Failed! - Send status\n");
+		}
+		else
+		{
+			// Only what changed since the previous period is reported
+			do
 			{
-				swap_nodes(ptr1, ptr1->next_task);
-				swapped = 1;
+				if (xMessageBufferReceive(xStatus_buffer_handle, &batch, sizeof(dd_status_batch), 1000) == 0)
+				{
+					log_printf("Monitor Task Failed! - Receive status\n");
+					break;
+				}
+				output_status_batch(&batch);
 			}
-			ptr1 = ptr1->next_task;
+			while (!batch.final);
 		}
-		lptr = ptr1;
+
+		output_miss_reports();
+		cpu_stats_take_sample(&cpu);
+		output_cpu_stats(&cpu);
+		output_stack_stats();
+		output_critical_stats();
+		trace_update();
+#if MONITOR_TELEMETRY == 1
+		// Text reports keep the snapshots in RAM, for a debugger to read
+		trace_flush();
+#endif
+		output_unlock();
+
+		vTaskDelay(MONITOR_PERIOD_MS / portTICK_PERIOD_MS);
 	}
-	while(swapped);
 }
 
-void swap_nodes(dd_task_list *a, dd_task_list *b)
+// Send a request with no parameters to the Scheduler on the control lane.
+// Requests are copied, so they never wait for a buffer from a data pool.
+static BaseType_t send_request(enum message_type type, TickType_t ticks_to_wait)
 {
-	dd_task *temp = malloc (sizeof (dd_task) );
-	*temp = (a->task);
-	a->task = b->task;
-	b->task = *temp;
+	return xQueueSend(xControl_lane_handle, &type, ticks_to_wait);
+}
+
+// Pass a status batch to the Monitor in a single message buffer write
+static void send_status_batch(const dd_status_batch *batch, size_t length, void *context)
+{
+	( void ) context;
+
+	if (xMessageBufferSend(xStatus_buffer_handle, batch, length, 3000) != length)
+	{
+		log_printf("Scheduler Task Failed! - Send status\n");
+	}
 }
 
 void init_user_defined_task_parameters(generator_task_parameters *user_defined_tasks[3])
 {
-	user_defined_tasks[0] = malloc (sizeof(generator_task_parameters));
-	user_defined_tasks[1] = malloc (sizeof(generator_task_parameters));
-	user_defined_tasks[2] = malloc (sizeof(generator_task_parameters));
+	static generator_task_parameters parameters[3];
+
+	user_defined_tasks[0] = &parameters[0];
+	user_defined_tasks[1] = &parameters[1];
+	user_defined_tasks[2] = &parameters[2];
 	user_defined_tasks[0]->execution_time = TASK1_EXECUTION_TIME;
 	user_defined_tasks[0]->period = TASK1_PERIOD;
 	user_defined_tasks[1]->execution_time = TASK2_EXECUTION_TIME;
@@ -612,11 +818,42 @@ volatile size_t xFreeStackSpace;
 }
 /*-----------------------------------------------------------*/
 
+#if configSUPPORT_STATIC_ALLOCATION == 1
+
+void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize )
+{
+static StaticTask_t xIdleTaskTCB;
+static StackType_t uxIdleTaskStack[ configMINIMAL_STACK_SIZE ];
+
+	/* With static allocation the kernel asks for the idle task's memory
+	rather than allocating it. */
+	*ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+	*ppxIdleTaskStackBuffer = uxIdleTaskStack;
+	*pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationGetTimerTaskMemory( StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize )
+{
+static StaticTask_t xTimerTaskTCB;
+static StackType_t uxTimerTaskStack[ configTIMER_TASK_STACK_DEPTH ];
+
+	/* As above, for the timer service task. */
+	*ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+	*ppxTimerTaskStackBuffer = uxTimerTaskStack;
+	*pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+
 static void prvSetupHardware( void )
 {
+#ifndef HOST_BUILD
 	/* Ensure all priority bits are assigned as preemption priority bits.
 	http://www.freertos.org/RTOS-Cortex-M3-M4.html */
 	NVIC_SetPriorityGrouping( 0 );
+#endif
 
 	vApplicationIdleHook();
 
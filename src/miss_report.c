@@ -0,0 +1,432 @@
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+/* Kernel includes. */
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+
+#include "dd_scheduler.h"
+#include "miss_report.h"
+#include "spsc_ring.h"
+#include "telemetry.h"
+
+#if configUSE_MISS_REPORT == 1
+
+// The accounts as the Generator released a job
+typedef struct miss_report_mark
+{
+	uint32_t task_id;
+	uint32_t released_at;
+	uint32_t account_base[MISS_REPORT_ACCOUNT_COUNT];
+	uint32_t job_base[MISS_REPORT_JOBS];
+	uint32_t generation[MISS_REPORT_JOBS];
+} miss_report_mark;
+
+// A job followed from its admission, or the last job that had the entry
+typedef struct miss_report_job
+{
+	TaskHandle_t t_handle;		/* NULL once the job is done */
+	uint32_t task_id;
+	uint32_t run_time;			/* Charged by the switch hook */
+	uint32_t generation;		/* Changed each time the entry is reused */
+	uint32_t released_at;
+	uint32_t admitted_at;
+	uint32_t admission;			/* Order of admission, for take_job() */
+	uint32_t account_base[MISS_REPORT_ACCOUNT_COUNT];
+	uint32_t job_base[MISS_REPORT_JOBS];	/* Other entries' run time at release */
+	uint32_t other_jobs;		/* Run time of the jobs credited so far */
+	uint32_t interferer_id[MISS_REPORT_INTERFERERS];
+	uint32_t interferer_time[MISS_REPORT_INTERFERERS];
+} miss_report_job;
+
+// Written by the hooks, read by the Scheduler and the Generator
+static miss_report_job jobs[MISS_REPORT_JOBS];
+static uint32_t admissions;
+
+// Written by the Generator, read by the Scheduler
+static miss_report_mark marks[MISS_REPORT_MARKS];
+static TaskHandle_t tracked_tasks[MISS_REPORT_ACCOUNT_COUNT];
+static uint32_t accounts[MISS_REPORT_ACCOUNT_COUNT];
+static uint32_t switched_in_at;
+static uint32_t isr_entered_at;
+static uint32_t isr_pending;
+
+// From the Scheduler to the Monitor
+static spsc_ring reports;
+static miss_report report_storage[MISS_REPORT_RING_SIZE];
+static uint32_t skipped_reports;
+
+static uint32_t *account_of(void *task);
+static uint32_t read_accounts(uint32_t accounts_now[MISS_REPORT_ACCOUNT_COUNT], enum miss_report_account caller);
+static miss_report_job *find_job(TaskHandle_t t_handle);
+static miss_report_job *take_job(void);
+static void credit(miss_report_job *job, uint32_t task_id, uint32_t run_time);
+static void output_miss_report(const miss_report *report);
+
+void miss_report_init(void)
+{
+	spsc_ring_init(&reports, report_storage, MISS_REPORT_RING_SIZE, sizeof(miss_report), NULL);
+}
+
+// Only the Scheduler and idle accounts need a task, others count as system
+void miss_report_track(enum miss_report_account account, void *handle)
+{
+	configASSERT(account < MISS_REPORT_ACCOUNT_COUNT);
+	tracked_tasks[account] = handle;
+}
+
+// Adds the idle task, from a running task
+void miss_report_start(void)
+{
+	miss_report_track(MISS_REPORT_IDLE, xTaskGetIdleTaskHandle());
+}
+
+// Called by the Generator before it sends the job, so the window starts at its
+// release rather than when the Scheduler gets to it
+void miss_report_mark_release(const dd_task *task)
+{
+	miss_report_mark *mark = &marks[task->task_id % MISS_REPORT_MARKS];
+
+	mark->released_at = read_accounts(mark->account_base, MISS_REPORT_SYSTEM);
+	for (uint32_t i = 0; i < MISS_REPORT_JOBS; i++)
+	{
+		mark->generation[i] = __atomic_load_n(&jobs[i].generation, __ATOMIC_ACQUIRE);
+		mark->job_base[i] = jobs[i].run_time;
+	}
+	mark->task_id = task->task_id;
+}
+
+// Called by the Scheduler once the job is in the lists
+void miss_report_release(const dd_task *task)
+{
+	const miss_report_mark *mark = &marks[task->task_id % MISS_REPORT_MARKS];
+	uint32_t accounts_now[MISS_REPORT_ACCOUNT_COUNT];
+	uint32_t now = read_accounts(accounts_now, MISS_REPORT_SCHEDULER);
+	miss_report_job *job;
+	uint32_t entry;
+
+	// Jobs run by the executor have no task to charge their run time to
+	if (task->t_handle == NULL)
+	{
+		return;
+	}
+
+	// More jobs than entries, this one is not followed
+	job = take_job();
+	if (job == NULL)
+	{
+		return;
+	}
+	entry = (uint32_t) (job - jobs);
+
+	// What the entry's previous job ran goes to the jobs it overlapped
+	for (uint32_t i = 0; i < MISS_REPORT_JOBS; i++)
+	{
+		if (i != entry && jobs[i].t_handle != NULL)
+		{
+			credit(&jobs[i], job->task_id, job->run_time - jobs[i].job_base[entry]);
+			jobs[i].job_base[entry] = 0;
+		}
+	}
+
+	memset(job->interferer_id, 0, sizeof(job->interferer_id));
+	memset(job->interferer_time, 0, sizeof(job->interferer_time));
+	job->other_jobs = 0;
+	job->admitted_at = now;
+
+	if (mark->task_id == task->task_id)
+	{
+		// Entries reused while the job waited lose their previous job's share,
+		// except this one, whose previous job is known
+		if (mark->generation[entry] == job->generation)
+		{
+			credit(job, job->task_id, job->run_time - mark->job_base[entry]);
+		}
+		for (uint32_t i = 0; i < MISS_REPORT_JOBS; i++)
+		{
+			job->job_base[i] = mark->generation[i] == jobs[i].generation ? mark->job_base[i] : 0;
+		}
+		job->released_at = mark->released_at;
+		memcpy(job->account_base, mark->account_base, sizeof(job->account_base));
+	}
+	else
+	{
+		for (uint32_t i = 0; i < MISS_REPORT_JOBS; i++)
+		{
+			job->job_base[i] = jobs[i].run_time;
+		}
+		job->released_at = now;
+		memcpy(job->account_base, accounts_now, sizeof(job->account_base));
+	}
+
+	// A mark taken from here on sees the new job at 0
+	job->task_id = task->task_id;
+	job->run_time = 0;
+	job->job_base[entry] = 0;
+	__atomic_store_n(&job->generation, job->generation + 1, __ATOMIC_RELEASE);
+	job->t_handle = task->t_handle;
+}
+
+void miss_report_complete(const dd_task *task)
+{
+	miss_report_job *job = find_job(task->t_handle);
+
+	if (job != NULL)
+	{
+		job->t_handle = NULL;
+	}
+}
+
+// Called by the Scheduler as it drops the job, before its worker is deleted
+void miss_report_overdue(const dd_task *task)
+{
+	// Too large for the Scheduler's stack
+	static miss_report report;
+	uint32_t accounts_now[MISS_REPORT_ACCOUNT_COUNT];
+	uint32_t now = read_accounts(accounts_now, MISS_REPORT_SCHEDULER);
+	miss_report_job *job = find_job(task->t_handle);
+
+	if (job == NULL)
+	{
+		return;
+	}
+
+	for (uint32_t i = 0; i < MISS_REPORT_JOBS; i++)
+	{
+		if (&jobs[i] != job)
+		{
+			credit(job, jobs[i].task_id, jobs[i].run_time - job->job_base[i]);
+		}
+	}
+
+	report.task_id = task->task_id;
+	report.window = now - job->released_at;
+	report.waiting = job->admitted_at - job->released_at;
+	report.run_time[MISS_REPORT_OWN] = job->run_time;
+	report.run_time[MISS_REPORT_JOBS_RUN] = job->other_jobs;
+	for (uint32_t i = MISS_REPORT_SCHEDULER; i < MISS_REPORT_ACCOUNT_COUNT; i++)
+	{
+		report.run_time[i] = accounts_now[i] - job->account_base[i];
+	}
+	memcpy(report.interferer_id, job->interferer_id, sizeof(report.interferer_id));
+	memcpy(report.interferer_time, job->interferer_time, sizeof(report.interferer_time));
+	report.skipped = skipped_reports;
+	job->t_handle = NULL;
+
+	// The Monitor has fallen behind, the next report carries the count
+	if (spsc_ring_push(&reports, &report) == pdTRUE)
+	{
+		skipped_reports = 0;
+	}
+	else
+	{
+		skipped_reports++;
+	}
+}
+
+// Called by the kernel with the outgoing task in pxCurrentTCB
+void miss_report_switched_out(void *task)
+{
+	uint32_t now = portGET_RUN_TIME_COUNTER_VALUE();
+
+	*account_of(task) += now - switched_in_at - isr_pending;
+	switched_in_at = now;
+	isr_pending = 0;
+}
+
+void miss_report_isr_enter(void)
+{
+	isr_entered_at = portGET_RUN_TIME_COUNTER_VALUE();
+}
+
+// The interrupted task is charged the whole interval at its switch, less this
+void miss_report_isr_exit(void)
+{
+	uint32_t run_time = portGET_RUN_TIME_COUNTER_VALUE() - isr_entered_at;
+
+	accounts[MISS_REPORT_ISR] += run_time;
+	isr_pending += run_time;
+}
+
+static uint32_t *account_of(void *task)
+{
+	for (uint32_t i = 0; i < MISS_REPORT_JOBS; i++)
+	{
+		if (jobs[i].t_handle == task)
+		{
+			return &jobs[i].run_time;
+		}
+	}
+
+	if (task == tracked_tasks[MISS_REPORT_SCHEDULER])
+	{
+		return &accounts[MISS_REPORT_SCHEDULER];
+	}
+	if (task == tracked_tasks[MISS_REPORT_IDLE])
+	{
+		return &accounts[MISS_REPORT_IDLE];
+	}
+	return &accounts[MISS_REPORT_SYSTEM];
+}
+
+// The caller's current run is not charged yet, so it is added to its account
+static uint32_t read_accounts(uint32_t accounts_now[MISS_REPORT_ACCOUNT_COUNT], enum miss_report_account caller)
+{
+	uint32_t now = portGET_RUN_TIME_COUNTER_VALUE();
+
+	memcpy(accounts_now, accounts, sizeof(accounts));
+	accounts_now[caller] += now - switched_in_at - isr_pending;
+	return now;
+}
+
+static miss_report_job *find_job(TaskHandle_t t_handle)
+{
+	// Free entries have no task either
+	if (t_handle == NULL)
+	{
+		return NULL;
+	}
+
+	for (uint32_t i = 0; i < MISS_REPORT_JOBS; i++)
+	{
+		if (jobs[i].t_handle == t_handle)
+		{
+			return &jobs[i];
+		}
+	}
+	return NULL;
+}
+
+// Takes the free entry admitted longest ago, so entries are rarely reused
+// while a job that overlapped their previous job still waits for admission
+static miss_report_job *take_job(void)
+{
+	miss_report_job *oldest = NULL;
+
+	for (uint32_t i = 0; i < MISS_REPORT_JOBS; i++)
+	{
+		if (jobs[i].t_handle == NULL &&
+				(oldest == NULL || jobs[i].admission < oldest->admission))
+		{
+			oldest = &jobs[i];
+		}
+	}
+	if (oldest != NULL)
+	{
+		oldest->admission = ++admissions;
+	}
+	return oldest;
+}
+
+// Adds another job's run time, keeping the longest ones in order
+static void credit(miss_report_job *job, uint32_t task_id, uint32_t run_time)
+{
+	uint32_t i;
+
+	if (run_time == 0)
+	{
+		return;
+	}
+	job->other_jobs += run_time;
+
+	for (i = MISS_REPORT_INTERFERERS; i > 0 && job->interferer_time[i - 1] < run_time; i--)
+	{
+		if (i < MISS_REPORT_INTERFERERS)
+		{
+			job->interferer_id[i] = job->interferer_id[i - 1];
+			job->interferer_time[i] = job->interferer_time[i - 1];
+		}
+	}
+	if (i < MISS_REPORT_INTERFERERS)
+	{
+		job->interferer_id[i] = task_id;
+		job->interferer_time[i] = run_time;
+	}
+}
+
+void output_miss_reports(void)
+{
+	// Too large for the Monitor's stack
+	static miss_report report;
+
+	if (spsc_ring_count(&reports) == 0)
+	{
+		return;
+	}
+
+#if MONITOR_TELEMETRY == 1
+	telemetry_begin(xTaskGetTickCount());
+#endif
+	while (spsc_ring_pop(&reports, &report) == pdTRUE)
+	{
+		output_miss_report(&report);
+	}
+#if MONITOR_TELEMETRY == 1
+	telemetry_flush();
+#else
+	printf("\n");
+	fflush(stdout);
+#endif
+}
+
+#if MONITOR_TELEMETRY == 1
+
+static void output_miss_report(const miss_report *report)
+{
+	telemetry_add_miss(report);
+}
+
+#else
+
+static void output_interferers(const miss_report *report);
+
+static uint16_t window_permille(const miss_report *report, uint32_t run_time)
+{
+	if (report->window == 0)
+	{
+		return 0;
+	}
+	return (uint16_t) min((uint64_t) run_time * 1000 / report->window, 1000);
+}
+
+static void output_miss_report(const miss_report *report)
+{
+	static const char * const account_names[] = { "Own", "Jobs", "Scheduler", "System", "ISR", "Idle" };
+	uint16_t permille = window_permille(report, report->waiting);
+
+	printf("MISS Task ID: %u, Waiting: %u.%u%%", report->task_id, permille / 10, permille % 10);
+	for (uint32_t i = 0; i < MISS_REPORT_ACCOUNT_COUNT; i++)
+	{
+		permille = window_permille(report, report->run_time[i]);
+		printf(", %s: %u.%u%%", account_names[i], permille / 10, permille % 10);
+		if (i == MISS_REPORT_JOBS_RUN)
+		{
+			output_interferers(report);
+		}
+	}
+	if (report->skipped != 0)
+	{
+		printf(", Not reported before it: %u", report->skipped);
+	}
+	printf("\n");
+}
+
+// The jobs that ran ahead of it, longest first
+static void output_interferers(const miss_report *report)
+{
+	for (uint32_t i = 0; i < MISS_REPORT_INTERFERERS && report->interferer_time[i] != 0; i++)
+	{
+		uint16_t permille = window_permille(report, report->interferer_time[i]);
+
+		printf("%s%u: %u.%u%%", i == 0 ? " (" : ", ", report->interferer_id[i], permille / 10, permille % 10);
+	}
+	if (report->interferer_time[0] != 0)
+	{
+		printf(")");
+	}
+}
+
+#endif /* MONITOR_TELEMETRY */
+
+#endif /* configUSE_MISS_REPORT */
@@ -0,0 +1,95 @@
+#ifndef MISS_REPORT_H
+#define MISS_REPORT_H
+
+#include <stdint.h>
+
+/*
+ * Root cause of each deadline miss.
+ *
+ * The kernel's switch-out hook charges the time since the previous switch to
+ * the task leaving the CPU: to the job it runs if it is a worker, otherwise to
+ * the Scheduler, the idle task or the other system tasks.  The tick interrupt
+ * is timed on its own and its time is taken off the task it interrupted.  This
+ * costs a run time clock read and a lookup among MISS_REPORT_JOBS + 2 handles
+ * per switch, and two clock reads per tick, with no critical section.
+ *
+ * The Generator notes the accounts as it releases each job, and the Scheduler
+ * takes the note over when it admits the job.  When the Scheduler drops a job
+ * as overdue, the growth of each account since the release says where the
+ * job's window went: to the job itself, to other jobs (naming the
+ * MISS_REPORT_INTERFERERS that took the most), to the Scheduler, to the other
+ * system tasks, to the tick interrupt or to idle.  The report also gives how
+ * much of the window passed before the Scheduler admitted the job.  It goes
+ * through a lock-free ring to the Monitor, which prints it or sends it as
+ * telemetry.
+ *
+ * This header is included by FreeRTOSConfig.h, so it only depends on the
+ * definitions made there.  Accounts are read without locking, so a switch or
+ * tick that lands while the Scheduler reads them can shift one interval
+ * between categories.
+ */
+
+#define MISS_REPORT_JOBS 8			/* At least the Scheduler's worker pool */
+#define MISS_REPORT_MARKS 16			/* At least the release message pool */
+#define MISS_REPORT_INTERFERERS 3
+#define MISS_REPORT_RING_SIZE 4		/* Must be a power of two */
+
+enum miss_report_account
+{
+	MISS_REPORT_OWN,				/* The missed job's own run time */
+	MISS_REPORT_JOBS_RUN,			/* Other jobs */
+	MISS_REPORT_SCHEDULER,
+	MISS_REPORT_SYSTEM,				/* Generator, Monitor, Log and timer tasks */
+	MISS_REPORT_ISR,
+	MISS_REPORT_IDLE,
+	MISS_REPORT_ACCOUNT_COUNT
+};
+
+// Run times are in run time clock counts, from the job's release to its drop
+typedef struct miss_report
+{
+	uint32_t task_id;
+	uint32_t window;
+	uint32_t waiting;		/* Part of the window before the job was admitted */
+	uint32_t run_time[MISS_REPORT_ACCOUNT_COUNT];
+	uint32_t interferer_id[MISS_REPORT_INTERFERERS];		/* Longest first */
+	uint32_t interferer_time[MISS_REPORT_INTERFERERS];		/* 0 when unused */
+	uint32_t skipped;		/* Misses not reported since the previous report */
+} miss_report;
+
+#if configUSE_MISS_REPORT == 1
+
+struct dd_task;
+
+// Function declarations
+void miss_report_init(void);
+void miss_report_track(enum miss_report_account account, void *handle);
+void miss_report_start(void);
+void miss_report_mark_release(const struct dd_task *task);
+void miss_report_release(const struct dd_task *task);
+void miss_report_complete(const struct dd_task *task);
+void miss_report_overdue(const struct dd_task *task);
+void output_miss_reports(void);
+void miss_report_switched_out(void *task);
+void miss_report_isr_enter(void);
+void miss_report_isr_exit(void);
+
+/* Kernel hooks. */
+#define traceTASK_SWITCHED_OUT() miss_report_switched_out(pxCurrentTCB)
+#define traceISR_ENTER() miss_report_isr_enter()
+#define traceISR_EXIT() miss_report_isr_exit()
+
+#else
+
+#define miss_report_init()
+#define miss_report_track(account, handle)
+#define miss_report_start()
+#define miss_report_mark_release(task)
+#define miss_report_release(task)
+#define miss_report_complete(task)
+#define miss_report_overdue(task)
+#define output_miss_reports()
+
+#endif /* configUSE_MISS_REPORT */
+
+#endif /* MISS_REPORT_H */
@@ -0,0 +1,44 @@
+/* Standard includes. */
+#include <stdint.h>
+/* Kernel includes. */
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+#include "../FreeRTOS_Source/include/semphr.h"
+
+#include "output.h"
+
+/* External function prototypes (defined in syscalls.c) */
+extern int _write(int fd, char *str, int len);
+
+static SemaphoreHandle_t output_mutex;
+#if configSUPPORT_STATIC_ALLOCATION == 1
+static StaticSemaphore_t output_mutex_buffer;
+#endif
+
+void output_init(void)
+{
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	output_mutex = xSemaphoreCreateRecursiveMutexStatic(&output_mutex_buffer);
+#else
+	output_mutex = xSemaphoreCreateRecursiveMutex();
+#endif
+	configASSERT(output_mutex != NULL);
+}
+
+void output_lock(void)
+{
+	xSemaphoreTakeRecursive(output_mutex, portMAX_DELAY);
+}
+
+void output_unlock(void)
+{
+	xSemaphoreGiveRecursive(output_mutex);
+}
+
+// Writes one frame without letting another frame into the middle of it
+void output_write(const void *data, uint32_t length)
+{
+	output_lock();
+	_write(1, (char *) data, (int) length);
+	output_unlock();
+}
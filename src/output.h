@@ -0,0 +1,30 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdint.h>
+
+/*
+ * Shared writer for the binary streams.
+ *
+ * The deferred log (Log task), the telemetry and the kernel trace (both from
+ * the Monitor) share one output port, and none of their frames can be told
+ * apart once another has been written into the middle of it.  Each of them
+ * writes whole frames with output_write(), which holds a mutex for the
+ * duration of the _write().  The mutex has priority inheritance, so the
+ * Monitor waits at most for one log batch of LOG_DRAIN_BUFFER_SIZE bytes.
+ *
+ * A task writing many frames in a row can hold the mutex across all of them
+ * with output_lock() and output_unlock().  The mutex is recursive, so the
+ * frames' own output_write() calls then cost no kernel calls.
+ *
+ * output_init() must be called before the scheduler starts.  Only tasks may
+ * call the other functions.
+ */
+
+// Function declarations
+void output_init(void);
+void output_lock(void);
+void output_unlock(void);
+void output_write(const void *data, uint32_t length);
+
+#endif /* OUTPUT_H */
@@ -0,0 +1,192 @@
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+/* Kernel includes. */
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+
+#include "spsc_ring.h"
+
+static BaseType_t push_item(spsc_ring *ring, const void *item);
+
+/*
+ * Ordering primitives.  Acquire and release are enough for the indices.  The
+ * wakeup handshake also needs a store-load order on both sides: the consumer
+ * publishes waiting before it reads head, the producer publishes head before
+ * it takes waiting.  Whichever runs second sees the other's write, so a push
+ * cannot slip between the consumer's last check and its block.
+ */
+#if defined(__ARM_ARCH_7EM__)
+
+static inline void ring_fence(void)
+{
+	__asm volatile ("dmb" ::: "memory");
+}
+
+static inline uint32_t ring_load_acquire(spsc_index *index)
+{
+	uint32_t value = *index;
+	ring_fence();
+	return value;
+}
+
+static inline void ring_store_release(spsc_index *index, uint32_t value)
+{
+	ring_fence();
+	*index = value;
+}
+
+// Retried until no exception or other access broke the exclusive monitor
+static inline uint32_t ring_exchange(spsc_index *index, uint32_t value)
+{
+	uint32_t previous, failed;
+
+	ring_fence();
+	do
+	{
+		__asm volatile ("ldrex %0, [%1]" : "=r" (previous) : "r" (index) : "memory");
+		__asm volatile ("strex %0, %2, [%1]" : "=&r" (failed) : "r" (index), "r" (value) : "memory");
+	}
+	while (failed != 0);
+	ring_fence();
+	return previous;
+}
+
+#else
+
+static inline void ring_fence(void)
+{
+	atomic_thread_fence(memory_order_seq_cst);
+}
+
+static inline uint32_t ring_load_acquire(spsc_index *index)
+{
+	return atomic_load_explicit(index, memory_order_acquire);
+}
+
+static inline void ring_store_release(spsc_index *index, uint32_t value)
+{
+	atomic_store_explicit(index, value, memory_order_release);
+}
+
+static inline uint32_t ring_exchange(spsc_index *index, uint32_t value)
+{
+	return atomic_exchange_explicit(index, value, memory_order_seq_cst);
+}
+
+#endif
+
+void spsc_ring_init(spsc_ring *ring, void *storage, uint32_t capacity, size_t item_size, TaskHandle_t consumer)
+{
+	configASSERT(capacity != 0 && (capacity & (capacity - 1)) == 0);
+
+	ring->consumer = consumer;
+	ring->mask = capacity - 1;
+	ring->item_size = item_size;
+	ring->storage = storage;
+	ring_store_release(&ring->head, 0);
+	ring_store_release(&ring->tail, 0);
+	ring_store_release(&ring->waiting, 0);
+}
+
+BaseType_t spsc_ring_push(spsc_ring *ring, const void *item)
+{
+	if (push_item(ring, item) != pdTRUE)
+	{
+		return pdFALSE;
+	}
+
+	// Only a consumer that is about to block pays for the notification
+	if (ring->consumer != NULL)
+	{
+		ring_fence();
+		if (ring_exchange(&ring->waiting, 0) != 0)
+		{
+			xTaskNotifyGive(ring->consumer);
+		}
+	}
+	return pdTRUE;
+}
+
+BaseType_t spsc_ring_push_from_isr(spsc_ring *ring, const void *item, BaseType_t *higher_priority_task_woken)
+{
+	if (push_item(ring, item) != pdTRUE)
+	{
+		return pdFALSE;
+	}
+
+	if (ring->consumer != NULL)
+	{
+		ring_fence();
+		if (ring_exchange(&ring->waiting, 0) != 0)
+		{
+			vTaskNotifyGiveFromISR(ring->consumer, higher_priority_task_woken);
+		}
+	}
+	return pdTRUE;
+}
+
+static BaseType_t push_item(spsc_ring *ring, const void *item)
+{
+	uint32_t head = ring_load_acquire(&ring->head);
+
+	// The consumer's tail only moves forward, a stale value is merely cautious
+	if (head - ring_load_acquire(&ring->tail) > ring->mask)
+	{
+		return pdFALSE;
+	}
+
+	memcpy(&ring->storage[(head & ring->mask) * ring->item_size], item, ring->item_size);
+	ring_store_release(&ring->head, head + 1);
+	return pdTRUE;
+}
+
+BaseType_t spsc_ring_pop(spsc_ring *ring, void *item)
+{
+	uint32_t tail = ring_load_acquire(&ring->tail);
+
+	if (tail == ring_load_acquire(&ring->head))
+	{
+		return pdFALSE;
+	}
+
+	memcpy(item, &ring->storage[(tail & ring->mask) * ring->item_size], ring->item_size);
+	ring_store_release(&ring->tail, tail + 1);
+	return pdTRUE;
+}
+
+// Returns pdTRUE once an item is ready, pdFALSE if the wait timed out
+BaseType_t spsc_ring_wait(spsc_ring *ring, TickType_t ticks_to_wait)
+{
+	TimeOut_t timeout;
+
+	configASSERT(ring->consumer != NULL);
+	vTaskSetTimeOutState(&timeout);
+
+	while (ring_load_acquire(&ring->tail) == ring_load_acquire(&ring->head))
+	{
+		ring_exchange(&ring->waiting, 1);
+		ring_fence();
+
+		// A push between the first check and arming the flag is caught here
+		if (ring_load_acquire(&ring->tail) != ring_load_acquire(&ring->head))
+		{
+			ring_exchange(&ring->waiting, 0);
+			break;
+		}
+
+		// A stale notification from an earlier push only causes another pass
+		ulTaskNotifyTake(pdTRUE, ticks_to_wait);
+		ring_exchange(&ring->waiting, 0);
+		if (xTaskCheckForTimeOut(&timeout, &ticks_to_wait) != pdFALSE)
+		{
+			return ring_load_acquire(&ring->tail) != ring_load_acquire(&ring->head);
+		}
+	}
+	return pdTRUE;
+}
+
+uint32_t spsc_ring_count(spsc_ring *ring)
+{
+	return ring_load_acquire(&ring->head) - ring_load_acquire(&ring->tail);
+}
@@ -0,0 +1,53 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+
+/*
+ * Lock-free single-producer/single-consumer ring of fixed-size items.
+ *
+ * The producer only writes head and the consumer only writes tail, so moving
+ * an item costs one copy and two ordered index accesses: no critical section,
+ * no waiter list and no yield.  Exactly one task or interrupt may push and
+ * exactly one task may pop; paths with several producers stay on queues.
+ *
+ * Waking the consumer is optional.  When the ring is given a consumer task,
+ * spsc_ring_wait() arms a flag and blocks on the task's notification, and the
+ * next push clears the flag and notifies.  The flag is the only word both
+ * sides modify, so it is updated with LDREX/STREX on the Cortex-M4 and with
+ * C11 atomics on host builds.  A consumer that waits on a ring must not use
+ * its task notification for anything else.
+ *
+ * Indices are free running and the capacity must be a power of two.
+ */
+
+#if defined(__ARM_ARCH_7EM__)
+typedef volatile uint32_t spsc_index;
+#else
+#include <stdatomic.h>
+typedef atomic_uint_least32_t spsc_index;
+#endif
+
+typedef struct spsc_ring
+{
+	spsc_index head;
+	spsc_index tail;
+	spsc_index waiting;
+	TaskHandle_t consumer;
+	uint32_t mask;
+	size_t item_size;
+	uint8_t *storage;
+} spsc_ring;
+
+// Function declarations
+void spsc_ring_init(spsc_ring *ring, void *storage, uint32_t capacity, size_t item_size, TaskHandle_t consumer);
+BaseType_t spsc_ring_push(spsc_ring *ring, const void *item);
+BaseType_t spsc_ring_push_from_isr(spsc_ring *ring, const void *item, BaseType_t *higher_priority_task_woken);
+BaseType_t spsc_ring_pop(spsc_ring *ring, void *item);
+BaseType_t spsc_ring_wait(spsc_ring *ring, TickType_t ticks_to_wait);
+uint32_t spsc_ring_count(spsc_ring *ring);
+
+#endif /* SPSC_RING_H */
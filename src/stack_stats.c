@@ -0,0 +1,151 @@
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+/* Kernel includes. */
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+#include "../FreeRTOS_Source/include/timers.h"
+
+#include "dd_scheduler.h"
+#include "stack_stats.h"
+#include "telemetry.h"
+#include "trace.h"
+
+#if configUSE_STACK_STATS == 1
+
+static TaskHandle_t tracked_tasks[STACK_STATS_WORKERS];
+// The workers' entry is written by the delete hook, in the Scheduler
+static stack_stats_entry entries[STACK_STATS_TASK_COUNT];
+static uint32_t reported_peak[STACK_STATS_TASK_COUNT];
+
+static uint32_t take_sample(stack_stats_entry *entry, TaskHandle_t handle);
+static void output_stack_entry(enum stack_stats_task task, const stack_stats_entry *entry);
+
+// Handles may be registered before the scheduler starts.  The workers take a
+// NULL handle, as every task deleted without one of its own counts as one.
+void stack_stats_track(enum stack_stats_task task, void *handle, uint32_t size)
+{
+	configASSERT(task < STACK_STATS_TASK_COUNT);
+	if (task < STACK_STATS_WORKERS)
+	{
+		tracked_tasks[task] = handle;
+	}
+	entries[task].size = size;
+}
+
+// Adds the kernel's own tasks, from a running task
+void stack_stats_start(void)
+{
+	stack_stats_track(STACK_STATS_TIMER, xTimerGetTimerDaemonTaskHandle(), configTIMER_TASK_STACK_DEPTH);
+	stack_stats_track(STACK_STATS_IDLE, xTaskGetIdleTaskHandle(), configMINIMAL_STACK_SIZE);
+}
+
+// Called by vTaskDelete() while the task's stack is still there
+void stack_stats_task_deleted(void *task)
+{
+	stack_stats_entry *entry = &entries[STACK_STATS_WORKERS];
+	uint32_t used;
+
+	for (uint32_t i = 0; i < STACK_STATS_WORKERS; i++)
+	{
+		if (tracked_tasks[i] == task)
+		{
+			entry = &entries[i];
+		}
+	}
+	used = take_sample(entry, task);
+	entry->samples++;
+#if configUSE_KERNEL_TRACE == 1
+	trace_write(TRACE_TASK_DELETE, TRACE_OBJECT(task), used);
+#else
+	( void ) used;
+#endif
+}
+
+// Reads the long-lived tasks and reports if any peak grew since the last report
+void output_stack_stats(void)
+{
+	BaseType_t grown = pdFALSE;
+
+	for (uint32_t i = 0; i < STACK_STATS_WORKERS; i++)
+	{
+		if (tracked_tasks[i] != NULL)
+		{
+			take_sample(&entries[i], tracked_tasks[i]);
+		}
+	}
+
+	for (uint32_t i = 0; i < STACK_STATS_TASK_COUNT; i++)
+	{
+		uint32_t peak = entries[i].peak;
+		uint32_t with_margin = peak + (peak * STACK_STATS_MARGIN_PERCENT + 99) / 100;
+
+		entries[i].suggested = (with_margin + STACK_STATS_ROUNDING - 1) / STACK_STATS_ROUNDING * STACK_STATS_ROUNDING;
+		if (peak != reported_peak[i])
+		{
+			reported_peak[i] = peak;
+			grown = pdTRUE;
+		}
+	}
+	if (grown == pdFALSE)
+	{
+		return;
+	}
+
+#if MONITOR_TELEMETRY == 1
+	telemetry_begin(xTaskGetTickCount());
+#else
+	printf("STACK");
+#endif
+	for (uint32_t i = 0; i < STACK_STATS_TASK_COUNT; i++)
+	{
+		// Tasks that were never created have no size
+		if (entries[i].size != 0)
+		{
+			output_stack_entry((enum stack_stats_task) i, &entries[i]);
+		}
+	}
+#if MONITOR_TELEMETRY == 1
+	telemetry_flush();
+#else
+	printf("\n\n");
+	fflush(stdout);
+#endif
+}
+
+static uint32_t take_sample(stack_stats_entry *entry, TaskHandle_t handle)
+{
+	uint32_t unused = (uint32_t) uxTaskGetStackHighWaterMark(handle);
+	uint32_t used = entry->size > unused ? entry->size - unused : 0;
+
+	if (used > entry->peak)
+	{
+		entry->peak = used;
+	}
+	return used;
+}
+
+#if MONITOR_TELEMETRY == 1
+
+static void output_stack_entry(enum stack_stats_task task, const stack_stats_entry *entry)
+{
+	telemetry_add_stack(task, entry);
+}
+
+#else
+
+static void output_stack_entry(enum stack_stats_task task, const stack_stats_entry *entry)
+{
+	static const char * const task_names[] = { "Scheduler", "Generator", "Monitor", "Log", "Timer", "Idle", "Workers" };
+
+	printf("%s %s: %u/%u words", task == 0 ? "" : ",", task_names[task], entry->peak, entry->size);
+	if (task == STACK_STATS_WORKERS)
+	{
+		printf(" over %u jobs", entry->samples);
+	}
+	printf(" (suggest %u)", entry->suggested);
+}
+
+#endif /* MONITOR_TELEMETRY */
+
+#endif /* configUSE_STACK_STATS */
@@ -0,0 +1,72 @@
+#ifndef STACK_STATS_H
+#define STACK_STATS_H
+
+#include <stdint.h>
+
+/*
+ * Stack high-water marks and suggested stack sizes.
+ *
+ * The kernel fills every new stack with a known byte, and
+ * uxTaskGetStackHighWaterMark() counts how much of the fill is left.  The
+ * Monitor reads the mark of each long-lived task every period.  Worker tasks
+ * are read by the kernel's delete hook just before the Scheduler deletes them,
+ * whether the job completed or was dropped, and all of them are kept as one
+ * peak since every worker runs the same code on the same stack size.
+ *
+ * Each time a peak grows the Monitor reports, per task, the peak and the size
+ * in words, and a suggested size: the peak plus STACK_STATS_MARGIN_PERCENT,
+ * rounded up to STACK_STATS_ROUNDING words.  Peaks only cover the paths taken
+ * so far, so run the longest soak test available before shrinking a stack.
+ * The host ports run tasks on their own thread or fiber stacks, so the figures
+ * only mean something on the target.
+ *
+ * This header is included by FreeRTOSConfig.h, so it only depends on the
+ * definitions made there.
+ */
+
+#define STACK_STATS_MARGIN_PERCENT 25
+#define STACK_STATS_ROUNDING 8			/* Words, keeps stacks 8 byte aligned */
+
+enum stack_stats_task
+{
+	STACK_STATS_SCHEDULER,
+	STACK_STATS_GENERATOR,
+	STACK_STATS_MONITOR,
+	STACK_STATS_LOG,
+	STACK_STATS_TIMER,
+	STACK_STATS_IDLE,
+	STACK_STATS_WORKERS,
+	STACK_STATS_TASK_COUNT
+};
+
+// Sizes are in stack words
+typedef struct stack_stats_entry
+{
+	uint32_t size;
+	uint32_t peak;			/* Most words ever used */
+	uint32_t suggested;
+	uint32_t samples;		/* Deleted tasks measured, for the workers */
+} stack_stats_entry;
+
+#if configUSE_STACK_STATS == 1
+
+// Function declarations
+void stack_stats_track(enum stack_stats_task task, void *handle, uint32_t size);
+void stack_stats_start(void);
+void stack_stats_task_deleted(void *task);
+void output_stack_stats(void);
+
+/* Kernel hook.  It replaces the trace's, and records the delete in the trace
+itself with the words the task used. */
+#undef traceTASK_DELETE
+#define traceTASK_DELETE( pxTaskToDelete ) stack_stats_task_deleted( pxTaskToDelete )
+
+#else
+
+#define stack_stats_track(task, handle, size)
+#define stack_stats_start()
+#define output_stack_stats()
+
+#endif /* configUSE_STACK_STATS */
+
+#endif /* STACK_STATS_H */
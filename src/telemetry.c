@@ -0,0 +1,132 @@
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+#include "output.h"
+#include "telemetry.h"
+
+static uint8_t frame_buffer[TELEMETRY_FRAME_SIZE];
+static uint16_t frame_length;
+static uint16_t frame_records;
+static uint16_t frame_sequence;
+static uint8_t frame_type;
+static uint32_t frame_tick;
+
+static void add_record(uint8_t type, const void *record, uint16_t size);
+
+// Start a new monitor report, all frames it produces carry the same tick
+void telemetry_begin(TickType_t tick)
+{
+	telemetry_flush();
+	frame_tick = tick;
+}
+
+void telemetry_add_job(enum telemetry_job_state state, const dd_task *task)
+{
+	telemetry_job_record record;
+
+	record.task_id = task->task_id;
+	record.release_time = task->release_time;
+	record.absolute_deadline = task->absolute_deadline;
+	record.completion_time = task->completion_time;
+	record.state = (uint8_t) state;
+	record.type = (uint8_t) task->type;
+	add_record(TELEMETRY_FRAME_JOBS, &record, sizeof(record));
+}
+
+void telemetry_add_summary(const telemetry_summary_record *summary)
+{
+	add_record(TELEMETRY_FRAME_SUMMARY, summary, sizeof(*summary));
+}
+
+void telemetry_add_cpu(enum cpu_stats_task task, uint32_t run_time, uint16_t permille)
+{
+	telemetry_cpu_record record;
+
+	record.run_time = run_time;
+	record.permille = permille;
+	record.task = (uint8_t) task;
+	add_record(TELEMETRY_FRAME_CPU, &record, sizeof(record));
+}
+
+void telemetry_add_miss(const miss_report *report)
+{
+	telemetry_miss_record record;
+
+	record.task_id = report->task_id;
+	record.window = report->window;
+	record.waiting = report->waiting;
+	memcpy(record.run_time, report->run_time, sizeof(record.run_time));
+	memcpy(record.interferer_id, report->interferer_id, sizeof(record.interferer_id));
+	memcpy(record.interferer_time, report->interferer_time, sizeof(record.interferer_time));
+	record.skipped = (uint16_t) min(report->skipped, UINT16_MAX);
+	add_record(TELEMETRY_FRAME_MISS, &record, sizeof(record));
+}
+
+void telemetry_add_stack(enum stack_stats_task task, const stack_stats_entry *entry)
+{
+	telemetry_stack_record record;
+
+	record.samples = entry->samples;
+	record.size = (uint16_t) min(entry->size, UINT16_MAX);
+	record.peak = (uint16_t) min(entry->peak, UINT16_MAX);
+	record.suggested = (uint16_t) min(entry->suggested, UINT16_MAX);
+	record.task = (uint8_t) task;
+	add_record(TELEMETRY_FRAME_STACK, &record, sizeof(record));
+}
+
+void telemetry_add_critical(enum critical_stats_kind kind, const critical_stats_entry *entry)
+{
+	telemetry_critical_record record;
+
+	record.count = entry->count;
+	record.mean = entry->count == 0 ? 0 : (uint32_t) (entry->total / entry->count);
+	record.max = entry->max;
+	record.max_site = (uint32_t) entry->max_site;
+	memcpy(record.histogram, entry->histogram, sizeof(record.histogram));
+	record.kind = (uint8_t) kind;
+	add_record(TELEMETRY_FRAME_CRITICAL, &record, sizeof(record));
+}
+
+// Send the pending frame, if any, in a single write
+void telemetry_flush(void)
+{
+	telemetry_frame_header header;
+
+	if (frame_records == 0)
+	{
+		return;
+	}
+
+	header.magic[0] = TELEMETRY_MAGIC_0;
+	header.magic[1] = TELEMETRY_MAGIC_1;
+	header.version = TELEMETRY_VERSION;
+	header.type = frame_type;
+	header.sequence = frame_sequence++;
+	header.record_count = frame_records;
+	header.tick = frame_tick;
+	memcpy(frame_buffer, &header, sizeof(header));
+
+	output_write(frame_buffer, frame_length);
+	frame_records = 0;
+}
+
+static void add_record(uint8_t type, const void *record, uint16_t size)
+{
+	// A frame holds records of a single type
+	if (frame_records != 0 &&
+			(frame_type != type || frame_length + size > TELEMETRY_FRAME_SIZE))
+	{
+		telemetry_flush();
+	}
+
+	if (frame_records == 0)
+	{
+		frame_type = type;
+		frame_length = sizeof(telemetry_frame_header);
+	}
+
+	memcpy(&frame_buffer[frame_length], record, size);
+	frame_length += size;
+	frame_records++;
+}
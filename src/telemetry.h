@@ -0,0 +1,123 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include "cpu_stats.h"
+#include "critical_stats.h"
+#include "dd_scheduler.h"
+#include "miss_report.h"
+#include "stack_stats.h"
+
+/*
+ * Binary monitor telemetry.
+ *
+ * Records are collected in a RAM frame and sent with a single _write() when
+ * the frame fills up or telemetry_flush() is called.  Every frame is a
+ * telemetry_frame_header followed by record_count fixed-size records whose
+ * layout depends on the frame type.  All fields are little endian.
+ * tools/telemetry_decode.py renders a captured stream as text or CSV.
+ */
+
+#define TELEMETRY_MAGIC_0 'D'
+#define TELEMETRY_MAGIC_1 'T'
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_FRAME_SIZE 256
+
+enum telemetry_frame_type
+{
+	TELEMETRY_FRAME_JOBS = 1,
+	TELEMETRY_FRAME_SUMMARY = 2,
+	TELEMETRY_FRAME_CPU = 3,
+	TELEMETRY_FRAME_MISS = 4,
+	TELEMETRY_FRAME_STACK = 5,
+	TELEMETRY_FRAME_CRITICAL = 6
+};
+
+enum telemetry_job_state
+{
+	TELEMETRY_JOB_ACTIVE = 0,
+	TELEMETRY_JOB_COMPLETED = 1,
+	TELEMETRY_JOB_OVERDUE = 2
+};
+
+typedef struct __attribute__((packed)) telemetry_frame_header
+{
+	uint8_t magic[2];
+	uint8_t version;
+	uint8_t type;
+	uint16_t sequence;
+	uint16_t record_count;
+	uint32_t tick;
+} telemetry_frame_header;
+
+typedef struct __attribute__((packed)) telemetry_job_record
+{
+	uint32_t task_id;
+	uint32_t release_time;
+	uint32_t absolute_deadline;
+	uint32_t completion_time;
+	uint8_t state;
+	uint8_t type;
+} telemetry_job_record;
+
+typedef struct __attribute__((packed)) telemetry_summary_record
+{
+	uint32_t active_count;
+	uint32_t completed_count;
+	uint32_t overdue_count;
+	uint32_t worst_lateness;
+	uint16_t miss_permille;
+} telemetry_summary_record;
+
+// Run time of one task over the last Monitor period, in run time clock counts
+typedef struct __attribute__((packed)) telemetry_cpu_record
+{
+	uint32_t run_time;
+	uint16_t permille;
+	uint8_t task;
+} telemetry_cpu_record;
+
+// Where a missed job's window went, in run time clock counts
+typedef struct __attribute__((packed)) telemetry_miss_record
+{
+	uint32_t task_id;
+	uint32_t window;
+	uint32_t waiting;
+	uint32_t run_time[MISS_REPORT_ACCOUNT_COUNT];
+	uint32_t interferer_id[MISS_REPORT_INTERFERERS];
+	uint32_t interferer_time[MISS_REPORT_INTERFERERS];
+	uint16_t skipped;
+} telemetry_miss_record;
+
+// Stack use of one task, or of all workers, in stack words
+typedef struct __attribute__((packed)) telemetry_stack_record
+{
+	uint32_t samples;
+	uint16_t size;
+	uint16_t peak;
+	uint16_t suggested;
+	uint8_t task;
+} telemetry_stack_record;
+
+// Masked or suspended intervals of one kind since start, in run time clock counts
+typedef struct __attribute__((packed)) telemetry_critical_record
+{
+	uint32_t count;
+	uint32_t mean;
+	uint32_t max;
+	uint32_t max_site;
+	uint32_t histogram[CRITICAL_STATS_BUCKETS];
+	uint8_t kind;
+} telemetry_critical_record;
+
+// Function declarations
+void telemetry_begin(TickType_t tick);
+void telemetry_add_job(enum telemetry_job_state state, const dd_task *task);
+void telemetry_add_summary(const telemetry_summary_record *summary);
+void telemetry_add_cpu(enum cpu_stats_task task, uint32_t run_time, uint16_t permille);
+void telemetry_add_miss(const miss_report *report);
+void telemetry_add_stack(enum stack_stats_task task, const stack_stats_entry *entry);
+void telemetry_add_critical(enum critical_stats_kind kind, const critical_stats_entry *entry);
+void telemetry_flush(void);
+
+#endif /* TELEMETRY_H */
@@ -24,6 +24,10 @@
 **                Note:
 **                Character padding is not supported
 **
+**                The format string is parsed once and output is produced
+**                into a fixed-size stack chunk that is written out each time
+**                it fills, so stack use is bounded.
+**
 **  Environment : Atollic TrueSTUDIO
 **
 **  Distribution: The file is distributed as is, without any warranty
@@ -41,19 +45,103 @@
 */
 
 /* Includes */
+#include <limits.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 
 /* External function prototypes (defined in syscalls.c) */
 extern int _write(int fd, char *str, int len);
 
+/* Private defines */
+/* Output is formatted into a stack chunk of this size and written out each
+   time it fills, so stack use does not depend on the format or arguments.
+   It holds the longest line the application prints, so a line is written
+   in one piece and another task's output cannot land in the middle of it */
+#define TS_CHUNK_SIZE 128
+/* Longest conversion: 10 decimal digits of a 32 bit integer */
+#define TS_ITOA_SIZE 12
+
+/* Private types */
+typedef struct ts_output
+{
+	char *buf;
+	int pos;
+	int size;
+	int fd;
+	int total;
+} ts_output;
+
+/* Private variables */
+static const char ts_digit_pairs[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+static const char ts_hex_digits[] = "0123456789ABCDEF";
+
 /* Private function prototypes */
 void ts_itoa(char **buf, unsigned int d, int base);
 int ts_formatstring(char *buf, const char *fmt, va_list va);
-int ts_formatlength(const char *fmt, va_list va);
+static int ts_utoa(char *end, unsigned int d, int base);
+static void ts_flush(ts_output *out);
+static void ts_putc(ts_output *out, char c);
+static void ts_puts(ts_output *out, const char *str, int len);
+static void ts_format(ts_output *out, const char *fmt, va_list va);
 
 /* Private functions */
 
+/**
+**---------------------------------------------------------------------------
+**  Abstract: Convert integer to ascii, writing backwards from end.
+**            Decimal conversion emits two digits per step from a table,
+**            hexadecimal conversion uses shifts only.
+**  Returns:  Number of characters written
+**---------------------------------------------------------------------------
+*/
+static int ts_utoa(char *end, unsigned int d, int base)
+{
+	char *start = end;
+
+	if (base == 16)
+	{
+		do
+		{
+			*--start = ts_hex_digits[d & 0xF];
+			d >>= 4;
+		} while (d != 0);
+		return (int)(end - start);
+	}
+
+	while (d >= 100)
+	{
+		unsigned int q = d / 100;
+		unsigned int r = d - q * 100;
+		start -= 2;
+		start[0] = ts_digit_pairs[2 * r];
+		start[1] = ts_digit_pairs[2 * r + 1];
+		d = q;
+	}
+	if (d >= 10)
+	{
+		start -= 2;
+		start[0] = ts_digit_pairs[2 * d];
+		start[1] = ts_digit_pairs[2 * d + 1];
+	}
+	else
+	{
+		*--start = (char)('0' + d);
+	}
+	return (int)(end - start);
+}
+
 /**
 **---------------------------------------------------------------------------
 **  Abstract: Convert integer to ascii
@@ -62,140 +150,153 @@ int ts_formatlength(const char *fmt, va_list va);
 */
 void ts_itoa(char **buf, unsigned int d, int base)
 {
-	int div = 1;
-	while (d/div >= base)
-		div *= base;
+	char digits[TS_ITOA_SIZE];
+	int length = ts_utoa(digits + TS_ITOA_SIZE, d, base);
 
-	while (div != 0)
-	{
-		int num = d/div;
-		d = d%div;
-		div /= base;
-		if (num > 9)
-			*((*buf)++) = (num-10) + 'A';
-		else
-			*((*buf)++) = num + '0';
-	}
+	memcpy(*buf, digits + TS_ITOA_SIZE - length, length);
+	*buf += length;
 }
 
 /**
 **---------------------------------------------------------------------------
-**  Abstract: Writes arguments va to buffer buf according to format fmt
-**  Returns:  Length of string
+**  Abstract: Writes the buffered chunk to the output file descriptor.
+**            String outputs (fd < 0) are never flushed.
+**  Returns:  void
 **---------------------------------------------------------------------------
 */
-int ts_formatstring(char *buf, const char *fmt, va_list va)
+static void ts_flush(ts_output *out)
 {
-	char *start_buf = buf;
-	while(*fmt)
+	if (out->fd >= 0 && out->pos > 0)
 	{
-		/* Character needs formating? */
-		if (*fmt == '%')
-		{
-			switch (*(++fmt))
-			{
-			  case 'c':
-				*buf++ = va_arg(va, int);
-				break;
-			  case 'd':
-			  case 'i':
-				{
-					signed int val = va_arg(va, signed int);
-					if (val < 0)
-					{
-						val *= -1;
-						*buf++ = '-';
-					}
-					ts_itoa(&buf, val, 10);
-				}
-				break;
-			  case 's':
-				{
-					char * arg = va_arg(va, char *);
-					while (*arg)
-					{
-						*buf++ = *arg++;
-					}
-				}
-				break;
-			  case 'u':
-					ts_itoa(&buf, va_arg(va, unsigned int), 10);
-				break;
-			  case 'x':
-			  case 'X':
-					ts_itoa(&buf, va_arg(va, int), 16);
-				break;
-			  case '%':
-				  *buf++ = '%';
-				  break;
-			}
-			fmt++;
-		}
-		/* Else just copy */
-		else
+		int written = _write(out->fd, out->buf, out->pos);
+		if (written > 0)
 		{
-			*buf++ = *fmt++;
+			out->total += written;
 		}
+		out->pos = 0;
 	}
-	*buf = 0;
+}
 
-	return (int)(buf - start_buf);
+static void ts_putc(ts_output *out, char c)
+{
+	if (out->pos == out->size)
+	{
+		ts_flush(out);
+	}
+	out->buf[out->pos++] = c;
 }
 
+static void ts_puts(ts_output *out, const char *str, int len)
+{
+	while (len > 0)
+	{
+		int space = out->size - out->pos;
+		int count = (len < space) ? len : space;
+
+		if (count == 0)
+		{
+			ts_flush(out);
+			continue;
+		}
+		memcpy(out->buf + out->pos, str, count);
+		out->pos += count;
+		str += count;
+		len -= count;
+	}
+}
 
 /**
 **---------------------------------------------------------------------------
-**  Abstract: Calculate maximum length of the resulting string from the
-**            format string and va_list va
-**  Returns:  Maximum length
+**  Abstract: Formats arguments va to out according to fmt in a single pass
+**  Returns:  void
 **---------------------------------------------------------------------------
 */
-int ts_formatlength(const char *fmt, va_list va)
+static void ts_format(ts_output *out, const char *fmt, va_list va)
 {
-	int length = 0;
+	char digits[TS_ITOA_SIZE];
+	char *end = digits + TS_ITOA_SIZE;
+
 	while (*fmt)
 	{
-		if (*fmt == '%')
+		/* Copy the literal run up to the next conversion in one go */
+		const char *literal = fmt;
+		while (*fmt && *fmt != '%')
 		{
-			++fmt;
-			switch (*fmt)
-			{
-			  case 'c':
-		  		  va_arg(va, int);
-				  ++length;
-				  break;
-			  case 'd':
-			  case 'i':
-			  case 'u':
-				  /* 32 bits integer is max 11 characters with minus sign */
-				  length += 11;
-				  va_arg(va, int);
-				  break;
-			  case 's':
-			  	  {
-			  		  char * str = va_arg(va, char *);
-			  		  while (*str++)
-			  			  ++length;
-			  	  }
-				  break;
-			  case 'x':
-			  case 'X':
-				  /* 32 bits integer as hex is max 8 characters */
-				  length += 8;
-				  va_arg(va, unsigned int);
-				  break;
-			  default:
-				  ++length;
-				  break;
-			}
+			fmt++;
+		}
+		if (fmt != literal)
+		{
+			ts_puts(out, literal, (int)(fmt - literal));
+		}
+		if (*fmt == 0)
+		{
+			break;
 		}
-		else
+
+		/* Character needs formating */
+		switch (*(++fmt))
 		{
-			++length;
+		  case 'c':
+			ts_putc(out, (char)va_arg(va, int));
+			break;
+		  case 'd':
+		  case 'i':
+			{
+				signed int val = va_arg(va, signed int);
+				unsigned int mag = (unsigned int)val;
+				int length;
+				if (val < 0)
+				{
+					mag = 0U - mag;
+					ts_putc(out, '-');
+				}
+				length = ts_utoa(end, mag, 10);
+				ts_puts(out, end - length, length);
+			}
+			break;
+		  case 's':
+			{
+				const char *arg = va_arg(va, char *);
+				ts_puts(out, arg, (int)strlen(arg));
+			}
+			break;
+		  case 'u':
+			{
+				int length = ts_utoa(end, va_arg(va, unsigned int), 10);
+				ts_puts(out, end - length, length);
+			}
+			break;
+		  case 'x':
+		  case 'X':
+			{
+				int length = ts_utoa(end, va_arg(va, unsigned int), 16);
+				ts_puts(out, end - length, length);
+			}
+			break;
+		  case '%':
+			ts_putc(out, '%');
+			break;
+		  case 0:
+			/* Trailing '%' */
+			return;
 		}
-		++fmt;
+		fmt++;
 	}
-	return length;
+}
+
+/**
+**---------------------------------------------------------------------------
+**  Abstract: Writes arguments va to buffer buf according to format fmt
+**  Returns:  Length of string
+**---------------------------------------------------------------------------
+*/
+int ts_formatstring(char *buf, const char *fmt, va_list va)
+{
+	ts_output out = { buf, 0, INT_MAX, -1, 0 };
+
+	ts_format(&out, fmt, va);
+	buf[out.pos] = 0;
+	return out.pos;
 }
 
 /**
@@ -224,19 +325,14 @@ int sprintf(char *buf, const char *fmt, ...)
 */
 int fprintf(FILE * stream, const char *fmt, ...)
 {
-	int length = 0;
+	char chunk[TS_CHUNK_SIZE];
+	ts_output out = { chunk, 0, TS_CHUNK_SIZE, stream->_file, 0 };
 	va_list va;
 	va_start(va, fmt);
-	length = ts_formatlength(fmt, va);
+	ts_format(&out, fmt, va);
 	va_end(va);
-	{
-		char buf[length];
-		va_start(va, fmt);
-		length = ts_formatstring(buf, fmt, va);
-		length = _write(stream->_file, buf, length);
-		va_end(va);
-	}
-	return length;
+	ts_flush(&out);
+	return out.total;
 }
 
 /**
@@ -249,18 +345,12 @@ int fprintf(FILE * stream, const char *fmt, ...)
 */
 int printf(const char *fmt, ...)
 {
-	int length = 0;
+	char chunk[TS_CHUNK_SIZE];
+	ts_output out = { chunk, 0, TS_CHUNK_SIZE, 1, 0 };
 	va_list va;
 	va_start(va, fmt);
-	length = ts_formatlength(fmt, va);
+	ts_format(&out, fmt, va);
 	va_end(va);
-	{
-		char buf[length];
-		va_start(va, fmt);
-		length = ts_formatstring(buf, fmt, va);
-		length = _write(1, buf, length);
-		va_end(va);
-	}
-	return length;
+	ts_flush(&out);
+	return out.total;
 }
-
@@ -0,0 +1,362 @@
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+/* Kernel includes. */
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/task.h"
+
+#include "output.h"
+#include "trace.h"
+
+#if configUSE_KERNEL_TRACE == 1
+
+#ifdef HOST_BUILD
+#define TRACE_CLOCK_HZ 1000000000UL
+#else
+#define TRACE_CLOCK_HZ configCPU_CLOCK_HZ
+#endif
+
+trace_record trace_ring[TRACE_RING_SIZE];
+uint32_t trace_head;
+
+#if TRACE_FLIGHT_RECORDER == 1
+
+enum trace_snapshot_state
+{
+	SNAPSHOT_FREE,
+	SNAPSHOT_CAPTURING,		/* Being filled by the Scheduler */
+	SNAPSHOT_WAITING,		/* Waiting for its post-trigger records */
+	SNAPSHOT_READY
+};
+
+typedef struct trace_snapshot
+{
+	uint32_t state;
+	uint32_t trigger;		/* Ring position just after the miss */
+	uint32_t task_id;
+	uint32_t missed;		/* Misses not kept since the previous snapshot */
+	uint32_t lost;			/* Post-trigger records the ring overwrote first */
+	uint32_t pre_count;
+	uint32_t count;
+	trace_record records[TRACE_SNAPSHOT_PRE + TRACE_SNAPSHOT_POST];
+} trace_snapshot;
+
+// The creation records are long gone from the ring by the time of a miss
+typedef struct trace_name_entry
+{
+	uint32_t object;
+	char name[TRACE_NAME_MAX];
+} trace_name_entry;
+
+// Slots are only taken by the Scheduler and only released by the Monitor
+static trace_snapshot snapshots[TRACE_SNAPSHOT_COUNT];
+static uint32_t missed_triggers;
+static trace_name_entry names[TRACE_NAME_TABLE_SIZE];
+static uint32_t next_name;
+
+static void trace_trigger(uint32_t task_id);
+static void send_snapshot(const trace_snapshot *snapshot);
+static void remember_name(uint32_t object, const char *name, size_t length);
+
+#else
+
+// Only used by trace_flush()
+static uint32_t trace_tail;
+
+#endif /* TRACE_FLIGHT_RECORDER */
+
+// Frame being built by frame_add()
+static uint8_t frame[sizeof(trace_frame_header) + TRACE_FRAME_RECORDS * sizeof(trace_record)]
+		__attribute__((aligned(4)));
+static uint16_t frame_records;
+static uint16_t frame_sequence;
+static uint32_t frame_dropped;
+
+static uint32_t copy_from_ring(trace_record *records, uint32_t *from, uint32_t to);
+static void frame_add(const trace_record *record);
+static void frame_send(void);
+
+// Writes the event, then the name, zero padded, in as many TRACE_NAME records as it needs
+void trace_named(uint8_t event, uint32_t object, uint32_t value, const char *name)
+{
+	size_t length = strnlen(name, TRACE_NAME_MAX);
+
+	trace_write(event, object, value);
+
+	for (size_t i = 0; i < length; i += sizeof(uint32_t))
+	{
+		uint32_t characters = 0;
+		size_t chunk = length - i < sizeof(characters) ? length - i : sizeof(characters);
+
+		memcpy(&characters, &name[i], chunk);
+		trace_write(TRACE_NAME, object, characters);
+	}
+
+#if TRACE_FLIGHT_RECORDER == 1
+	remember_name(object, name, length);
+#endif
+}
+
+// Job events come from tasks, which must not be preempted mid-record by the flush
+void trace_job(uint8_t event, uint32_t task_id, uint32_t value)
+{
+	taskENTER_CRITICAL();
+	trace_write(event, task_id, value);
+	taskEXIT_CRITICAL();
+
+#if TRACE_FLIGHT_RECORDER == 1
+	if (event == TRACE_JOB_OVERDUE)
+	{
+		trace_trigger(task_id);
+	}
+#endif
+}
+
+#if TRACE_FLIGHT_RECORDER == 1
+
+// Completes the windows whose post-trigger records have all been written
+void trace_update(void)
+{
+	for (uint32_t i = 0; i < TRACE_SNAPSHOT_COUNT; i++)
+	{
+		trace_snapshot *snapshot = &snapshots[i];
+		uint32_t from;
+
+		if (__atomic_load_n(&snapshot->state, __ATOMIC_ACQUIRE) != SNAPSHOT_WAITING ||
+				__atomic_load_n(&trace_head, __ATOMIC_ACQUIRE) - snapshot->trigger < TRACE_SNAPSHOT_POST)
+		{
+			continue;
+		}
+
+		from = snapshot->trigger;
+		snapshot->count += copy_from_ring(&snapshot->records[snapshot->count], &from,
+				snapshot->trigger + TRACE_SNAPSHOT_POST);
+		snapshot->lost = from - snapshot->trigger;
+		__atomic_store_n(&snapshot->state, SNAPSHOT_READY, __ATOMIC_RELEASE);
+	}
+}
+
+// Sends the completed windows and frees their slots
+void trace_flush(void)
+{
+	trace_update();
+
+	for (uint32_t i = 0; i < TRACE_SNAPSHOT_COUNT; i++)
+	{
+		if (__atomic_load_n(&snapshots[i].state, __ATOMIC_ACQUIRE) == SNAPSHOT_READY)
+		{
+			send_snapshot(&snapshots[i]);
+			__atomic_store_n(&snapshots[i].state, SNAPSHOT_FREE, __ATOMIC_RELEASE);
+		}
+	}
+}
+
+// Called by the Scheduler as it drops a job, with the overdue record already written
+static void trace_trigger(uint32_t task_id)
+{
+	uint32_t trigger = __atomic_load_n(&trace_head, __ATOMIC_ACQUIRE);
+	uint32_t from = trigger > TRACE_SNAPSHOT_PRE ? trigger - TRACE_SNAPSHOT_PRE : 0;
+	trace_snapshot *snapshot = NULL;
+
+	for (uint32_t i = 0; i < TRACE_SNAPSHOT_COUNT; i++)
+	{
+		uint32_t state = __atomic_load_n(&snapshots[i].state, __ATOMIC_ACQUIRE);
+
+		// A miss inside a window still being filled is already in it
+		if (state == SNAPSHOT_WAITING && trigger - snapshots[i].trigger < TRACE_SNAPSHOT_POST)
+		{
+			return;
+		}
+		if (state == SNAPSHOT_FREE && snapshot == NULL)
+		{
+			snapshot = &snapshots[i];
+		}
+	}
+
+	if (snapshot == NULL)
+	{
+		missed_triggers++;
+		return;
+	}
+
+	snapshot->state = SNAPSHOT_CAPTURING;
+	snapshot->trigger = trigger;
+	snapshot->task_id = task_id;
+	snapshot->missed = missed_triggers;
+	snapshot->lost = 0;
+	snapshot->pre_count = copy_from_ring(snapshot->records, &from, trigger);
+	snapshot->count = snapshot->pre_count;
+	missed_triggers = 0;
+	__atomic_store_n(&snapshot->state, SNAPSHOT_WAITING, __ATOMIC_RELEASE);
+}
+
+// Sends a TRACE_SNAPSHOT marker, the known names, then the window itself
+static void send_snapshot(const trace_snapshot *snapshot)
+{
+	trace_record record = { 0 };
+
+	record.timestamp = snapshot->count != 0 ? snapshot->records[0].timestamp : 0;
+	record.object = snapshot->task_id;
+	record.value = snapshot->missed;
+	record.event = TRACE_SNAPSHOT;
+	frame_add(&record);
+
+	record.timestamp = 0;
+	record.event = TRACE_NAME;
+	for (uint32_t i = 0; i < TRACE_NAME_TABLE_SIZE; i++)
+	{
+		if (names[i].object == 0)
+		{
+			continue;
+		}
+
+		record.object = names[i].object;
+		for (uint32_t j = 0; j < TRACE_NAME_MAX && names[i].name[j] != '\0'; j += sizeof(uint32_t))
+		{
+			memcpy(&record.value, &names[i].name[j], sizeof(record.value));
+			frame_add(&record);
+		}
+	}
+
+	for (uint32_t i = 0; i < snapshot->count; i++)
+	{
+		// Report the gap between the pre and post-trigger records in its own frame
+		if (i == snapshot->pre_count && snapshot->lost != 0)
+		{
+			frame_send();
+			frame_dropped = snapshot->lost;
+		}
+		frame_add(&snapshot->records[i]);
+	}
+	frame_send();
+	frame_dropped = 0;
+}
+
+// Replaces the object's entry, or the oldest one when it has none
+static void remember_name(uint32_t object, const char *name, size_t length)
+{
+	trace_name_entry *entry = NULL;
+
+	for (uint32_t i = 0; i < TRACE_NAME_TABLE_SIZE && entry == NULL; i++)
+	{
+		if (names[i].object == object)
+		{
+			entry = &names[i];
+		}
+	}
+	if (entry == NULL)
+	{
+		entry = &names[next_name];
+		next_name = (next_name + 1) % TRACE_NAME_TABLE_SIZE;
+	}
+
+	entry->object = object;
+	memset(entry->name, 0, sizeof(entry->name));
+	memcpy(entry->name, name, length);
+}
+
+#else
+
+void trace_update(void)
+{
+}
+
+// Sends every record written since the previous flush
+void trace_flush(void)
+{
+	static trace_record records[TRACE_FRAME_RECORDS];
+
+	while (1)
+	{
+		uint32_t from = trace_tail;
+		uint32_t count = copy_from_ring(records, &from, from + TRACE_FRAME_RECORDS);
+
+		if (count == 0 && from == trace_tail)
+		{
+			break;
+		}
+
+		frame_dropped += from - trace_tail;
+		trace_tail = from + count;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			frame_add(&records[i]);
+		}
+	}
+	frame_send();
+}
+
+#endif /* TRACE_FLIGHT_RECORDER */
+
+/*
+ * Copies the records from ring position from up to to, or up to the head if
+ * that comes first, and returns how many were copied.  Task level records are
+ * written with interrupts masked or the scheduler suspended, so every slot
+ * below the head is complete.  Only an interrupt can write while the copy
+ * runs, and it can only reach the copied slots by lapping the ring, in which
+ * case the copy is redone with from moved past the overwritten records.
+ */
+static uint32_t copy_from_ring(trace_record *records, uint32_t *from, uint32_t to)
+{
+	uint32_t head, count;
+
+	do
+	{
+		head = __atomic_load_n(&trace_head, __ATOMIC_ACQUIRE);
+		if ((int32_t) (head - TRACE_RING_SIZE - *from) > 0)
+		{
+			*from = head - TRACE_RING_SIZE;
+		}
+		if ((int32_t) (to - head) > 0)
+		{
+			to = head;
+		}
+
+		count = (int32_t) (to - *from) > 0 ? to - *from : 0;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			records[i] = trace_ring[(*from + i) & (TRACE_RING_SIZE - 1)];
+		}
+	}
+	while ((int32_t) (__atomic_load_n(&trace_head, __ATOMIC_ACQUIRE) - TRACE_RING_SIZE - *from) > 0);
+
+	return count;
+}
+
+static void frame_add(const trace_record *record)
+{
+	if (frame_records == TRACE_FRAME_RECORDS)
+	{
+		frame_send();
+	}
+
+	memcpy(&frame[sizeof(trace_frame_header) + frame_records * sizeof(trace_record)], record, sizeof(*record));
+	frame_records++;
+}
+
+// Sends the pending records, if any, in a single write
+static void frame_send(void)
+{
+	trace_frame_header header;
+
+	if (frame_records == 0)
+	{
+		return;
+	}
+
+	header.magic[0] = TRACE_MAGIC_0;
+	header.magic[1] = TRACE_MAGIC_1;
+	header.version = TRACE_VERSION;
+	header.record_size = sizeof(trace_record);
+	header.sequence = frame_sequence++;
+	header.record_count = frame_records;
+	header.dropped = frame_dropped;
+	header.clock_hz = TRACE_CLOCK_HZ;
+	memcpy(frame, &header, sizeof(header));
+
+	output_write(frame, sizeof(header) + frame_records * sizeof(trace_record));
+	frame_records = 0;
+	frame_dropped = 0;
+}
+
+#endif /* configUSE_KERNEL_TRACE */
@@ -0,0 +1,198 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+/*
+ * Kernel event trace.
+ *
+ * The kernel's trace hooks and the Scheduler's job events each store one
+ * fixed-size record in a RAM ring: a run time stats clock timestamp, the
+ * object involved (a task or queue address, or a job's task ID) and one value
+ * that depends on the event.  A record costs a slot claim (LDREX/STREX on the
+ * Cortex-M4, so hooks in interrupts cannot collide), a DWT cycle counter read
+ * and four stores.  The ring overwrites its oldest records when it fills.
+ *
+ * In flight recorder mode nothing is sent while things go well.  When the
+ * Scheduler drops a job as overdue, the TRACE_SNAPSHOT_PRE records before the
+ * miss are copied out of the ring at once, and trace_update() adds the
+ * TRACE_SNAPSHOT_POST records that follow once they have been written.  Each
+ * window stays in one of TRACE_SNAPSHOT_COUNT slots until trace_flush() sends
+ * it, so with nothing reading them the first misses are kept for a debugger.
+ * Misses inside a window still being filled are already covered by it, and
+ * misses while every slot is taken are only counted.  Without the flight
+ * recorder trace_flush() sends every record written since the previous flush.
+ *
+ * Either way the output is binary frames of a trace_frame_header followed by
+ * record_count records, with a count of the records the ring overwrote before
+ * they could be copied.  A snapshot starts with a TRACE_SNAPSHOT record and
+ * the names of the tasks and queues seen recently.  Names are sent as
+ * TRACE_NAME records, four characters at a time, and the stream also carries
+ * them after each creation.  tools/trace_export.py turns a capture into a
+ * Chrome/Perfetto trace.
+ *
+ * This header is included by FreeRTOSConfig.h, so it only depends on the
+ * definitions made there.  Object addresses are truncated to 32 bits on host
+ * builds.
+ */
+
+#define TRACE_RING_SIZE 1024	/* Must be a power of two */
+#define TRACE_FRAME_RECORDS 16
+#define TRACE_NAME_MAX 16
+
+// 1: keep windows of the trace around deadline misses, 0: stream all of it
+#ifndef TRACE_FLIGHT_RECORDER
+#define TRACE_FLIGHT_RECORDER 1
+#endif
+#define TRACE_SNAPSHOT_COUNT 2
+#define TRACE_SNAPSHOT_PRE 192
+#define TRACE_SNAPSHOT_POST 64
+#define TRACE_NAME_TABLE_SIZE 24
+
+#define TRACE_MAGIC_0 'D'
+#define TRACE_MAGIC_1 'R'
+#define TRACE_VERSION 1
+
+enum trace_event
+{
+	TRACE_TASK_SWITCHED_IN = 1,	/* value: priority */
+	TRACE_TASK_CREATE,			/* value: priority */
+	TRACE_TASK_DELETE,
+	TRACE_TASK_DELAY,			/* value: ticks to delay */
+	TRACE_TASK_DELAY_UNTIL,		/* value: tick to wake at */
+	TRACE_TASK_PRIORITY_SET,	/* value: new priority */
+	TRACE_TASK_PRIORITY_INHERIT,
+	TRACE_TASK_PRIORITY_DISINHERIT,
+	TRACE_TASK_SUSPEND,
+	TRACE_TASK_RESUME,
+	TRACE_TASK_RESUME_FROM_ISR,
+	TRACE_TASK_NOTIFY,			/* object: task notified */
+	TRACE_TASK_NOTIFY_FROM_ISR,
+	TRACE_TASK_NOTIFY_BLOCK,	/* object: task about to wait */
+	TRACE_QUEUE_SEND,			/* value: items waiting before the call */
+	TRACE_QUEUE_SEND_FAILED,
+	TRACE_QUEUE_SEND_FROM_ISR,
+	TRACE_QUEUE_RECEIVE,
+	TRACE_QUEUE_RECEIVE_FAILED,
+	TRACE_QUEUE_RECEIVE_FROM_ISR,
+	TRACE_QUEUE_PEEK,
+	TRACE_QUEUE_BLOCK_ON_SEND,
+	TRACE_QUEUE_BLOCK_ON_RECEIVE,
+	TRACE_QUEUE_REGISTER,
+	TRACE_NAME,					/* value: next four characters of the name */
+	TRACE_JOB_RELEASE,			/* object: task ID, value: absolute deadline */
+	TRACE_JOB_COMPLETE,			/* object: task ID, value: completion tick */
+	TRACE_JOB_OVERDUE,			/* object: task ID, value: absolute deadline */
+	TRACE_SNAPSHOT				/* object: task ID of the miss, value: misses not kept */
+};
+
+typedef struct trace_record
+{
+	uint32_t timestamp;
+	uint32_t object;
+	uint32_t value;
+	uint8_t event;
+	uint8_t reserved[3];
+} trace_record;
+
+typedef struct __attribute__((packed)) trace_frame_header
+{
+	uint8_t magic[2];
+	uint8_t version;
+	uint8_t record_size;
+	uint16_t sequence;
+	uint16_t record_count;
+	uint32_t dropped;		/* Records overwritten since the previous frame */
+	uint32_t clock_hz;		/* Timestamp units per second */
+} trace_frame_header;
+
+#if configUSE_KERNEL_TRACE == 1
+
+extern trace_record trace_ring[TRACE_RING_SIZE];
+extern uint32_t trace_head;
+
+#define TRACE_OBJECT(object) ((uint32_t) (uintptr_t) (object))
+
+static inline void trace_write(uint8_t event, uint32_t object, uint32_t value)
+{
+	uint32_t position = __atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED);
+	trace_record *record = &trace_ring[position & (TRACE_RING_SIZE - 1)];
+
+	record->timestamp = portGET_RUN_TIME_COUNTER_VALUE();
+	record->object = object;
+	record->value = value;
+	record->event = event;
+}
+
+// Function declarations
+void trace_named(uint8_t event, uint32_t object, uint32_t value, const char *name);
+void trace_job(uint8_t event, uint32_t task_id, uint32_t value);
+void trace_update(void);
+void trace_flush(void);
+
+/* Kernel hooks.  Each expands inside the kernel function that calls it, so
+pxCurrentTCB and the hook's arguments are in scope. */
+#define traceTASK_SWITCHED_IN() \
+	trace_write(TRACE_TASK_SWITCHED_IN, TRACE_OBJECT(pxCurrentTCB), pxCurrentTCB->uxPriority)
+#define traceTASK_CREATE(pxNewTCB) \
+	trace_named(TRACE_TASK_CREATE, TRACE_OBJECT(pxNewTCB), (pxNewTCB)->uxPriority, (pxNewTCB)->pcTaskName)
+// Replaced by src/stack_stats.h when the stack stats are on
+#define traceTASK_DELETE(pxTaskToDelete) \
+	trace_write(TRACE_TASK_DELETE, TRACE_OBJECT(pxTaskToDelete), 0)
+#define traceTASK_DELAY() \
+	trace_write(TRACE_TASK_DELAY, TRACE_OBJECT(pxCurrentTCB), xTicksToDelay)
+#define traceTASK_DELAY_UNTIL(xTimeToWake) \
+	trace_write(TRACE_TASK_DELAY_UNTIL, TRACE_OBJECT(pxCurrentTCB), (xTimeToWake))
+#define traceTASK_PRIORITY_SET(pxTask, uxNewPriority) \
+	trace_write(TRACE_TASK_PRIORITY_SET, TRACE_OBJECT(pxTask), (uxNewPriority))
+#define traceTASK_PRIORITY_INHERIT(pxTCBOfMutexHolder, uxInheritedPriority) \
+	trace_write(TRACE_TASK_PRIORITY_INHERIT, TRACE_OBJECT(pxTCBOfMutexHolder), (uxInheritedPriority))
+#define traceTASK_PRIORITY_DISINHERIT(pxTCBOfMutexHolder, uxOriginalPriority) \
+	trace_write(TRACE_TASK_PRIORITY_DISINHERIT, TRACE_OBJECT(pxTCBOfMutexHolder), (uxOriginalPriority))
+#define traceTASK_SUSPEND(pxTaskToSuspend) \
+	trace_write(TRACE_TASK_SUSPEND, TRACE_OBJECT(pxTaskToSuspend), 0)
+#define traceTASK_RESUME(pxTaskToResume) \
+	trace_write(TRACE_TASK_RESUME, TRACE_OBJECT(pxTaskToResume), 0)
+#define traceTASK_RESUME_FROM_ISR(pxTaskToResume) \
+	trace_write(TRACE_TASK_RESUME_FROM_ISR, TRACE_OBJECT(pxTaskToResume), 0)
+#define traceTASK_NOTIFY() \
+	trace_write(TRACE_TASK_NOTIFY, TRACE_OBJECT(pxTCB), 0)
+#define traceTASK_NOTIFY_FROM_ISR() \
+	trace_write(TRACE_TASK_NOTIFY_FROM_ISR, TRACE_OBJECT(pxTCB), 0)
+#define traceTASK_NOTIFY_GIVE_FROM_ISR() \
+	trace_write(TRACE_TASK_NOTIFY_FROM_ISR, TRACE_OBJECT(pxTCB), 0)
+#define traceTASK_NOTIFY_TAKE_BLOCK() \
+	trace_write(TRACE_TASK_NOTIFY_BLOCK, TRACE_OBJECT(pxCurrentTCB), 0)
+#define traceTASK_NOTIFY_WAIT_BLOCK() \
+	trace_write(TRACE_TASK_NOTIFY_BLOCK, TRACE_OBJECT(pxCurrentTCB), 0)
+
+#define traceQUEUE_SEND(pxQueue) \
+	trace_write(TRACE_QUEUE_SEND, TRACE_OBJECT(pxQueue), (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_SEND_FAILED(pxQueue) \
+	trace_write(TRACE_QUEUE_SEND_FAILED, TRACE_OBJECT(pxQueue), (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue) \
+	trace_write(TRACE_QUEUE_SEND_FROM_ISR, TRACE_OBJECT(pxQueue), (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_RECEIVE(pxQueue) \
+	trace_write(TRACE_QUEUE_RECEIVE, TRACE_OBJECT(pxQueue), (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue) \
+	trace_write(TRACE_QUEUE_RECEIVE_FAILED, TRACE_OBJECT(pxQueue), (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue) \
+	trace_write(TRACE_QUEUE_RECEIVE_FROM_ISR, TRACE_OBJECT(pxQueue), (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_PEEK(pxQueue) \
+	trace_write(TRACE_QUEUE_PEEK, TRACE_OBJECT(pxQueue), (pxQueue)->uxMessagesWaiting)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue) \
+	trace_write(TRACE_QUEUE_BLOCK_ON_SEND, TRACE_OBJECT(pxQueue), (pxQueue)->uxMessagesWaiting)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue) \
+	trace_write(TRACE_QUEUE_BLOCK_ON_RECEIVE, TRACE_OBJECT(pxQueue), (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_REGISTRY_ADD(xQueue, pcQueueName) \
+	trace_named(TRACE_QUEUE_REGISTER, TRACE_OBJECT(xQueue), 0, (pcQueueName))
+
+#else
+
+#define trace_job(event, task_id, value)
+#define trace_update()
+#define trace_flush()
+
+#endif /* configUSE_KERNEL_TRACE */
+
+#endif /* TRACE_H */
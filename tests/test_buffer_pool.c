@@ -0,0 +1,126 @@
+/*
+ * Host test for reclaiming the buffers of a deleted task.
+ *
+ * A task takes buffers from a pool and is deleted while still holding them.
+ * After vQueueReclaimBuffers() the whole pool must allocate again, while a
+ * buffer held by a task that is not reclaimed stays out of the pool.  Pools
+ * are checked from xQueueCreateBufferPool() and, in static builds, from
+ * xQueueCreateBufferPoolStatic().
+ *
+ * Build and run from the repository root:
+ *
+ *   gcc -O2 -DHOST_BUILD -DconfigUSE_KERNEL_TRACE=0 -Isrc -IFreeRTOS_Source/include \
+ *       -IFreeRTOS_Source/portable/GCC/Posix_VirtualTime -Ibench \
+ *       tests/test_buffer_pool.c bench/bench_common.c FreeRTOS_Source/tasks.c \
+ *       FreeRTOS_Source/queue.c FreeRTOS_Source/list.c FreeRTOS_Source/timers.c \
+ *       FreeRTOS_Source/portable/MemMang/heap_3.c \
+ *       FreeRTOS_Source/portable/GCC/Posix_VirtualTime/port.c -o test_buffer_pool
+ *   ./test_buffer_pool
+ *
+ * Prints one line per check and exits with status 1 if any failed.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/queue.h"
+#include "../FreeRTOS_Source/include/task.h"
+#include "bench_common.h"
+
+#define POOL_SIZE 4
+#define BUFFER_BYTES 24
+#define HOLDER_BUFFERS 2
+
+#define TEST_PRIORITY 1
+#define HOLDER_PRIORITY 2
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+static StaticBufferPool_t static_pool;
+static uint8_t static_pool_storage[queueBUFFER_POOL_STORAGE_SIZE(POOL_SIZE, BUFFER_BYTES)]
+		__attribute__((aligned(portBYTE_ALIGNMENT)));
+#endif
+
+static uint32_t failures;
+
+static void check(int passed, const char *pool_name, const char *what)
+{
+	printf("%s %s: %s\n", passed ? "PASS" : "FAIL", pool_name, what);
+	if (!passed)
+	{
+		failures++;
+	}
+}
+
+// Takes its buffers and never gives them back
+static void Holder_Task( void *pvParameters )
+{
+	BufferPoolHandle_t pool = (BufferPoolHandle_t) pvParameters;
+
+	for (uint32_t i = 0; i < HOLDER_BUFFERS; i++)
+	{
+		( void ) pvQueueAllocateBuffer(pool, 0);
+	}
+	vTaskSuspend( NULL );
+}
+
+// Returns how many buffers the pool gave out, and keeps them in buffers
+static uint32_t allocate_all(BufferPoolHandle_t pool, void **buffers)
+{
+	uint32_t count = 0;
+
+	while (count < POOL_SIZE + 1 && (buffers[count] = pvQueueAllocateBuffer(pool, 0)) != NULL)
+	{
+		count++;
+	}
+	return count;
+}
+
+static void run_pool(BufferPoolHandle_t pool, const char *pool_name)
+{
+	void *buffers[POOL_SIZE + 1];
+	TaskHandle_t holder;
+
+	// The test task keeps one buffer, which the reclaim must leave alone
+	void *kept = pvQueueAllocateBuffer(pool, 0);
+
+	// The holder has the higher priority, so it has its buffers and is
+	// suspended by the time this returns
+	bench_create_task(Holder_Task, "Holder", configMINIMAL_STACK_SIZE, pool, HOLDER_PRIORITY, &holder);
+	vQueueReclaimBuffers(pool, holder);
+	vTaskDelete(holder);
+
+	uint32_t count = allocate_all(pool, buffers);
+	check(count == POOL_SIZE - 1, pool_name, "deleted task's buffers reclaimed, live task's kept");
+
+	vQueueReleaseBuffer(kept);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		vQueueReleaseBuffer(buffers[i]);
+	}
+
+	count = allocate_all(pool, buffers);
+	check(count == POOL_SIZE, pool_name, "whole pool allocates");
+	for (uint32_t i = 0; i < count; i++)
+	{
+		vQueueReleaseBuffer(buffers[i]);
+	}
+}
+
+static void Test_Task( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	run_pool(xQueueCreateBufferPool(POOL_SIZE, BUFFER_BYTES), "dynamic");
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	run_pool(xQueueCreateBufferPoolStatic(POOL_SIZE, BUFFER_BYTES, static_pool_storage, &static_pool), "static");
+#endif
+
+	exit(failures == 0 ? 0 : 1);
+}
+
+int main(void)
+{
+	return bench_start(Test_Task, TEST_PRIORITY, NULL);
+}
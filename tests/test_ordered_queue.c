@@ -0,0 +1,112 @@
+/*
+ * Host test for the order in which an ordered queue hands out its items.
+ *
+ * Items must come out lowest key first, and items with equal keys in the
+ * order they were sent.  Queues are checked from xQueueCreateOrdered() and, in
+ * static builds, from xQueueCreateOrderedStatic().
+ *
+ * Build and run from the repository root:
+ *
+ *   gcc -O2 -DHOST_BUILD -DconfigUSE_KERNEL_TRACE=0 -Isrc -IFreeRTOS_Source/include \
+ *       -IFreeRTOS_Source/portable/GCC/Posix_VirtualTime -Ibench \
+ *       tests/test_ordered_queue.c bench/bench_common.c FreeRTOS_Source/tasks.c \
+ *       FreeRTOS_Source/queue.c FreeRTOS_Source/list.c FreeRTOS_Source/timers.c \
+ *       FreeRTOS_Source/portable/MemMang/heap_3.c \
+ *       FreeRTOS_Source/portable/GCC/Posix_VirtualTime/port.c -o test_ordered_queue
+ *   ./test_ordered_queue
+ *
+ * Prints one line per check and exits with status 1 if any failed.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../FreeRTOS_Source/include/FreeRTOS.h"
+#include "../FreeRTOS_Source/include/queue.h"
+#include "../FreeRTOS_Source/include/task.h"
+#include "bench_common.h"
+
+#define QUEUE_LENGTH 8
+
+#define TEST_PRIORITY 1
+
+typedef struct
+{
+	TickType_t key;
+	uint32_t id;
+} ordered_item;
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+static StaticQueue_t static_queue;
+static uint8_t static_queue_storage[queueORDERED_STORAGE_SIZE(QUEUE_LENGTH, sizeof(ordered_item))];
+#endif
+
+static uint32_t failures;
+
+static void check(int passed, const char *queue_name, const char *what)
+{
+	printf("%s %s: %s\n", passed ? "PASS" : "FAIL", queue_name, what);
+	if (!passed)
+	{
+		failures++;
+	}
+}
+
+// Sends the items in the order given, then checks they come out in the order
+// of expected_ids
+static int send_and_receive(QueueHandle_t queue, const ordered_item *items, const uint32_t *expected_ids,
+		uint32_t count)
+{
+	ordered_item item;
+	int in_order = 1;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (xQueueSend(queue, &items[i], 0) != pdPASS)
+		{
+			return 0;
+		}
+	}
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (xQueueReceive(queue, &item, 0) != pdPASS || item.id != expected_ids[i])
+		{
+			in_order = 0;
+		}
+	}
+	return in_order && uxQueueMessagesWaiting(queue) == 0;
+}
+
+static void run_queue(QueueHandle_t queue, const char *queue_name)
+{
+	static const ordered_item equal[] = { { 5, 0 }, { 5, 1 }, { 5, 2 } };
+	static const uint32_t equal_order[] = { 0, 1, 2 };
+	check(send_and_receive(queue, equal, equal_order, 3), queue_name, "equal keys received in send order");
+
+	// Equal keys mixed with others, sent so they sit in different branches
+	// of the heap
+	static const ordered_item mixed[] = { { 5, 0 }, { 3, 1 }, { 5, 2 }, { 9, 3 }, { 5, 4 }, { 1, 5 }, { 5, 6 }, { 3, 7 } };
+	static const uint32_t mixed_order[] = { 5, 1, 7, 0, 2, 4, 6, 3 };
+	check(send_and_receive(queue, mixed, mixed_order, 8), queue_name, "lowest key first, equal keys in send order");
+
+	vQueueDelete(queue);
+}
+
+static void Test_Task( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	run_queue(xQueueCreateOrdered(QUEUE_LENGTH, sizeof(ordered_item)), "dynamic");
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	run_queue(xQueueCreateOrderedStatic(QUEUE_LENGTH, sizeof(ordered_item), static_queue_storage, &static_queue),
+			"static");
+#endif
+
+	exit(failures == 0 ? 0 : 1);
+}
+
+int main(void)
+{
+	return bench_start(Test_Task, TEST_PRIORITY, NULL);
+}
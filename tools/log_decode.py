@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""Decode the deferred log stream (src/logger.h, LOG_DEFERRED == 1).
+
+The firmware sends log records holding a message ID and raw argument
+words.  The ID is the address of the format string in the ELF's .logstr
+section, which is never loaded on the target.  This tool builds the
+string table from the ELF, or from a table previously saved with
+--dump-table, and formats each record the way tiny_printf would.
+
+Usage:
+    log_decode.py --elf firmware.elf [capture.bin]
+    log_decode.py --elf firmware.elf --dump-table table.json
+    log_decode.py --table table.json [capture.bin]
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+MAGIC = b"DL"
+VERSION = 2
+RECORD = struct.Struct("<2sBBHHI")
+# The checksum covers everything from the message ID on
+CHECKSUM_START = 8
+MAX_ARGS = 4
+SECTION = ".logstr"
+
+CONVERSION = re.compile(r"%(.)", re.DOTALL)
+
+
+def read_string_table(elf_path):
+    """Return {id: format} for every string in the ELF's .logstr section."""
+    with open(elf_path, "rb") as elf_file:
+        elf = elf_file.read()
+    if elf[:4] != b"\x7fELF":
+        raise ValueError("%s is not an ELF file" % elf_path)
+    is_64 = elf[4] == 2
+    endian = "<" if elf[5] == 1 else ">"
+    if is_64:
+        shoff, = struct.unpack_from(endian + "Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x3A)
+        section = struct.Struct(endian + "IIQQQQIIQQ")
+    else:
+        shoff, = struct.unpack_from(endian + "I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x2E)
+        section = struct.Struct(endian + "IIIIIIIIII")
+
+    headers = [section.unpack_from(elf, shoff + i * shentsize) for i in range(shnum)]
+    names = headers[shstrndx]
+    names_data = elf[names[4]:names[4] + names[5]]
+
+    for name, _type, _flags, addr, offset, size in (h[:6] for h in headers):
+        end = names_data.index(b"\0", name)
+        if names_data[name:end].decode() != SECTION:
+            continue
+        data = elf[offset:offset + size]
+        table = {}
+        start = 0
+        while start < len(data):
+            end = data.find(b"\0", start)
+            if end < 0:
+                end = len(data)
+            if end > start:
+                table[addr + start] = data[start:end].decode("latin-1")
+            start = end + 1
+        return table
+    raise ValueError("%s has no %s section" % (elf_path, SECTION))
+
+
+def format_message(fmt, args):
+    """Render fmt with 32-bit argument words, following tiny_printf."""
+    words = iter(args)
+
+    def convert(match):
+        spec = match.group(1)
+        if spec == "%":
+            return "%"
+        word = next(words, 0)
+        if spec in "di":
+            return str(word - (1 << 32) if word & 0x80000000 else word)
+        if spec == "u":
+            return str(word)
+        if spec in "xX":
+            return "%X" % word
+        if spec == "c":
+            return chr(word & 0xFF)
+        if spec == "s":
+            return "<str 0x%08X>" % word
+        return ""
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def fletcher16(data):
+    """Return the Fletcher-16 checksum of data, as computed by src/logger.c."""
+    sum1 = sum2 = 0
+    for byte in data:
+        sum1 = (sum1 + byte) % 255
+        sum2 = (sum2 + sum1) % 255
+    return (sum2 << 8) | sum1
+
+
+def records(data):
+    """Yield (id, args) for every well-formed record in data.
+
+    Records that were torn by other output or corrupted fail the length or
+    checksum test, and the search resumes one byte further on.
+    """
+    offset = 0
+    while True:
+        offset = data.find(MAGIC, offset)
+        if offset < 0 or offset + RECORD.size > len(data):
+            return
+        _magic, version, arg_count, length, checksum, message_id = RECORD.unpack_from(data, offset)
+        end = offset + RECORD.size + 4 * arg_count
+        if (version != VERSION or arg_count > MAX_ARGS or length != end - offset or end > len(data)
+                or fletcher16(data[offset + CHECKSUM_START:end]) != checksum):
+            offset += 1
+            continue
+        args = struct.unpack_from("<%dI" % arg_count, data, offset + RECORD.size)
+        yield message_id, args
+        offset = end
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="raw capture file (default: stdin)")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--elf", help="firmware ELF holding the .logstr section")
+    source.add_argument("--table", help="string table saved with --dump-table")
+    parser.add_argument("--dump-table", metavar="JSON", help="write the string table and exit")
+    args = parser.parse_args()
+
+    if args.elf:
+        table = read_string_table(args.elf)
+    else:
+        with open(args.table) as table_file:
+            table = {int(key, 0): value for key, value in json.load(table_file).items()}
+
+    if args.dump_table:
+        with open(args.dump_table, "w") as table_file:
+            json.dump({"0x%08X" % key: value for key, value in sorted(table.items())},
+                      table_file, indent=2)
+        return
+
+    if args.capture:
+        with open(args.capture, "rb") as capture:
+            data = capture.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    for message_id, words in records(data):
+        fmt = table.get(message_id)
+        if fmt is None:
+            sys.stdout.write("<unknown message 0x%08X %s>\n" % (message_id, list(words)))
+        else:
+            sys.stdout.write(format_message(fmt, words))
+
+
+if __name__ == "__main__":
+    main()
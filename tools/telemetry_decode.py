@@ -0,0 +1,253 @@
+#!/usr/bin/env python3
+"""Decode the Monitor's binary telemetry stream (src/telemetry.h).
+
+Reads a raw capture of the firmware's stdout (for example the ITM/SWO
+port 0 stream) and renders it as text or CSV.  Bytes that are not part of
+a valid frame, such as plain printf output, are skipped.
+
+Usage:
+    telemetry_decode.py [--format text|csv] [capture.bin]
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+MAGIC = b"DT"
+VERSION = 1
+
+HEADER = struct.Struct("<2sBBHHI")
+JOB_RECORD = struct.Struct("<IIIIBB")
+SUMMARY_RECORD = struct.Struct("<IIIIH")
+CPU_RECORD = struct.Struct("<IHB")
+MISS_RECORD = struct.Struct("<III6I3I3IH")
+STACK_RECORD = struct.Struct("<IHHHB")
+CRITICAL_RECORD = struct.Struct("<IIII24IB")
+
+FRAME_JOBS = 1
+FRAME_SUMMARY = 2
+FRAME_CPU = 3
+FRAME_MISS = 4
+FRAME_STACK = 5
+FRAME_CRITICAL = 6
+RECORD_SIZES = {FRAME_JOBS: JOB_RECORD.size, FRAME_SUMMARY: SUMMARY_RECORD.size,
+                FRAME_CPU: CPU_RECORD.size, FRAME_MISS: MISS_RECORD.size,
+                FRAME_STACK: STACK_RECORD.size, FRAME_CRITICAL: CRITICAL_RECORD.size}
+
+JOB_STATES = {0: "active", 1: "completed", 2: "overdue"}
+TASK_TYPES = {0: "periodic", 1: "aperiodic"}
+CPU_TASKS = {0: "Scheduler", 1: "Generator", 2: "Monitor", 3: "Log", 4: "Timer", 5: "Idle",
+             6: "Jobs"}
+STACK_TASKS = {0: "Scheduler", 1: "Generator", 2: "Monitor", 3: "Log", 4: "Timer", 5: "Idle",
+               6: "Workers"}
+MISS_ACCOUNTS = ("own", "jobs", "scheduler", "system", "isr", "idle")
+CRITICAL_KINDS = {0: "Task", 1: "ISR", 2: "Suspended"}
+
+
+def frames(data):
+    """Yield (header, payload) for every well-formed frame in data."""
+    offset = 0
+    while True:
+        offset = data.find(MAGIC, offset)
+        if offset < 0 or offset + HEADER.size > len(data):
+            return
+        magic, version, frame_type, sequence, count, tick = HEADER.unpack_from(data, offset)
+        record_size = RECORD_SIZES.get(frame_type)
+        end = offset + HEADER.size + count * (record_size or 0)
+        if version != VERSION or record_size is None or count == 0 or end > len(data):
+            offset += 1
+            continue
+        yield (frame_type, sequence, tick), data[offset + HEADER.size:end]
+        offset = end
+
+
+def records(data):
+    """Yield one dict per record, in stream order."""
+    for (frame_type, sequence, tick), payload in frames(data):
+        if frame_type == FRAME_JOBS:
+            for fields in JOB_RECORD.iter_unpack(payload):
+                task_id, release, deadline, completion, state, task_type = fields
+                yield {
+                    "kind": "job",
+                    "sequence": sequence,
+                    "tick": tick,
+                    "state": JOB_STATES.get(state, str(state)),
+                    "task_id": task_id,
+                    "type": TASK_TYPES.get(task_type, str(task_type)),
+                    "release_time": release,
+                    "absolute_deadline": deadline,
+                    "completion_time": completion,
+                }
+        elif frame_type == FRAME_CPU:
+            for fields in CPU_RECORD.iter_unpack(payload):
+                run_time, permille, task = fields
+                yield {
+                    "kind": "cpu",
+                    "sequence": sequence,
+                    "tick": tick,
+                    "task": CPU_TASKS.get(task, str(task)),
+                    "run_time": run_time,
+                    "cpu_permille": permille,
+                }
+        elif frame_type == FRAME_MISS:
+            for fields in MISS_RECORD.iter_unpack(payload):
+                record = {
+                    "kind": "miss",
+                    "sequence": sequence,
+                    "tick": tick,
+                    "task_id": fields[0],
+                    "window": fields[1],
+                    "waiting": fields[2],
+                    "interferers": " ".join("%d:%d" % (task_id, run_time) for task_id, run_time
+                                            in zip(fields[9:12], fields[12:15]) if run_time),
+                    "skipped": fields[15],
+                }
+                record.update(zip(MISS_ACCOUNTS, fields[3:9]))
+                yield record
+        elif frame_type == FRAME_STACK:
+            for fields in STACK_RECORD.iter_unpack(payload):
+                samples, size, peak, suggested, task = fields
+                yield {
+                    "kind": "stack",
+                    "sequence": sequence,
+                    "tick": tick,
+                    "task": STACK_TASKS.get(task, str(task)),
+                    "stack_size": size,
+                    "stack_peak": peak,
+                    "stack_suggested": suggested,
+                    "samples": samples,
+                }
+        elif frame_type == FRAME_CRITICAL:
+            for fields in CRITICAL_RECORD.iter_unpack(payload):
+                count, mean, longest, site = fields[:4]
+                yield {
+                    "kind": "critical",
+                    "sequence": sequence,
+                    "tick": tick,
+                    "task": CRITICAL_KINDS.get(fields[-1], str(fields[-1])),
+                    "count": count,
+                    "mean": mean,
+                    "max": longest,
+                    "max_site": "0x%x" % site,
+                    # Bucket N holds intervals shorter than 2^(N+1) counts
+                    "histogram": " ".join("<2^%d:%d" % (bucket + 1, n)
+                                          for bucket, n in enumerate(fields[4:-1]) if n),
+                }
+        else:
+            for fields in SUMMARY_RECORD.iter_unpack(payload):
+                active, completed, overdue, lateness, permille = fields
+                yield {
+                    "kind": "summary",
+                    "sequence": sequence,
+                    "tick": tick,
+                    "active_count": active,
+                    "completed_count": completed,
+                    "overdue_count": overdue,
+                    "miss_permille": permille,
+                    "worst_lateness": lateness,
+                }
+
+
+def write_text(stream, out):
+    line = []
+    for record in stream:
+        # CPU and stack reports are one frame each, printed on a single line
+        if line and (record["kind"] != line[0]["kind"] or record["sequence"] != line[0]["sequence"]):
+            write_line(line, out)
+            line = []
+        if record["kind"] in ("cpu", "stack"):
+            line.append(record)
+        elif record["kind"] == "miss":
+            write_miss_line(record, out)
+        elif record["kind"] == "critical":
+            out.write("[%d] CRITICAL %s: %d, Mean: %d, Max: %d at %s, Histogram:%s\n" % (
+                record["tick"], record["task"], record["count"], record["mean"], record["max"],
+                record["max_site"], ",".join(" %s: %s" % tuple(pair.split(":"))
+                                             for pair in record["histogram"].split())))
+        elif record["kind"] == "job":
+            out.write("[%d] %s Task ID: %d, Release time: %d, Absolute deadline: %d, "
+                      "Completion time: %d\n" % (
+                          record["tick"], record["state"].upper(), record["task_id"],
+                          record["release_time"], record["absolute_deadline"],
+                          record["completion_time"]))
+        else:
+            out.write("[%d] SUMMARY Active tasks: %d, Completed tasks: %d, Overdue tasks: %d, "
+                      "Miss ratio: %.1f%%, Worst lateness: %d\n" % (
+                          record["tick"], record["active_count"], record["completed_count"],
+                          record["overdue_count"], record["miss_permille"] / 10.0,
+                          record["worst_lateness"]))
+    if line:
+        write_line(line, out)
+
+
+def write_line(line, out):
+    if line[0]["kind"] == "cpu":
+        write_cpu_line(line, out)
+    else:
+        write_stack_line(line, out)
+
+
+def write_cpu_line(cpu, out):
+    out.write("[%d] CPU %s\n" % (cpu[0]["tick"], ", ".join(
+        "%s: %.1f%%" % (record["task"], record["cpu_permille"] / 10.0) for record in cpu)))
+
+
+def write_stack_line(stack, out):
+    out.write("[%d] STACK %s\n" % (stack[0]["tick"], ", ".join(
+        "%s: %d/%d words%s (suggest %d)" % (
+            record["task"], record["stack_peak"], record["stack_size"],
+            " over %d jobs" % record["samples"] if record["task"] == "Workers" else "",
+            record["stack_suggested"]) for record in stack)))
+
+
+def write_miss_line(record, out):
+    def share(run_time):
+        return "%.1f%%" % (100.0 * run_time / record["window"] if record["window"] else 0.0)
+
+    accounts = []
+    for account in MISS_ACCOUNTS:
+        text = "%s: %s" % ("ISR" if account == "isr" else account.capitalize(), share(record[account]))
+        if account == "jobs" and record["interferers"]:
+            text += " (%s)" % ", ".join(
+                "%s: %s" % (task_id, share(int(run_time)))
+                for task_id, run_time in (pair.split(":") for pair in record["interferers"].split()))
+        accounts.append(text)
+    out.write("[%d] MISS Task ID: %d, Waiting: %s, %s%s\n" % (
+        record["tick"], record["task_id"], share(record["waiting"]), ", ".join(accounts),
+        ", Not reported before it: %d" % record["skipped"] if record["skipped"] else ""))
+
+
+def write_csv(stream, out):
+    fields = ["kind", "sequence", "tick", "state", "task_id", "type", "release_time",
+              "absolute_deadline", "completion_time", "active_count", "completed_count",
+              "overdue_count", "miss_permille", "worst_lateness", "task", "run_time",
+              "cpu_permille", "window", "waiting"] + list(MISS_ACCOUNTS) + ["interferers", "skipped",
+              "stack_size", "stack_peak", "stack_suggested", "samples", "count", "mean", "max",
+              "max_site", "histogram"]
+    writer = csv.DictWriter(out, fieldnames=fields, restval="")
+    writer.writeheader()
+    for record in stream:
+        writer.writerow(record)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="raw capture file (default: stdin)")
+    parser.add_argument("--format", choices=("text", "csv"), default="text")
+    args = parser.parse_args()
+
+    if args.capture:
+        with open(args.capture, "rb") as capture:
+            data = capture.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    if args.format == "csv":
+        write_csv(records(data), sys.stdout)
+    else:
+        write_text(records(data), sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+"""Convert the kernel event trace (src/trace.h) to a Chrome/Perfetto trace.
+
+Reads a raw capture of the firmware's stdout, picks out the trace frames and
+writes Chrome trace event JSON, which ui.perfetto.dev and chrome://tracing
+both open.  Every task gets a track showing when it ran, with the queue and
+notification events it caused marked on it, and every job gets a slice from
+release to completion or to being dropped as overdue.  Bytes that are not part
+of a valid frame, such as telemetry or printf output, are skipped.
+
+Flight recorder captures hold separate windows around deadline misses rather
+than one continuous trace.  Each window is laid out after the previous one,
+with a gap between them, and jobs still open at the end of a window are closed
+there.
+
+Usage:
+    trace_export.py [capture.bin] > trace.json
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = b"DR"
+VERSION = 1
+
+HEADER = struct.Struct("<2sBBHHII")
+RECORD = struct.Struct("<IIIB3x")
+MAX_FRAME_RECORDS = 16
+
+(TASK_SWITCHED_IN, TASK_CREATE, TASK_DELETE, TASK_DELAY, TASK_DELAY_UNTIL,
+ TASK_PRIORITY_SET, TASK_PRIORITY_INHERIT, TASK_PRIORITY_DISINHERIT, TASK_SUSPEND,
+ TASK_RESUME, TASK_RESUME_FROM_ISR, TASK_NOTIFY, TASK_NOTIFY_FROM_ISR, TASK_NOTIFY_BLOCK,
+ QUEUE_SEND, QUEUE_SEND_FAILED, QUEUE_SEND_FROM_ISR, QUEUE_RECEIVE, QUEUE_RECEIVE_FAILED,
+ QUEUE_RECEIVE_FROM_ISR, QUEUE_PEEK, QUEUE_BLOCK_ON_SEND, QUEUE_BLOCK_ON_RECEIVE,
+ QUEUE_REGISTER, NAME, JOB_RELEASE, JOB_COMPLETE, JOB_OVERDUE, SNAPSHOT) = range(1, 30)
+
+# Events marked on the running task's track, by the object they name
+QUEUE_EVENTS = {
+    QUEUE_SEND: "send", QUEUE_SEND_FAILED: "send failed", QUEUE_SEND_FROM_ISR: "send from ISR",
+    QUEUE_RECEIVE: "receive", QUEUE_RECEIVE_FAILED: "receive failed",
+    QUEUE_RECEIVE_FROM_ISR: "receive from ISR", QUEUE_PEEK: "peek",
+    QUEUE_BLOCK_ON_SEND: "block on send", QUEUE_BLOCK_ON_RECEIVE: "block on receive",
+}
+TASK_EVENTS = {
+    TASK_DELAY: "delay", TASK_DELAY_UNTIL: "delay until", TASK_PRIORITY_SET: "priority set",
+    TASK_PRIORITY_INHERIT: "priority inherit", TASK_PRIORITY_DISINHERIT: "priority disinherit",
+    TASK_SUSPEND: "suspend", TASK_RESUME: "resume", TASK_RESUME_FROM_ISR: "resume from ISR",
+    TASK_NOTIFY: "notify", TASK_NOTIFY_FROM_ISR: "notify from ISR", TASK_NOTIFY_BLOCK: "wait notify",
+    TASK_CREATE: "create", TASK_DELETE: "delete",
+}
+
+TASKS_PID = 1
+JOBS_PID = 2
+
+# Gap left between flight recorder windows, in seconds
+WINDOW_GAP = 0.001
+
+
+def frames(data):
+    """Yield (dropped, clock_hz, payload) for every well-formed trace frame."""
+    offset = 0
+    while True:
+        offset = data.find(MAGIC, offset)
+        if offset < 0 or offset + HEADER.size > len(data):
+            return
+        _, version, record_size, _, count, dropped, clock_hz = HEADER.unpack_from(data, offset)
+        end = offset + HEADER.size + count * RECORD.size
+        if (version != VERSION or record_size != RECORD.size or not 0 < count <= MAX_FRAME_RECORDS
+                or clock_hz == 0 or end > len(data)):
+            offset += 1
+            continue
+        yield dropped, clock_hz, data[offset + HEADER.size:end]
+        offset = end
+
+
+class Exporter:
+    def __init__(self):
+        self.events = []
+        self.names = {}
+        self.tids = {}
+        self.running = None
+        self.running_since = 0.0
+        self.jobs = set()
+        self.last_raw = None
+        self.last_name = None
+        self.time = 0
+
+    def timestamp(self, raw, clock_hz):
+        """Unwrap the 32-bit clock, in microseconds.  Records claimed by an
+        interrupt can be stamped slightly before the record they preempted."""
+        if self.last_raw is not None:
+            delta = (raw - self.last_raw) & 0xFFFFFFFF
+            self.time += delta - (1 << 32) if delta >= 1 << 31 else delta
+        self.last_raw = raw
+        return self.time * 1e6 / clock_hz
+
+    def name(self, obj):
+        return self.names.get(obj, "0x%08x" % obj)
+
+    def tid(self, obj):
+        if obj not in self.tids:
+            self.tids[obj] = len(self.tids) + 1
+        return self.tids[obj]
+
+    def end_slice(self, ts):
+        if self.running is not None and ts > self.running_since:
+            self.events.append({"name": self.name(self.running), "ph": "X", "pid": TASKS_PID,
+                                "tid": self.tid(self.running), "ts": self.running_since,
+                                "dur": ts - self.running_since})
+        self.running = None
+
+    def instant(self, name, ts, args, obj=None):
+        track = obj if obj is not None else self.running
+        event = {"name": name, "ph": "i", "s": "t", "pid": TASKS_PID, "ts": ts, "args": args}
+        if track is None:
+            event["s"] = "p"
+        else:
+            event["tid"] = self.tid(track)
+        self.events.append(event)
+
+    def snapshot(self, ts, obj, value):
+        """Start a new window, closing whatever the previous one left open."""
+        self.end_slice(ts)
+        for job in sorted(self.jobs):
+            self.events.append({"name": "job %d" % job, "cat": "job", "ph": "e", "id": job,
+                                "pid": JOBS_PID, "ts": ts, "args": {"outcome": "window end"}})
+        self.jobs.clear()
+        self.events.append({"name": "snapshot: job %d overdue (%d misses not kept)" % (obj, value),
+                            "ph": "i", "s": "g", "pid": JOBS_PID, "ts": ts})
+
+    def record(self, ts, obj, value, event):
+        if event == NAME:
+            # A name's records follow each other; a new run replaces the old name
+            previous = self.names.get(obj, "") if self.last_name == obj else ""
+            self.names[obj] = previous + \
+                struct.pack("<I", value).rstrip(b"\0").decode("ascii", "replace")
+        elif event in (TASK_CREATE, QUEUE_REGISTER):
+            if event == TASK_CREATE:
+                self.instant("create", ts, {"priority": value}, obj)
+        elif event == TASK_SWITCHED_IN:
+            if obj != self.running:
+                self.end_slice(ts)
+                self.running = obj
+                self.running_since = ts
+        elif event in QUEUE_EVENTS:
+            self.instant("%s %s" % (QUEUE_EVENTS[event], self.name(obj)), ts, {"waiting": value})
+        elif event in TASK_EVENTS:
+            on_self = event in (TASK_DELAY, TASK_DELAY_UNTIL, TASK_NOTIFY_BLOCK)
+            self.instant(TASK_EVENTS[event] if on_self else
+                         "%s %s" % (TASK_EVENTS[event], self.name(obj)), ts, {"value": value},
+                         obj if event in (TASK_PRIORITY_SET, TASK_PRIORITY_INHERIT,
+                                          TASK_PRIORITY_DISINHERIT) else None)
+            if event in (TASK_PRIORITY_SET, TASK_PRIORITY_INHERIT, TASK_PRIORITY_DISINHERIT):
+                self.events.append({"name": "priority " + self.name(obj), "ph": "C",
+                                    "pid": TASKS_PID, "ts": ts, "args": {"priority": value}})
+        elif event == JOB_RELEASE:
+            self.jobs.add(obj)
+            self.events.append({"name": "job %d" % obj, "cat": "job", "ph": "b", "id": obj,
+                                "pid": JOBS_PID, "ts": ts, "args": {"absolute_deadline": value}})
+        elif event in (JOB_COMPLETE, JOB_OVERDUE) and obj in self.jobs:
+            self.jobs.discard(obj)
+            outcome = "completed" if event == JOB_COMPLETE else "overdue"
+            self.events.append({"name": "job %d" % obj, "cat": "job", "ph": "e", "id": obj,
+                                "pid": JOBS_PID, "ts": ts, "args": {"outcome": outcome}})
+            if event == JOB_OVERDUE:
+                self.events.append({"name": "overdue %d" % obj, "ph": "i", "s": "p",
+                                    "pid": JOBS_PID, "ts": ts, "args": {"absolute_deadline": value}})
+
+    def export(self, data):
+        ts = 0.0
+        for dropped, clock_hz, payload in frames(data):
+            if dropped:
+                # The running task is unknown until the next switch
+                self.end_slice(ts)
+                self.events.append({"name": "%d records lost" % dropped, "ph": "i", "s": "g",
+                                    "pid": TASKS_PID, "ts": ts})
+            for raw, obj, value, event in RECORD.iter_unpack(payload):
+                if event == SNAPSHOT:
+                    if self.last_raw is not None:
+                        self.time += int(WINDOW_GAP * clock_hz)
+                    self.snapshot(self.time * 1e6 / clock_hz, obj, value)
+                    self.last_raw = None
+                elif event != NAME:
+                    ts = self.timestamp(raw, clock_hz)
+                self.record(ts, obj, value, event)
+                self.last_name = obj if event == NAME else None
+        self.end_slice(ts)
+
+        metadata = [{"name": "process_name", "ph": "M", "pid": TASKS_PID, "args": {"name": "Tasks"}},
+                    {"name": "process_name", "ph": "M", "pid": JOBS_PID, "args": {"name": "Jobs"}}]
+        for obj, tid in self.tids.items():
+            metadata.append({"name": "thread_name", "ph": "M", "pid": TASKS_PID, "tid": tid,
+                             "args": {"name": "%s (0x%08x)" % (self.name(obj), obj)}})
+        return {"traceEvents": metadata + self.events, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="raw capture file (default: stdin)")
+    args = parser.parse_args()
+
+    if args.capture:
+        with open(args.capture, "rb") as capture:
+            data = capture.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    json.dump(Exporter().export(data), sys.stdout)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()